@@ -0,0 +1,103 @@
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+
+// Adafruit_BME280 (sous-ensemble I2C) : mêmes transactions que la bibliothèque
+// (une lecture rafale par grandeur, température relue avant P et H pour t_fine).
+
+#define BME280_ADDRESS 0x77
+#define BME280_ADDRESS_ALTERNATE 0x76
+
+class Adafruit_BME280 {
+    TwoWire* _wire = &Wire;
+    uint8_t _addr = BME280_ADDRESS;
+    uint16_t T1, P1; int16_t T2, T3, P2, P3, P4, P5, P6, P7, P8, P9;
+    uint8_t H1, H3; int16_t H2, H4, H5; int8_t H6;
+    int32_t _tfine = 0;
+
+    bool readRegs(uint8_t reg, uint8_t* buf, size_t n) {
+        _wire->beginTransmission(_addr);
+        _wire->write(reg);
+        if(_wire->endTransmission()) return false;
+        if(_wire->requestFrom(_addr, (int)n) != n) return false;
+        for(size_t i=0; i<n; i++) buf[i] = _wire->read();
+        return true;
+    }
+    void write8(uint8_t reg, uint8_t v) {
+        _wire->beginTransmission(_addr);
+        _wire->write(reg); _wire->write(v);
+        _wire->endTransmission();
+    }
+    uint8_t read8(uint8_t reg) { uint8_t v = 0; readRegs(reg, &v, 1); return v; }
+    uint16_t read16LE(uint8_t reg) { uint8_t b[2] = {0, 0}; readRegs(reg, b, 2); return b[0] | (b[1] << 8); }
+    uint32_t read24(uint8_t reg) { uint8_t b[3] = {0x80, 0, 0}; readRegs(reg, b, 3); return ((uint32_t)b[0] << 16) | (b[1] << 8) | b[2]; }
+
+    void readCoefficients() {
+        T1 = read16LE(0x88); T2 = read16LE(0x8A); T3 = read16LE(0x8C);
+        P1 = read16LE(0x8E); P2 = read16LE(0x90); P3 = read16LE(0x92); P4 = read16LE(0x94); P5 = read16LE(0x96);
+        P6 = read16LE(0x98); P7 = read16LE(0x9A); P8 = read16LE(0x9C); P9 = read16LE(0x9E);
+        H1 = read8(0xA1); H2 = read16LE(0xE1); H3 = read8(0xE3);
+        H4 = ((int8_t)read8(0xE4) << 4) | (read8(0xE5) & 0x0F);
+        H5 = ((int8_t)read8(0xE6) << 4) | (read8(0xE5) >> 4);
+        H6 = (int8_t)read8(0xE7);
+    }
+
+public:
+    bool begin(uint8_t addr = BME280_ADDRESS, TwoWire* w = &Wire) {
+        _addr = addr; _wire = w;
+        if(read8(0xD0) != 0x60) return false;
+        write8(0xE0, 0xB6);
+        delay(10);
+        readCoefficients();
+        write8(0xF2, 0x05);                 // Humidité x16
+        write8(0xF5, 0x00);
+        write8(0xF4, (0x05 << 5) | (0x05 << 2) | 0x03);   // T x16, P x16, mode normal
+        delay(100);
+        return true;
+    }
+    uint32_t sensorID() { return read8(0xD0); }
+
+    float readTemperature() {
+        int32_t adc = read24(0xFA);
+        if(adc == 0x800000) return NAN;
+        adc >>= 4;
+        int32_t v1 = ((((adc >> 3) - ((int32_t)T1 << 1))) * ((int32_t)T2)) >> 11;
+        int32_t v2 = (((((adc >> 4) - ((int32_t)T1)) * ((adc >> 4) - ((int32_t)T1))) >> 12) * ((int32_t)T3)) >> 14;
+        _tfine = v1 + v2;
+        return ((_tfine * 5 + 128) >> 8) / 100.0f;
+    }
+
+    float readPressure() {
+        readTemperature();
+        int32_t adc = read24(0xF7);
+        if(adc == 0x800000) return NAN;
+        adc >>= 4;
+        int64_t v1 = (int64_t)_tfine - 128000;
+        int64_t v2 = v1 * v1 * (int64_t)P6;
+        v2 = v2 + ((v1 * (int64_t)P5) << 17);
+        v2 = v2 + (((int64_t)P4) << 35);
+        v1 = ((v1 * v1 * (int64_t)P3) >> 8) + ((v1 * (int64_t)P2) << 12);
+        v1 = (((((int64_t)1) << 47) + v1)) * ((int64_t)P1) >> 33;
+        if(v1 == 0) return 0;
+        int64_t p = 1048576 - adc;
+        p = (((p << 31) - v2) * 3125) / v1;
+        v1 = (((int64_t)P9) * (p >> 13) * (p >> 13)) >> 25;
+        v2 = (((int64_t)P8) * p) >> 19;
+        p = ((p + v1 + v2) >> 8) + (((int64_t)P7) << 4);
+        return (float)p / 256.0f;
+    }
+
+    float readHumidity() {
+        readTemperature();
+        int32_t adc = read16LE(0xFD);
+        adc = ((adc & 0xFF) << 8) | (adc >> 8);     // Registre big-endian
+        if(adc == 0x8000) return NAN;
+        int32_t v = _tfine - 76800;
+        v = (((((adc << 14) - (((int32_t)H4) << 20) - (((int32_t)H5) * v)) + 16384) >> 15) *
+             (((((((v * ((int32_t)H6)) >> 10) * (((v * ((int32_t)H3)) >> 11) + 32768)) >> 10) + 2097152) * ((int32_t)H2) + 8192) >> 14));
+        v = v - (((((v >> 15) * (v >> 15)) >> 7) * ((int32_t)H1)) >> 4);
+        v = v < 0 ? 0 : v;
+        v = v > 419430400 ? 419430400 : v;
+        return (v >> 12) / 1024.0f;
+    }
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+
+// Adafruit_INA219 (sous-ensemble) : calibration 32 V / 2 A, registres 16 bits big-endian.
+// Comme la bibliothèque, la calibration est réécrite avant chaque lecture de courant/puissance.
+
+#define INA219_ADDRESS 0x40
+
+class Adafruit_INA219 {
+    TwoWire* _wire = &Wire;
+    uint8_t _addr;
+    uint32_t _cal = 4096;
+    float _currentDivider = 10, _powerMultiplier = 2;
+    bool _ok = false;
+
+    bool writeReg(uint8_t reg, uint16_t v) {
+        _wire->beginTransmission(_addr);
+        _wire->write(reg); _wire->write(v >> 8); _wire->write(v & 0xFF);
+        return _wire->endTransmission() == 0;
+    }
+    int16_t readReg(uint8_t reg) {
+        _wire->beginTransmission(_addr);
+        _wire->write(reg);
+        _ok = _wire->endTransmission() == 0;
+        if(!_ok || _wire->requestFrom(_addr, 2) != 2) { _ok = false; return 0; }
+        uint8_t hi = _wire->read(), lo = _wire->read();
+        return (int16_t)((hi << 8) | lo);
+    }
+
+public:
+    explicit Adafruit_INA219(uint8_t addr = INA219_ADDRESS) : _addr(addr) {}
+
+    bool begin(TwoWire* w = &Wire) {
+        _wire = w;
+        _ok = writeReg(0x00, 0x8000);   // Reset puis probe
+        setCalibration_32V_2A();
+        return _ok;
+    }
+    bool success() const { return _ok; }
+
+    void setCalibration_32V_2A() {
+        _cal = 4096; _currentDivider = 10; _powerMultiplier = 2;
+        writeReg(0x05, _cal);
+        writeReg(0x00, 0x399F);
+    }
+
+    int16_t getBusVoltage_raw() { return (int16_t)(((uint16_t)readReg(0x02) >> 3) * 4); }
+    int16_t getShuntVoltage_raw() { return readReg(0x01); }
+    int16_t getCurrent_raw() { writeReg(0x05, _cal); return readReg(0x04); }
+    int16_t getPower_raw() { writeReg(0x05, _cal); return readReg(0x03); }
+
+    float getBusVoltage_V() { return getBusVoltage_raw() * 0.001f; }
+    float getShuntVoltage_mV() { return getShuntVoltage_raw() * 0.01f; }
+    float getCurrent_mA() { return getCurrent_raw() / _currentDivider; }
+    float getPower_mW() { return getPower_raw() * _powerMultiplier; }
+};
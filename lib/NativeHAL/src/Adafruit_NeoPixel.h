@@ -0,0 +1,120 @@
+#pragma once
+#include <Arduino.h>
+#include "NativeHAL.h"
+
+// Adafruit_NeoPixel (sous-ensemble) : buffer dans l'ordre des octets sur le fil,
+// show() bloquant 30 µs par pixel (800 kHz) + 300 µs de latch, comme le RMT.
+
+typedef uint16_t neoPixelType;
+
+#define NEO_RGB ((0 << 6) | (0 << 4) | (1 << 2) | (2))
+#define NEO_RBG ((0 << 6) | (0 << 4) | (2 << 2) | (1))
+#define NEO_GRB ((1 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_GBR ((2 << 6) | (2 << 4) | (0 << 2) | (1))
+#define NEO_BRG ((1 << 6) | (1 << 4) | (2 << 2) | (0))
+#define NEO_BGR ((2 << 6) | (2 << 4) | (1 << 2) | (0))
+#define NEO_WRGB ((0 << 6) | (1 << 4) | (2 << 2) | (3))
+#define NEO_RGBW ((3 << 6) | (0 << 4) | (1 << 2) | (2))
+#define NEO_GRBW ((3 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_KHZ800 0x0000
+#define NEO_KHZ400 0x0100
+
+class Adafruit_NeoPixel {
+    uint16_t _n = 0;
+    int16_t _pin = -1;
+    uint8_t _bpp = 3, _rOff = 1, _gOff = 0, _bOff = 2, _wOff = 1;
+    uint8_t _brightness = 0;    // 0 = pleine luminosité (stockée +1 comme la bibliothèque)
+    bool _khz400 = false;
+    uint8_t* _pixels = nullptr;
+
+public:
+    Adafruit_NeoPixel(uint16_t n, int16_t pin = 6, neoPixelType type = NEO_GRB + NEO_KHZ800) : _pin(pin) {
+        updateType(type); updateLength(n);
+    }
+    Adafruit_NeoPixel() {}
+    ~Adafruit_NeoPixel() { free(_pixels); }
+
+    void begin() { if(_pin >= 0) { pinMode(_pin, OUTPUT); digitalWrite(_pin, LOW); } }
+
+    void updateLength(uint16_t n) {
+        free(_pixels);
+        _pixels = (uint8_t*)calloc(n * _bpp, 1);
+        _n = _pixels ? n : 0;
+    }
+    void updateType(neoPixelType t) {
+        bool oldW = (_wOff != _rOff);
+        _wOff = (t >> 6) & 3; _rOff = (t >> 4) & 3; _gOff = (t >> 2) & 3; _bOff = t & 3;
+        _khz400 = (t & NEO_KHZ400) != 0;
+        bool newW = (_wOff != _rOff);
+        _bpp = newW ? 4 : 3;
+        if(_pixels && oldW != newW) updateLength(_n);
+    }
+    void setPin(int16_t pin) { _pin = pin; begin(); }
+
+    void show() {
+        if(!_pixels) return;
+        uint32_t us = _n * (_khz400 ? 60 : 30) * _bpp / 3 + 300;
+        Sim::counters().ledShows++;
+        Sim::counters().ledUs += us;
+        Sim::busy(us);
+    }
+    bool canShow() { return true; }
+
+    void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b) {
+        if(n >= _n) return;
+        if(_brightness) { r = (r * _brightness) >> 8; g = (g * _brightness) >> 8; b = (b * _brightness) >> 8; }
+        uint8_t* p = &_pixels[n * _bpp];
+        if(_bpp == 4) p[_wOff] = 0;
+        p[_rOff] = r; p[_gOff] = g; p[_bOff] = b;
+    }
+    void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+        setPixelColor(n, r, g, b);
+        if(n < _n && _bpp == 4) _pixels[n * 4 + _wOff] = _brightness ? (w * _brightness) >> 8 : w;
+    }
+    void setPixelColor(uint16_t n, uint32_t c) {
+        setPixelColor(n, (uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c, (uint8_t)(c >> 24));
+    }
+    void fill(uint32_t c = 0, uint16_t first = 0, uint16_t count = 0) {
+        uint16_t end = (count == 0 || first + count > _n) ? _n : first + count;
+        for(uint16_t i=first; i<end; i++) setPixelColor(i, c);
+    }
+    void clear() { if(_pixels) memset(_pixels, 0, _n * _bpp); }
+
+    uint32_t getPixelColor(uint16_t n) const {
+        if(n >= _n) return 0;
+        const uint8_t* p = &_pixels[n * _bpp];
+        uint32_t c = ((uint32_t)p[_rOff] << 16) | ((uint32_t)p[_gOff] << 8) | p[_bOff];
+        if(_bpp == 4) c |= (uint32_t)p[_wOff] << 24;
+        return c;
+    }
+    uint8_t* getPixels() const { return _pixels; }
+    uint16_t numPixels() const { return _n; }
+    int16_t getPin() const { return _pin; }
+
+    void setBrightness(uint8_t b) { _brightness = b + 1; }
+    uint8_t getBrightness() const { return _brightness - 1; }
+
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) { return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b; }
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b, uint8_t w) { return ((uint32_t)w << 24) | Color(r, g, b); }
+
+    static uint32_t ColorHSV(uint16_t hue, uint8_t sat = 255, uint8_t val = 255) {
+        uint8_t r, g, b;
+        hue = (hue * 1530L + 32768) / 65536;
+        if(hue < 510) { b = 0; if(hue < 255) { r = 255; g = hue; } else { r = 510 - hue; g = 255; } }
+        else if(hue < 1020) { r = 0; if(hue < 765) { g = 255; b = hue - 510; } else { g = 1020 - hue; b = 255; } }
+        else if(hue < 1530) { g = 0; if(hue < 1275) { r = hue - 1020; b = 255; } else { r = 255; b = 1530 - hue; } }
+        else { r = 255; g = b = 0; }
+        uint32_t v1 = 1 + val;
+        uint16_t s1 = 1 + sat;
+        uint8_t s2 = 255 - sat;
+        return ((((((r * s1) >> 8) + s2) * v1) & 0xff00) << 8) | (((((g * s1) >> 8) + s2) * v1) & 0xff00) |
+               (((((b * s1) >> 8) + s2) * v1) >> 8);
+    }
+
+    static uint8_t gamma8(uint8_t x) { return (uint8_t)(powf(x / 255.0f, 2.6f) * 255.0f + 0.5f); }
+    static uint32_t gamma32(uint32_t x) {
+        uint8_t* y = (uint8_t*)&x;
+        for(uint8_t i=0; i<4; i++) y[i] = gamma8(y[i]);
+        return x;
+    }
+};
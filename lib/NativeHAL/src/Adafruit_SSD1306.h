@@ -0,0 +1,179 @@
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+
+// Adafruit_SSD1306 + primitives Adafruit_GFX (sous-ensemble). Framebuffer et
+// transferts identiques à la bibliothèque : display() renvoie tout le buffer
+// à 400 kHz par transactions de 128 octets. Police classique 6x8 (métriques
+// exactes, glyphes factices mais déterministes).
+
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+#define SSD1306_INVERSE 2
+#define BLACK SSD1306_BLACK
+#define WHITE SSD1306_WHITE
+#define INVERSE SSD1306_INVERSE
+#define SSD1306_SWITCHCAPVCC 0x02
+#define SSD1306_EXTERNALVCC 0x01
+
+class Adafruit_SSD1306 : public Print {
+    int16_t _w, _h;
+    TwoWire* _wire;
+    uint32_t _clkDuring, _clkAfter;
+    uint8_t _addr = 0x3C;
+    int16_t _cx = 0, _cy = 0;
+    uint8_t _sx = 1, _sy = 1;
+    uint16_t _color = SSD1306_WHITE, _bg = SSD1306_WHITE;   // bg == color : fond transparent
+    bool _wrap = true;
+
+    static const size_t WIRE_MAX = I2C_BUFFER_LENGTH;
+
+    void commandList(const uint8_t* c, size_t n) {
+        _wire->beginTransmission(_addr);
+        _wire->write((uint8_t)0x00);
+        size_t out = 1;
+        while(n--) {
+            if(out >= WIRE_MAX) { _wire->endTransmission(); _wire->beginTransmission(_addr); _wire->write((uint8_t)0x00); out = 1; }
+            _wire->write(*c++);
+            out++;
+        }
+        _wire->endTransmission();
+    }
+
+    static uint8_t glyphColumn(unsigned char c, int col) {
+        if(c == ' ' || col >= 5) return 0;
+        uint32_t h = (c + 1) * 2654435761u;
+        return (h >> (col * 5)) & 0x7F;
+    }
+
+    void drawChar(int16_t x, int16_t y, unsigned char c) {
+        for(int col=0; col<6; col++) {
+            uint8_t bits = glyphColumn(c, col);
+            for(int row=0; row<8; row++) {
+                bool on = bits & (1 << row);
+                if(!on && _bg == _color) continue;
+                fillRect(x + col * _sx, y + row * _sy, _sx, _sy, on ? _color : _bg);
+            }
+        }
+    }
+
+protected:
+    uint8_t* buffer = nullptr;      // Comme la bibliothèque : alloué par begin() s'il est nul
+
+public:
+    using Print::write;
+
+    Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi = &Wire, int8_t rst = -1,
+                     uint32_t clkDuring = 400000, uint32_t clkAfter = 100000)
+        : _w(w), _h(h), _wire(twi), _clkDuring(clkDuring), _clkAfter(clkAfter) { (void)rst; }
+    ~Adafruit_SSD1306() { free(buffer); }
+
+    bool begin(uint8_t vcs = SSD1306_SWITCHCAPVCC, uint8_t addr = 0, bool reset = true, bool periphBegin = true) {
+        (void)vcs; (void)reset;
+        if(!buffer && !(buffer = (uint8_t*)malloc(_w * ((_h + 7) / 8)))) return false;
+        clearDisplay();
+        if(addr) _addr = addr;
+        if(periphBegin) _wire->begin();
+        _wire->setClock(_clkDuring);
+        const uint8_t init[] = {0xAE, 0xD5, 0x80, 0xA8, (uint8_t)(_h - 1), 0xD3, 0x00, 0x40, 0x8D, 0x14, 0x20, 0x00,
+                                0xA1, 0xC8, 0xDA, 0x12, 0x81, 0xCF, 0xD9, 0xF1, 0xDB, 0x40, 0xA4, 0xA6, 0x2E, 0xAF};
+        commandList(init, sizeof(init));
+        _wire->setClock(_clkAfter);
+        return true;
+    }
+
+    void ssd1306_command(uint8_t c) { commandList(&c, 1); }
+
+    void display() {
+        _wire->setClock(_clkDuring);
+        const uint8_t dlist[] = {0x22, 0x00, 0xFF, 0x21, 0x00};
+        commandList(dlist, sizeof(dlist));
+        ssd1306_command(_w - 1);
+        size_t count = _w * ((_h + 7) / 8);
+        const uint8_t* p = buffer;
+        _wire->beginTransmission(_addr);
+        _wire->write((uint8_t)0x40);
+        size_t out = 1;
+        while(count--) {
+            if(out >= WIRE_MAX) { _wire->endTransmission(); _wire->beginTransmission(_addr); _wire->write((uint8_t)0x40); out = 1; }
+            _wire->write(*p++);
+            out++;
+        }
+        _wire->endTransmission();
+        _wire->setClock(_clkAfter);
+    }
+
+    void clearDisplay() { if(buffer) memset(buffer, 0, _w * ((_h + 7) / 8)); }
+    void invertDisplay(bool i) { ssd1306_command(i ? 0xA7 : 0xA6); }
+    void dim(bool d) { uint8_t c[] = {0x81, (uint8_t)(d ? 0 : 0xCF)}; commandList(c, 2); }
+    uint8_t* getBuffer() { return buffer; }
+    int16_t width() const { return _w; }
+    int16_t height() const { return _h; }
+
+    // --- Primitives GFX ---
+    void drawPixel(int16_t x, int16_t y, uint16_t color) {
+        if(!buffer || x < 0 || x >= _w || y < 0 || y >= _h) return;
+        uint8_t& b = buffer[x + (y / 8) * _w];
+        uint8_t m = 1 << (y & 7);
+        if(color == SSD1306_WHITE) b |= m; else if(color == SSD1306_BLACK) b &= ~m; else b ^= m;
+    }
+    bool getPixel(int16_t x, int16_t y) const {
+        return buffer && x >= 0 && x < _w && y >= 0 && y < _h && (buffer[x + (y / 8) * _w] & (1 << (y & 7)));
+    }
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t c) { for(int16_t i=0; i<w; i++) drawPixel(x + i, y, c); }
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t c) { for(int16_t i=0; i<h; i++) drawPixel(x, y + i, c); }
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t c) { for(int16_t i=0; i<h; i++) drawFastHLine(x, y + i, w, c); }
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t c) {
+        drawFastHLine(x, y, w, c); drawFastHLine(x, y + h - 1, w, c);
+        drawFastVLine(x, y, h, c); drawFastVLine(x + w - 1, y, h, c);
+    }
+    void fillScreen(uint16_t c) { fillRect(0, 0, _w, _h, c); }
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t c) {
+        bool steep = abs(y1 - y0) > abs(x1 - x0);
+        if(steep) { std::swap(x0, y0); std::swap(x1, y1); }
+        if(x0 > x1) { std::swap(x0, x1); std::swap(y0, y1); }
+        int16_t dx = x1 - x0, dy = abs(y1 - y0), err = dx / 2, ystep = y0 < y1 ? 1 : -1;
+        for(; x0 <= x1; x0++) {
+            steep ? drawPixel(y0, x0, c) : drawPixel(x0, y0, c);
+            err -= dy;
+            if(err < 0) { y0 += ystep; err += dx; }
+        }
+    }
+
+    // --- Texte ---
+    void setTextSize(uint8_t s) { _sx = _sy = s ? s : 1; }
+    void setTextSize(uint8_t sx, uint8_t sy) { _sx = sx ? sx : 1; _sy = sy ? sy : 1; }
+    void setTextColor(uint16_t c) { _color = _bg = c; }
+    void setTextColor(uint16_t c, uint16_t bg) { _color = c; _bg = bg; }
+    void setTextWrap(bool w) { _wrap = w; }
+    void setCursor(int16_t x, int16_t y) { _cx = x; _cy = y; }
+    int16_t getCursorX() const { return _cx; }
+    int16_t getCursorY() const { return _cy; }
+    void cp437(bool x = true) { (void)x; }
+
+    size_t write(uint8_t c) override {
+        if(c == '\n') { _cx = 0; _cy += _sy * 8; return 1; }
+        if(c == '\r') return 1;
+        if(_wrap && _cx + _sx * 6 > _w) { _cx = 0; _cy += _sy * 8; }
+        drawChar(_cx, _cy, c);
+        _cx += _sx * 6;
+        return 1;
+    }
+
+    void getTextBounds(const char* s, int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h) {
+        int16_t cx = x, cy = y, minx = _w, miny = _h, maxx = -1, maxy = -1;
+        for(; *s; s++) {
+            if(*s == '\n') { cx = 0; cy += _sy * 8; continue; }
+            if(*s == '\r') continue;
+            if(_wrap && cx + _sx * 6 > _w) { cx = 0; cy += _sy * 8; }
+            minx = min(minx, cx); miny = min(miny, cy);
+            maxx = max<int16_t>(maxx, cx + _sx * 6 - 1); maxy = max<int16_t>(maxy, cy + _sy * 8 - 1);
+            cx += _sx * 6;
+        }
+        *x1 = maxx >= minx ? minx : x; *y1 = maxy >= miny ? miny : y;
+        *w = maxx >= minx ? maxx - minx + 1 : 0; *h = maxy >= miny ? maxy - miny + 1 : 0;
+    }
+    void getTextBounds(const String& s, int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h) {
+        getTextBounds(s.c_str(), x, y, x1, y1, w, h);
+    }
+};
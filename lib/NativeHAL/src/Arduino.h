@@ -0,0 +1,132 @@
+#pragma once
+// ==========================================
+// HAL NATIVE : SOUS-ENSEMBLE ARDUINO-ESP32 POUR L'HÔTE
+// ==========================================
+// Juste ce que le firmware et ses drivers utilisent. Le matériel (GPIO, ADC,
+// bus, périphériques) est simulé par NativeHAL.h ; le temps est le temps réel.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <math.h>
+#include <algorithm>
+#include <cmath>
+
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "NativeRTOS.h"
+
+using std::min;
+using std::max;
+using std::isnan;
+using std::isinf;
+using std::abs;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+#define PULLDOWN 0x08
+#define INPUT_PULLDOWN 0x09
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define PI 3.1415926535897932384626433832795
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define IRAM_ATTR
+#define ARDUINO_ISR_ATTR
+#define F(s) (s)
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define digitalPinToInterrupt(p) (p)
+
+// strlcpy n'est pas dans toutes les glibc
+inline size_t omni_strlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+    if(size) { size_t n = len < size - 1 ? len : size - 1; memcpy(dst, src, n); dst[n] = 0; }
+    return len;
+}
+#define strlcpy omni_strlcpy
+
+inline bool isDigit(int c) { return isdigit(c) != 0; }
+inline bool isAlpha(int c) { return isalpha(c) != 0; }
+inline bool isSpace(int c) { return isspace(c) != 0; }
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+// --- Temps ---
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+inline void yield() { std::this_thread::yield(); }
+
+// --- GPIO / ADC (état simulé, voir NativeHAL.h) ---
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+uint16_t analogRead(uint8_t pin);
+uint32_t analogReadMilliVolts(uint8_t pin);
+void analogReadResolution(uint8_t bits);
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+// --- Mémoire ---
+bool psramFound();
+void* ps_malloc(size_t size);
+
+class EspClass {
+public:
+    uint32_t getHeapSize();
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    uint32_t getPsramSize();
+    uint32_t getFreePsram();
+    uint32_t getCpuFreqMHz() { return 240; }
+    const char* getChipModel() { return "ESP32-native"; }
+    void restart();
+};
+extern EspClass ESP;
+
+// --- Port série = stdout ---
+class HardwareSerial : public Stream {
+public:
+    using Print::write;
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    size_t write(uint8_t c) override { return fwrite(&c, 1, 1, stdout); }
+    size_t write(const uint8_t* buf, size_t size) override { return fwrite(buf, 1, size, stdout); }
+    void flush() override { fflush(stdout); }
+    operator bool() const { return true; }
+};
+extern HardwareSerial Serial;
+
+// Points d'entrée du sketch (appelés par main() de NativeHAL.cpp)
+void setup();
+void loop();
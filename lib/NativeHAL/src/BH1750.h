@@ -0,0 +1,53 @@
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+
+// BH1750 (sous-ensemble claws/BH1750) : opcode de mode puis lecture 2 octets.
+
+class BH1750 {
+public:
+    enum Mode {
+        UNCONFIGURED = 0,
+        CONTINUOUS_HIGH_RES_MODE = 0x10,
+        CONTINUOUS_HIGH_RES_MODE_2 = 0x11,
+        CONTINUOUS_LOW_RES_MODE = 0x13,
+        ONE_TIME_HIGH_RES_MODE = 0x20,
+        ONE_TIME_HIGH_RES_MODE_2 = 0x21,
+        ONE_TIME_LOW_RES_MODE = 0x23
+    };
+
+private:
+    uint8_t _addr;
+    Mode _mode = UNCONFIGURED;
+    TwoWire* _wire = &Wire;
+
+public:
+    explicit BH1750(uint8_t addr = 0x23) : _addr(addr) {}
+
+    bool begin(Mode mode = CONTINUOUS_HIGH_RES_MODE, uint8_t addr = 0x00, TwoWire* w = nullptr) {
+        if(addr) _addr = addr;
+        if(w) _wire = w;
+        return configure(mode);
+    }
+
+    bool configure(Mode mode) {
+        _wire->beginTransmission(_addr);
+        _wire->write((uint8_t)mode);
+        bool ok = _wire->endTransmission() == 0;
+        _mode = ok ? mode : UNCONFIGURED;
+        return ok;
+    }
+
+    bool measurementReady(bool maybeWait = false) { (void)maybeWait; return true; }
+
+    // -2 = non configuré, -1 = erreur bus (mêmes codes que la bibliothèque)
+    float readLightLevel() {
+        if(_mode == UNCONFIGURED) return -2.0f;
+        if(_wire->requestFrom(_addr, 2) != 2) return -1.0f;
+        uint8_t hi = _wire->read(), lo = _wire->read();
+        uint16_t raw = (hi << 8) | lo;
+        float lux = raw / 1.2f;
+        if(_mode == CONTINUOUS_HIGH_RES_MODE_2 || _mode == ONE_TIME_HIGH_RES_MODE_2) lux /= 2;
+        return lux;
+    }
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include <Arduino.h>
+#include "NativeHAL.h"
+
+// DHT (sous-ensemble Adafruit) : même coût bloquant qu'une vraie trame
+// (impulsion de réveil + ~4.5 ms de bits), même cache de 2 s entre deux lectures.
+
+#define DHT11 11
+#define DHT12 12
+#define DHT21 21
+#define DHT22 22
+#define AM2301 21
+
+class DHT {
+    uint8_t _pin, _type;
+    uint32_t _last = 0;
+    bool _ok = false, _first = true;
+    float _t = NAN, _h = NAN;
+
+public:
+    DHT(uint8_t pin, uint8_t type, uint8_t count = 6) : _pin(pin), _type(type) { (void)count; }
+    void begin(uint8_t usec = 55) { (void)usec; pinMode(_pin, INPUT_PULLUP); }
+
+    bool read(bool force = false) {
+        uint32_t now = millis();
+        if(!force && !_first && now - _last < 2000) return _ok;
+        _first = false; _last = now;
+        uint32_t us = (_type == DHT11 ? 18000 : 1100) + 4500;
+        Sim::counters().dhtReads++;
+        Sim::counters().dhtUs += us;
+        Sim::busy(us);
+        Sim::DHTState& st = Sim::dht(_pin);
+        _ok = st.present;
+        if(_ok) {
+            // Résolution du capteur : 1 unité (DHT11) ou 0.1 (DHT22)
+            float q = (_type == DHT11) ? 1.0f : 10.0f;
+            _t = roundf(st.temp * q) / q; _h = roundf(st.hum * q) / q;
+        }
+        return _ok;
+    }
+
+    float readTemperature(bool S = false, bool force = false) {
+        if(!read(force)) return NAN;
+        return S ? _t * 1.8f + 32 : _t;
+    }
+    float readHumidity(bool force = false) { return read(force) ? _h : NAN; }
+};
@@ -0,0 +1,109 @@
+#pragma once
+#include <Arduino.h>
+#include <OneWire.h>
+#include <array>
+
+// DallasTemperature (sous-ensemble) sur OneWire simulé : même séquence de
+// commandes que la bibliothèque réelle, conversion bloquante par défaut.
+// ROMs trouvées par begin() dans un tableau fixe : pas de tas, comme la bibliothèque.
+
+#define DEVICE_DISCONNECTED_C -127
+typedef uint8_t DeviceAddress[8];
+
+class DallasTemperature {
+    OneWire* _wire;
+    std::array<uint8_t, 8> _roms[16];
+    uint8_t _count = 0;
+    uint8_t _bits = 12;
+    bool _wait = true;
+
+public:
+    bool readScratchPad(const uint8_t* addr, uint8_t* pad) {
+        if(!_wire->reset()) return false;
+        _wire->select(addr);
+        _wire->write(0xBE);
+        _wire->read_bytes(pad, 9);
+        bool zero = true;
+        for(int i=0; i<9; i++) if(pad[i]) zero = false;
+        return !zero && OneWire::crc8(pad, 8) == pad[8];
+    }
+
+    struct request_t { bool result; unsigned long timestamp; operator bool() { return result; } };
+
+    explicit DallasTemperature(OneWire* w = nullptr) : _wire(w) {}
+    void setOneWire(OneWire* w) { _wire = w; }
+
+    void begin() {
+        _count = 0;
+        uint8_t rom[8];
+        _wire->reset_search();
+        while(_wire->search(rom)) {
+            if(OneWire::crc8(rom, 7) != rom[7] || _count >= 16) continue;
+            memcpy(_roms[_count++].data(), rom, 8);
+        }
+    }
+
+    uint8_t getDeviceCount() { return _count; }
+    uint8_t getDS18Count() { return _count; }
+
+    bool getAddress(uint8_t* addr, uint8_t index) {
+        if(index >= _count) return false;
+        memcpy(addr, _roms[index].data(), 8);
+        return true;
+    }
+
+    bool isConnected(const uint8_t* addr) { uint8_t pad[9]; return readScratchPad(addr, pad); }
+    bool isConnected(const uint8_t* addr, uint8_t* pad) { return readScratchPad(addr, pad); }
+
+    void setResolution(uint8_t bits) { for(uint8_t i=0; i<_count; i++) setResolution(_roms[i].data(), bits, true); _bits = constrain(bits, 9, 12); }
+    bool setResolution(const uint8_t* addr, uint8_t bits, bool skipGlobal = false) {
+        bits = constrain(bits, 9, 12);
+        uint8_t pad[9];
+        if(!readScratchPad(addr, pad)) return false;
+        _wire->reset();
+        _wire->select(addr);
+        _wire->write(0x4E);
+        _wire->write(pad[2]); _wire->write(pad[3]); _wire->write(((bits - 9) << 5) | 0x1F);
+        if(!skipGlobal) _bits = bits;
+        return true;
+    }
+    uint8_t getResolution() { return _bits; }
+
+    void setWaitForConversion(bool wait) { _wait = wait; }
+    bool getWaitForConversion() { return _wait; }
+
+    uint16_t millisToWaitForConversion(uint8_t bits) {
+        switch(bits) { case 9: return 94; case 10: return 188; case 11: return 375; default: return 750; }
+    }
+
+    bool isConversionComplete() { return _wire->read_bit() == 1; }
+
+    request_t requestTemperatures() {
+        request_t req = {true, millis()};
+        _wire->reset();
+        _wire->skip();
+        _wire->write(0x44);
+        if(_wait) delay(millisToWaitForConversion(_bits));
+        return req;
+    }
+    request_t requestTemperaturesByAddress(const uint8_t* addr) {
+        request_t req = {true, millis()};
+        if(!_wire->reset()) { req.result = false; return req; }
+        _wire->select(addr);
+        _wire->write(0x44);
+        if(_wait) delay(millisToWaitForConversion(_bits));
+        return req;
+    }
+
+    float getTempC(const uint8_t* addr) {
+        uint8_t pad[9];
+        if(!readScratchPad(addr, pad)) return DEVICE_DISCONNECTED_C;
+        return (int16_t)((pad[1] << 8) | pad[0]) / 16.0f;
+    }
+    float getTempCByIndex(uint8_t index) {
+        DeviceAddress a;
+        if(!getAddress(a, index)) return DEVICE_DISCONNECTED_C;
+        return getTempC(a);
+    }
+    static float toFahrenheit(float c) { return c * 1.8f + 32; }
+};
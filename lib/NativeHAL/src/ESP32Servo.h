@@ -0,0 +1,44 @@
+#pragma once
+#include <Arduino.h>
+#include "NativeHAL.h"
+
+// ESP32Servo (sous-ensemble) : la largeur d'impulsion courante est publiée
+// sur la broche simulée (Sim::pulse(pin)).
+
+#define MIN_PULSE_WIDTH 500
+#define MAX_PULSE_WIDTH 2500
+#define DEFAULT_PULSE_WIDTH 1500
+
+class ESP32PWM {
+public:
+    static void allocateTimer(int timer) { (void)timer; }
+};
+
+class Servo {
+    int _pin = -1, _min = 544, _max = 2400, _us = 0, _hz = 50;
+
+public:
+    void setPeriodHertz(int hz) { _hz = hz; }
+    int attach(int pin) { return attach(pin, 544, 2400); }
+    int attach(int pin, int minUs, int maxUs) {
+        _pin = pin; _min = max(minUs, MIN_PULSE_WIDTH); _max = min(maxUs, MAX_PULSE_WIDTH);
+        pinMode(pin, OUTPUT);
+        return 0;
+    }
+    void detach() { if(_pin >= 0) Sim::setPulse(_pin, 0); _pin = -1; }
+    bool attached() const { return _pin >= 0; }
+
+    void write(int value) {
+        if(value < MIN_PULSE_WIDTH) {
+            value = constrain(value, 0, 180);
+            value = map(value, 0, 180, _min, _max);
+        }
+        writeMicroseconds(value);
+    }
+    void writeMicroseconds(int us) {
+        _us = constrain(us, _min, _max);
+        if(_pin >= 0) Sim::setPulse(_pin, _us);
+    }
+    int read() { return map(_us, _min, _max, 0, 180); }
+    int readMicroseconds() { return _us; }
+};
@@ -0,0 +1,488 @@
+#pragma once
+#include <Arduino.h>
+#include <FS.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ==========================================
+// ESPAsyncWebServer EN MÉMOIRE (BUILD NATIF)
+// ==========================================
+// Même API que la pile réelle pour ce que le firmware utilise. Pas de socket :
+// un scénario exécute les requêtes avec AsyncWebServer::simRequest() et pilote
+// les clients WebSocket avec simConnect()/simReceive() ; les réponses sont
+// produites segment par segment comme par la tâche async_tcp.
+
+typedef enum {
+    HTTP_GET = 0b00000001,
+    HTTP_POST = 0b00000010,
+    HTTP_DELETE = 0b00000100,
+    HTTP_PUT = 0b00001000,
+    HTTP_PATCH = 0b00010000,
+    HTTP_HEAD = 0b00100000,
+    HTTP_OPTIONS = 0b01000000,
+    HTTP_ANY = 0b01111111,
+} WebRequestMethod;
+typedef uint8_t WebRequestMethodComposite;
+
+class AsyncWebServerRequest;
+class AsyncWebHandler;
+class AsyncWebSocket;
+class AsyncWebSocketClient;
+
+typedef std::function<void(AsyncWebServerRequest*)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest*, const String&, size_t, uint8_t*, size_t, bool)> ArUploadHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest*, uint8_t*, size_t, size_t, size_t)> ArBodyHandlerFunction;
+typedef std::function<size_t(uint8_t*, size_t, size_t)> AwsResponseFiller;
+typedef std::function<void(void)> ArDisconnectHandler;
+
+class AsyncWebParameter {
+    String _name, _value;
+    bool _post;
+public:
+    AsyncWebParameter(const String& name, const String& value, bool post = false) : _name(name), _value(value), _post(post) {}
+    const String& name() const { return _name; }
+    const String& value() const { return _value; }
+    bool isPost() const { return _post; }
+    bool isFile() const { return false; }
+};
+
+class AsyncWebHeader {
+    String _name, _value;
+public:
+    AsyncWebHeader(const String& name, const String& value) : _name(name), _value(value) {}
+    const String& name() const { return _name; }
+    const String& value() const { return _value; }
+};
+
+// --- Réponses : le corps est tiré par fill() segment par segment ---
+class AsyncWebServerResponse {
+protected:
+    int _code;
+    String _contentType;
+    std::vector<AsyncWebHeader> _headers;
+public:
+    AsyncWebServerResponse(int code = 200, const String& type = String()) : _code(code), _contentType(type) {}
+    virtual ~AsyncWebServerResponse() {}
+    void setCode(int code) { _code = code; }
+    int code() const { return _code; }
+    const String& contentType() const { return _contentType; }
+    void setContentType(const String& t) { _contentType = t; }
+    void addHeader(const String& name, const String& value) { _headers.emplace_back(name, value); }
+    const std::vector<AsyncWebHeader>& headers() const { return _headers; }
+    virtual size_t fill(uint8_t* buf, size_t maxLen) { (void)buf; (void)maxLen; return 0; }
+};
+
+class AsyncBasicResponse : public AsyncWebServerResponse {
+    std::string _content;
+    size_t _pos = 0;
+public:
+    AsyncBasicResponse(int code, const String& type, const char* data, size_t len)
+        : AsyncWebServerResponse(code, type), _content(data, len) {}
+    size_t fill(uint8_t* buf, size_t maxLen) override {
+        size_t n = min(maxLen, _content.size() - _pos);
+        memcpy(buf, _content.data() + _pos, n);
+        _pos += n;
+        return n;
+    }
+};
+
+class AsyncResponseStream : public AsyncWebServerResponse, public Print {
+    std::string _buf;
+    size_t _pos = 0;
+public:
+    using Print::write;
+    AsyncResponseStream(const String& type, size_t bufferSize) : AsyncWebServerResponse(200, type) { _buf.reserve(bufferSize); }
+    size_t write(uint8_t c) override { _buf.push_back((char)c); return 1; }
+    size_t write(const uint8_t* data, size_t len) override { _buf.append((const char*)data, len); return len; }
+    size_t fill(uint8_t* buf, size_t maxLen) override {
+        size_t n = min(maxLen, _buf.size() - _pos);
+        memcpy(buf, _buf.data() + _pos, n);
+        _pos += n;
+        return n;
+    }
+};
+
+class AsyncChunkedResponse : public AsyncWebServerResponse {
+    AwsResponseFiller _filler;
+    size_t _index = 0;
+public:
+    AsyncChunkedResponse(const String& type, AwsResponseFiller filler) : AsyncWebServerResponse(200, type), _filler(filler) {}
+    size_t fill(uint8_t* buf, size_t maxLen) override { size_t n = _filler(buf, maxLen, _index); _index += n; return n; }
+};
+
+class AsyncFileResponse : public AsyncWebServerResponse {
+    fs::File _f;
+public:
+    AsyncFileResponse(fs::File f, const String& type) : AsyncWebServerResponse(200, type), _f(f) {}
+    size_t fill(uint8_t* buf, size_t maxLen) override { return _f.read(buf, maxLen); }
+};
+
+// --- Requête ---
+class AsyncWebServerRequest {
+    friend class AsyncWebServer;
+    WebRequestMethod _method = HTTP_GET;
+    String _url, _contentType;
+    size_t _contentLength = 0;
+    std::vector<AsyncWebParameter> _params;
+    std::vector<AsyncWebHeader> _headers;
+    AsyncWebServerResponse* _response = nullptr;
+    ArDisconnectHandler _onDisconnect;
+    AsyncWebHandler* _handler = nullptr;   // Simulation : handler choisi, octets de corps reçus
+    size_t _received = 0;
+
+public:
+    void* _tempObject = nullptr;
+
+    // Comme la pile réelle : onDisconnect à la fermeture du client (réponse envoyée ou coupure), puis free(_tempObject)
+    ~AsyncWebServerRequest() { if(_onDisconnect) _onDisconnect(); delete _response; free(_tempObject); }
+    void onDisconnect(ArDisconnectHandler fn) { _onDisconnect = fn; }
+
+    WebRequestMethodComposite method() const { return _method; }
+    const String& url() const { return _url; }
+    const String& contentType() const { return _contentType; }
+    size_t contentLength() const { return _contentLength; }
+
+    size_t params() const { return _params.size(); }
+    AsyncWebParameter* getParam(size_t i) { return i < _params.size() ? &_params[i] : nullptr; }
+    bool hasParam(const String& name, bool post = false, bool file = false) const {
+        (void)file;
+        for(auto& p : _params) if(p.name() == name && p.isPost() == post) return true;
+        return false;
+    }
+    AsyncWebParameter* getParam(const String& name, bool post = false, bool file = false) {
+        (void)file;
+        for(auto& p : _params) if(p.name() == name && p.isPost() == post) return &p;
+        return nullptr;
+    }
+    bool hasArg(const char* name) const { for(auto& p : _params) if(p.name() == name) return true; return false; }
+    const String& arg(const String& name) const {
+        static const String empty;
+        for(auto& p : _params) if(p.name() == name) return p.value();
+        return empty;
+    }
+
+    size_t headers() const { return _headers.size(); }
+    bool hasHeader(const String& name) const {
+        for(auto& h : _headers) if(h.name().equalsIgnoreCase(name)) return true;
+        return false;
+    }
+    const AsyncWebHeader* getHeader(const String& name) const {
+        for(auto& h : _headers) if(h.name().equalsIgnoreCase(name)) return &h;
+        return nullptr;
+    }
+    String header(const char* name) const { const AsyncWebHeader* h = getHeader(name); return h ? h->value() : String(); }
+
+    void send(AsyncWebServerResponse* r) { delete _response; _response = r; }
+    void send(int code, const String& type = String(), const String& content = String()) { send(beginResponse(code, type, content)); }
+
+    AsyncWebServerResponse* beginResponse(int code, const String& type = String(), const String& content = String()) {
+        return new AsyncBasicResponse(code, type, content.c_str(), content.length());
+    }
+    AsyncWebServerResponse* beginResponse_P(int code, const String& type, const uint8_t* content, size_t len) {
+        return new AsyncBasicResponse(code, type, (const char*)content, len);
+    }
+    AsyncResponseStream* beginResponseStream(const String& type, size_t bufferSize = 1460) {
+        return new AsyncResponseStream(type, bufferSize);
+    }
+    AsyncWebServerResponse* beginChunkedResponse(const String& type, AwsResponseFiller filler) {
+        return new AsyncChunkedResponse(type, filler);
+    }
+};
+
+// --- Handlers ---
+class AsyncWebHandler {
+public:
+    virtual ~AsyncWebHandler() {}
+    virtual bool canHandle(AsyncWebServerRequest* req) { (void)req; return false; }
+    virtual void handleRequest(AsyncWebServerRequest* req) { (void)req; }
+    virtual void handleBody(AsyncWebServerRequest* req, uint8_t* data, size_t len, size_t index, size_t total) {
+        (void)req; (void)data; (void)len; (void)index; (void)total;
+    }
+};
+
+class AsyncCallbackWebHandler : public AsyncWebHandler {
+    String _uri;
+    WebRequestMethodComposite _method;
+    ArRequestHandlerFunction _onRequest;
+    ArBodyHandlerFunction _onBody;
+public:
+    AsyncCallbackWebHandler(const String& uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest, ArBodyHandlerFunction onBody)
+        : _uri(uri), _method(method), _onRequest(onRequest), _onBody(onBody) {}
+
+    // Même règle que la pile réelle : URI exacte, sous-chemin "uri/..." ou préfixe "uri*"
+    bool canHandle(AsyncWebServerRequest* req) override {
+        if(!(_method & req->method())) return false;
+        if(_uri.endsWith("*")) return req->url().startsWith(_uri.substring(0, _uri.length() - 1));
+        return req->url() == _uri || req->url().startsWith(_uri + "/");
+    }
+    void handleRequest(AsyncWebServerRequest* req) override { if(_onRequest) _onRequest(req); else req->send(500); }
+    void handleBody(AsyncWebServerRequest* req, uint8_t* data, size_t len, size_t index, size_t total) override {
+        if(_onBody) _onBody(req, data, len, index, total);
+    }
+};
+
+class AsyncStaticWebHandler : public AsyncWebHandler {
+    String _uri, _path, _default = "index.htm", _cacheControl;
+    fs::FS _fs;
+
+    static String mime(const String& p) {
+        if(p.endsWith(".html") || p.endsWith(".htm")) return "text/html";
+        if(p.endsWith(".css")) return "text/css";
+        if(p.endsWith(".js")) return "application/javascript";
+        if(p.endsWith(".json")) return "application/json";
+        if(p.endsWith(".ico")) return "image/x-icon";
+        if(p.endsWith(".png")) return "image/png";
+        if(p.endsWith(".svg")) return "image/svg+xml";
+        return "text/plain";
+    }
+
+public:
+    AsyncStaticWebHandler(const char* uri, fs::FS& fs, const char* path, const char* cacheControl)
+        : _uri(uri), _path(path), _cacheControl(cacheControl ? cacheControl : ""), _fs(fs) {}
+
+    AsyncStaticWebHandler& setDefaultFile(const char* f) { _default = f; return *this; }
+    AsyncStaticWebHandler& setCacheControl(const char* c) { _cacheControl = c; return *this; }
+
+    bool canHandle(AsyncWebServerRequest* req) override {
+        return (req->method() == HTTP_GET || req->method() == HTTP_HEAD) && req->url().startsWith(_uri);
+    }
+
+    // Fichier demandé, sinon sa version .gz (servie avec Content-Encoding: gzip)
+    void handleRequest(AsyncWebServerRequest* req) override {
+        String rel = req->url().substring(_uri.length());
+        String path = _path + (_path.endsWith("/") || rel.startsWith("/") || !rel.length() ? "" : "/") + rel;
+        if(path.endsWith("/") || !rel.length()) path += _default;
+        bool gz = false;
+        if(!_fs.exists(path)) { if(!_fs.exists(path + ".gz")) { req->send(404); return; } gz = true; }
+        fs::File f = _fs.open(gz ? path + ".gz" : path, "r");
+        if(!f) { req->send(404); return; }
+        AsyncWebServerResponse* r = new AsyncFileResponse(f, mime(path));
+        if(gz) r->addHeader("Content-Encoding", "gzip");
+        if(_cacheControl.length()) r->addHeader("Cache-Control", _cacheControl);
+        req->send(r);
+    }
+};
+
+// --- WebSocket ---
+typedef enum { WS_EVT_CONNECT, WS_EVT_DISCONNECT, WS_EVT_PONG, WS_EVT_ERROR, WS_EVT_DATA } AwsEventType;
+typedef enum { WS_CONTINUATION, WS_TEXT, WS_BINARY, WS_DISCONNECT = 0x08, WS_PING, WS_PONG } AwsFrameType;
+typedef struct {
+    uint8_t message_opcode;
+    uint32_t num;
+    uint8_t final;
+    uint8_t masked;
+    uint8_t opcode;
+    uint64_t len;
+    uint8_t mask[4];
+    uint64_t index;
+} AwsFrameInfo;
+typedef std::function<void(AsyncWebSocket*, AsyncWebSocketClient*, AwsEventType, void*, uint8_t*, size_t)> AwsEventHandler;
+
+class AsyncWebSocketClient {
+    AsyncWebSocket* _server;
+    uint32_t _id;
+public:
+    struct Message { bool binary; std::string data; };
+    std::vector<Message> outbox;    // Trames envoyées, à vider par le scénario
+    uint64_t bytesOut = 0;
+    size_t queued = 0;              // Trames en attente annoncées par queueLen() (client lent simulé)
+
+    AsyncWebSocketClient(AsyncWebSocket* server, uint32_t id) : _server(server), _id(id) {}
+    uint32_t id() const { return _id; }
+    AsyncWebSocket* server() { return _server; }
+    bool canSend() const { return true; }
+    size_t queueLen() const { return queued; }
+
+    void push(bool binary, const char* data, size_t len) { outbox.push_back({binary, std::string(data, len)}); bytesOut += len; }
+    void text(const char* m, size_t len) { push(false, m, len); }
+    void text(const char* m) { push(false, m, strlen(m)); }
+    void text(const String& m) { push(false, m.c_str(), m.length()); }
+    void binary(const char* m, size_t len) { push(true, m, len); }
+    void binary(const uint8_t* m, size_t len) { push(true, (const char*)m, len); }
+};
+
+class AsyncWebSocket : public AsyncWebHandler {
+    String _url;
+    AwsEventHandler _handler;
+    std::vector<std::unique_ptr<AsyncWebSocketClient>> _clients;
+    uint32_t _nextId = 1;
+    std::recursive_mutex _m;
+
+public:
+    explicit AsyncWebSocket(const String& url) : _url(url) { instance() = this; }
+    // Dernier WebSocket construit (point d'accès des scénarios)
+    static AsyncWebSocket*& instance() { static AsyncWebSocket* ws = nullptr; return ws; }
+    const char* url() const { return _url.c_str(); }
+    void onEvent(AwsEventHandler h) { _handler = h; }
+
+    size_t count() { std::lock_guard<std::recursive_mutex> lk(_m); return _clients.size(); }
+    AsyncWebSocketClient* client(uint32_t id) {
+        std::lock_guard<std::recursive_mutex> lk(_m);
+        for(auto& c : _clients) if(c->id() == id) return c.get();
+        return nullptr;
+    }
+    void cleanupClients(uint16_t maxClients = 8) { (void)maxClients; }
+    bool availableForWriteAll() { return true; }
+
+    void textAll(const char* m, size_t len) { std::lock_guard<std::recursive_mutex> lk(_m); for(auto& c : _clients) c->text(m, len); }
+    void textAll(const char* m) { textAll(m, strlen(m)); }
+    void textAll(const String& m) { textAll(m.c_str(), m.length()); }
+    void text(uint32_t id, const char* m, size_t len) { std::lock_guard<std::recursive_mutex> lk(_m); if(auto c = client(id)) c->text(m, len); }
+    void text(uint32_t id, const char* m) { text(id, m, strlen(m)); }
+    void text(uint32_t id, const String& m) { text(id, m.c_str(), m.length()); }
+    void binaryAll(const char* m, size_t len) { std::lock_guard<std::recursive_mutex> lk(_m); for(auto& c : _clients) c->binary(m, len); }
+    void binaryAll(const uint8_t* m, size_t len) { binaryAll((const char*)m, len); }
+    void binary(uint32_t id, const char* m, size_t len) { std::lock_guard<std::recursive_mutex> lk(_m); if(auto c = client(id)) c->binary(m, len); }
+    void binary(uint32_t id, const uint8_t* m, size_t len) { binary(id, (const char*)m, len); }
+
+    // --- Simulation ---
+    AsyncWebSocketClient* simConnect() {
+        AsyncWebSocketClient* c;
+        { std::lock_guard<std::recursive_mutex> lk(_m); _clients.emplace_back(new AsyncWebSocketClient(this, _nextId++)); c = _clients.back().get(); }
+        if(_handler) _handler(this, c, WS_EVT_CONNECT, nullptr, nullptr, 0);
+        return c;
+    }
+    void simDisconnect(uint32_t id) {
+        AsyncWebSocketClient* c = client(id);
+        if(!c) return;
+        if(_handler) _handler(this, c, WS_EVT_DISCONNECT, nullptr, nullptr, 0);
+        std::lock_guard<std::recursive_mutex> lk(_m);
+        for(size_t i=0; i<_clients.size(); i++) if(_clients[i]->id() == id) { _clients.erase(_clients.begin() + i); break; }
+    }
+    // Trame complète non fragmentée
+    void simReceive(uint32_t id, const uint8_t* data, size_t len, bool binary) {
+        AsyncWebSocketClient* c = client(id);
+        if(!c || !_handler) return;
+        std::vector<uint8_t> copy(data, data + len);
+        copy.push_back(0);      // La pile réelle termine les trames texte par un 0
+        AwsFrameInfo info = {};
+        info.final = 1; info.index = 0; info.len = len;
+        info.opcode = info.message_opcode = binary ? WS_BINARY : WS_TEXT;
+        _handler(this, c, WS_EVT_DATA, &info, copy.data(), len);
+    }
+};
+
+// --- Serveur ---
+class AsyncWebServer {
+    std::vector<AsyncWebHandler*> _handlers;
+    ArRequestHandlerFunction _notFound;
+
+    static String urlDecode(const String& s) {
+        String out;
+        for(unsigned i=0; i<s.length(); i++) {
+            char c = s[i];
+            if(c == '+') out += ' ';
+            else if(c == '%' && i + 2 < s.length()) { char h[3] = {s[i + 1], s[i + 2], 0}; out += (char)strtol(h, nullptr, 16); i += 2; }
+            else out += c;
+        }
+        return out;
+    }
+    static void parseParams(const String& q, bool post, std::vector<AsyncWebParameter>& out) {
+        int start = 0;
+        while(start < (int)q.length()) {
+            int amp = q.indexOf('&', start);
+            if(amp < 0) amp = q.length();
+            String kv = q.substring(start, amp);
+            int eq = kv.indexOf('=');
+            if(kv.length()) out.emplace_back(urlDecode(eq < 0 ? kv : kv.substring(0, eq)), eq < 0 ? String() : urlDecode(kv.substring(eq + 1)), post);
+            start = amp + 1;
+        }
+    }
+
+public:
+    explicit AsyncWebServer(uint16_t port) { (void)port; instance() = this; }
+    // Dernier serveur construit (point d'accès des scénarios)
+    static AsyncWebServer*& instance() { static AsyncWebServer* srv = nullptr; return srv; }
+    void begin() {}
+    void end() {}
+
+    AsyncWebHandler& addHandler(AsyncWebHandler* h) { _handlers.push_back(h); return *h; }
+    AsyncCallbackWebHandler& on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest,
+                                ArUploadHandlerFunction onUpload = nullptr, ArBodyHandlerFunction onBody = nullptr) {
+        (void)onUpload;
+        auto* h = new AsyncCallbackWebHandler(uri, method, onRequest, onBody);
+        _handlers.push_back(h);
+        return *h;
+    }
+    AsyncCallbackWebHandler& on(const char* uri, ArRequestHandlerFunction onRequest) { return on(uri, HTTP_ANY, onRequest); }
+    AsyncStaticWebHandler& serveStatic(const char* uri, fs::FS& fs, const char* path, const char* cacheControl = nullptr) {
+        auto* h = new AsyncStaticWebHandler(uri, fs, path, cacheControl);
+        _handlers.push_back(h);
+        return *h;
+    }
+    void onNotFound(ArRequestHandlerFunction fn) { _notFound = fn; }
+
+    // --- Simulation : une requête HTTP complète ---
+    struct SimResponse {
+        int code = 0;
+        String contentType, body;
+        std::vector<AsyncWebHeader> headers;
+        size_t segments = 0;    // Appels au producteur du corps
+        const String* header(const char* name) const {
+            for(auto& h : headers) if(h.name().equalsIgnoreCase(name)) return &h.value();
+            return nullptr;
+        }
+    };
+
+    // `segment` = taille des blocs de corps reçus et des segments de réponse (≈ MSS TCP)
+    SimResponse simRequest(WebRequestMethod method, const String& url, const String& body = String(),
+                           const String& contentType = "application/json",
+                           const std::vector<AsyncWebHeader>& headers = {}, size_t segment = 1436) {
+        AsyncWebServerRequest* req = simOpen(method, url, body.length(), contentType, headers);
+        if(!contentType.startsWith("application/x-www-form-urlencoded")) {
+            for(size_t i=0; i<body.length(); i += segment) simBody(req, body.substring(i, i + segment));
+        } else parseParams(body, true, req->_params);
+        return simClose(req, segment);
+    }
+
+    // Requête reçue en plusieurs fois : envois entrelacés, client coupé en cours de corps (simAbort)
+    AsyncWebServerRequest* simOpen(WebRequestMethod method, const String& url, size_t total,
+                                   const String& contentType = "application/json",
+                                   const std::vector<AsyncWebHeader>& headers = {}) {
+        AsyncWebServerRequest* req = new AsyncWebServerRequest();
+        req->_method = method;
+        int q = url.indexOf('?');
+        req->_url = q < 0 ? url : url.substring(0, q);
+        if(q >= 0) parseParams(url.substring(q + 1), false, req->_params);
+        req->_contentType = contentType;
+        req->_contentLength = total;
+        req->_headers = headers;
+        for(auto h : _handlers) if(h->canHandle(req)) { req->_handler = h; break; }
+        return req;
+    }
+    void simBody(AsyncWebServerRequest* req, const String& part) {
+        std::vector<uint8_t> chunk((const uint8_t*)part.c_str(), (const uint8_t*)part.c_str() + part.length());
+        if(req->_handler && chunk.size()) req->_handler->handleBody(req, chunk.data(), chunk.size(), req->_received, req->_contentLength);
+        req->_received += chunk.size();
+    }
+    void simAbort(AsyncWebServerRequest* req) { delete req; }
+
+    // Fin du corps : handler, réponse lue segment par segment, puis fermeture
+    SimResponse simClose(AsyncWebServerRequest* req, size_t segment = 1436) {
+        if(req->_handler) req->_handler->handleRequest(req);
+        else if(_notFound) _notFound(req);
+        else req->send(404);
+
+        SimResponse out;
+        AsyncWebServerResponse* r = req->_response;
+        if(r) {                                 // Sans réponse (code 0), le client attendrait indéfiniment
+            out.code = r->code();
+            out.contentType = r->contentType();
+            out.headers = r->headers();
+            std::vector<uint8_t> buf(segment);
+            if(req->_method != HTTP_HEAD) {
+                for(;;) {
+                    size_t n = r->fill(buf.data(), segment);
+                    if(!n) break;
+                    out.body.concat((const char*)buf.data(), n);
+                    out.segments++;
+                }
+            }
+        }
+        delete req;
+        return out;
+    }
+};
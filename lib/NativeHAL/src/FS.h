@@ -0,0 +1,78 @@
+#pragma once
+#include <Arduino.h>
+#include <memory>
+#include <sys/stat.h>
+
+// fs::FS / fs::File sur un répertoire de l'hôte (OMNI_SIM_FS, défaut ./sim_fs)
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+class File : public Stream {
+    std::shared_ptr<FILE> _f;
+    String _path;
+public:
+    using Print::write;
+
+    File() {}
+    File(FILE* f, const String& path) : _f(f, [](FILE* p) { fclose(p); }), _path(path) {}
+
+    explicit operator bool() const { return (bool)_f; }
+    const char* path() const { return _path.c_str(); }
+    const char* name() const { int s = _path.lastIndexOf('/'); return _path.c_str() + (s >= 0 ? s + 1 : 0); }
+    bool isDirectory() const { return false; }
+
+    size_t size() const {
+        if(!_f) return 0;
+        struct stat st;
+        fflush(_f.get());
+        return fstat(fileno(_f.get()), &st) == 0 ? st.st_size : 0;
+    }
+    size_t position() const { return _f ? ftell(_f.get()) : 0; }
+    bool seek(uint32_t pos) { return _f && fseek(_f.get(), pos, SEEK_SET) == 0; }
+
+    int available() override { return _f ? (int)(size() - position()) : 0; }
+    int read() override { return _f ? fgetc(_f.get()) : -1; }
+    int peek() override {
+        if(!_f) return -1;
+        int c = fgetc(_f.get());
+        if(c >= 0) ungetc(c, _f.get());
+        return c;
+    }
+    size_t read(uint8_t* buf, size_t len) { return _f ? fread(buf, 1, len, _f.get()) : 0; }
+    size_t readBytes(char* buf, size_t len) override { return read((uint8_t*)buf, len); }
+
+    size_t write(uint8_t c) override { return _f ? fwrite(&c, 1, 1, _f.get()) : 0; }
+    size_t write(const uint8_t* buf, size_t len) override { return _f ? fwrite(buf, 1, len, _f.get()) : 0; }
+    void flush() override { if(_f) fflush(_f.get()); }
+    void close() { _f.reset(); }
+};
+
+class FS {
+protected:
+    String _root;
+    String host(const char* path) const { return _root + (path[0] == '/' ? "" : "/") + path; }
+public:
+    explicit FS(const char* root = "sim_fs") : _root(root) {}
+
+    File open(const char* path, const char* mode = FILE_READ, bool create = false) {
+        (void)create;
+        FILE* f = fopen(host(path).c_str(), strcmp(mode, "w") == 0 ? "wb" : strcmp(mode, "a") == 0 ? "ab" : "rb");
+        return f ? File(f, path) : File();
+    }
+    File open(const String& path, const char* mode = FILE_READ, bool create = false) { return open(path.c_str(), mode, create); }
+    bool exists(const char* path) { struct stat st; return stat(host(path).c_str(), &st) == 0; }
+    bool exists(const String& path) { return exists(path.c_str()); }
+    bool remove(const char* path) { return ::remove(host(path).c_str()) == 0; }
+    bool rename(const char* from, const char* to) { return ::rename(host(from).c_str(), host(to).c_str()) == 0; }
+    bool mkdir(const char* path) { return ::mkdir(host(path).c_str(), 0755) == 0; }
+    const String& hostRoot() const { return _root; }
+};
+
+} // namespace fs
+
+using fs::FS;
+using fs::File;
@@ -0,0 +1,68 @@
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+#include "NativeHAL.h"
+
+// LiquidCrystal_I2C (sous-ensemble) : même protocole que la bibliothèque, un
+// octet PCF8574 par transaction (3 transactions par quartet, 6 par caractère),
+// mêmes attentes après init/clear/home.
+
+class LiquidCrystal_I2C : public Print {
+    uint8_t _addr, _cols, _rows;
+    uint8_t _backlight = 0x08;
+    uint8_t _displayFunction = 0x00, _displayControl = 0x04 | 0x00 | 0x00, _displayMode = 0x02;
+
+    static const uint8_t EN = 0x04, RS = 0x01;
+
+    void expanderWrite(uint8_t data) {
+        Wire.beginTransmission(_addr);
+        Wire.write(data | _backlight);
+        Wire.endTransmission();
+    }
+    void pulseEnable(uint8_t data) {
+        expanderWrite(data | EN);
+        Sim::busy(1);
+        expanderWrite(data & ~EN);
+        Sim::busy(50);
+    }
+    void write4bits(uint8_t v) { expanderWrite(v); pulseEnable(v); }
+    void send(uint8_t v, uint8_t mode) { write4bits((v & 0xF0) | mode); write4bits(((v << 4) & 0xF0) | mode); }
+    void command(uint8_t v) { send(v, 0); }
+
+public:
+    using Print::write;
+
+    LiquidCrystal_I2C(uint8_t addr, uint8_t cols, uint8_t rows) : _addr(addr), _cols(cols), _rows(rows) {}
+
+    void init() { Wire.begin(); _displayFunction = 0x00; begin(_cols, _rows); }
+    void begin(uint8_t cols, uint8_t rows, uint8_t charsize = 0) {
+        (void)cols; (void)charsize;
+        if(rows > 1) _displayFunction |= 0x08;
+        Sim::busy(50000);
+        expanderWrite(_backlight);
+        Sim::busy(1000000);
+        write4bits(0x03 << 4); Sim::busy(4500);
+        write4bits(0x03 << 4); Sim::busy(4500);
+        write4bits(0x03 << 4); Sim::busy(150);
+        write4bits(0x02 << 4);
+        command(0x20 | _displayFunction);
+        display();
+        clear();
+        command(0x04 | _displayMode);
+        home();
+    }
+
+    void clear() { command(0x01); Sim::busy(2000); }
+    void home() { command(0x02); Sim::busy(2000); }
+    void setCursor(uint8_t col, uint8_t row) {
+        static const uint8_t offsets[] = {0x00, 0x40, 0x14, 0x54};
+        if(row >= _rows) row = _rows - 1;
+        command(0x80 | (col + offsets[row & 3]));
+    }
+    void display() { _displayControl |= 0x04; command(0x08 | _displayControl); }
+    void noDisplay() { _displayControl &= ~0x04; command(0x08 | _displayControl); }
+    void backlight() { _backlight = 0x08; expanderWrite(0); }
+    void noBacklight() { _backlight = 0x00; expanderWrite(0); }
+
+    size_t write(uint8_t c) override { send(c, RS); return 1; }
+};
@@ -0,0 +1,21 @@
+#pragma once
+#include "FS.h"
+
+namespace fs {
+
+class LittleFSFS : public FS {
+public:
+    LittleFSFS() : FS(getenv("OMNI_SIM_FS") ? getenv("OMNI_SIM_FS") : "sim_fs") {}
+    bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10, const char* label = "spiffs") {
+        (void)formatOnFail; (void)basePath; (void)maxOpenFiles; (void)label;
+        struct stat st;
+        return stat(_root.c_str(), &st) == 0 || ::mkdir(_root.c_str(), 0755) == 0;
+    }
+    void end() {}
+    size_t totalBytes() { return 1441792; }
+    size_t usedBytes() { return 0; }
+};
+
+} // namespace fs
+
+extern fs::LittleFSFS LittleFS;
@@ -0,0 +1,653 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <WiFi.h>
+#include <Wire.h>
+#include <ESPAsyncWebServer.h>
+#include <esp_timer.h>
+#include <esp_adc_cal.h>
+#include <driver/rmt.h>
+#include "NativeHAL.h"
+#include <chrono>
+#include <memory>
+#include <new>
+#include <random>
+
+// ==========================================
+// RUNTIME DU BUILD NATIF
+// ==========================================
+// Globales Arduino, base de temps, GPIO simulés et main() : setup() puis loop()
+// jusqu'à la fin du scénario. Le scénario par défaut (faible) branche un banc
+// de périphériques émulés ; un test le remplace en redéfinissant Sim::scenario*.
+
+HardwareSerial Serial;
+EspClass ESP;
+TwoWire Wire;
+fs::LittleFSFS LittleFS;
+WiFiClass WiFi;
+
+// --- Temps ---
+static std::chrono::steady_clock::time_point bootTime() {
+    static const auto t0 = std::chrono::steady_clock::now();
+    return t0;
+}
+static uint64_t uptimeUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - bootTime()).count();
+}
+
+uint32_t millis() { return (uint32_t)(uptimeUs() / 1000); }
+uint32_t micros() { return (uint32_t)uptimeUs(); }
+void delay(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+void delayMicroseconds(uint32_t us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+
+static std::mutex rngLock;
+static std::mt19937 rng(0x0E5B);
+long random(long max) { return max > 0 ? random(0, max) : 0; }
+long random(long min, long max) {
+    if(min >= max) return min;
+    std::lock_guard<std::mutex> lk(rngLock);
+    return std::uniform_int_distribution<long>(min, max - 1)(rng);
+}
+void randomSeed(unsigned long seed) { std::lock_guard<std::mutex> lk(rngLock); rng.seed(seed); }
+
+// --- GPIO / ADC ---
+struct PinIsr { void (*fn)() = nullptr; void (*fnArg)(void*) = nullptr; void* arg = nullptr; int mode = 0; };
+
+static std::atomic<int> pinLevel[Sim::PINS], pinMode_[Sim::PINS];
+static std::atomic<bool> pinForced[Sim::PINS];
+static std::atomic<uint16_t> pinAnalog[Sim::PINS];
+static std::atomic<uint32_t> pinPulse[Sim::PINS];
+static std::atomic<uint8_t> adcBits{12};
+static PinIsr pinIsr[Sim::PINS];
+static std::mutex isrLock;
+
+static bool validPin(int pin) { return pin >= 0 && pin < Sim::PINS; }
+
+static struct PinInit {
+    PinInit() { for(int i=0; i<Sim::PINS; i++) { pinLevel[i] = LOW; pinMode_[i] = -1; pinForced[i] = false; pinAnalog[i] = 0; pinPulse[i] = 0; } }
+} pinInit;
+
+static std::atomic<uint64_t> pinLowSince[Sim::PINS];
+static void dhtRespond(int pin, uint64_t lowUs);
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if(!validPin(pin)) return;
+    int prev = pinMode_[pin].exchange(mode);
+    if(mode == OUTPUT && prev != OUTPUT) pinLowSince[pin] = uptimeUs();
+    if(prev == OUTPUT && mode != OUTPUT && pinLevel[pin] == LOW && Sim::dht(pin).present) {
+        dhtRespond(pin, uptimeUs() - pinLowSince[pin]);
+        return;
+    }
+    if(!pinForced[pin] && (mode == INPUT_PULLUP || mode == INPUT_PULLDOWN)) pinLevel[pin] = mode == INPUT_PULLUP ? HIGH : LOW;
+}
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if(!validPin(pin)) return;
+    if(pinLevel[pin].exchange(val ? HIGH : LOW) != LOW && !val) pinLowSince[pin] = uptimeUs();
+}
+int digitalRead(uint8_t pin) { return validPin(pin) ? pinLevel[pin].load() : LOW; }
+uint16_t analogRead(uint8_t pin) { return validPin(pin) ? pinAnalog[pin] >> (12 - min<uint8_t>(adcBits, 12)) : 0; }
+uint32_t analogReadMilliVolts(uint8_t pin) { return validPin(pin) ? pinAnalog[pin] * 3300u / 4095u : 0; }
+void analogReadResolution(uint8_t bits) { adcBits = bits; }
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode) {
+    if(!validPin(pin)) return;
+    std::lock_guard<std::mutex> lk(isrLock);
+    pinIsr[pin] = PinIsr();
+    pinIsr[pin].fn = isr; pinIsr[pin].mode = mode;
+}
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode) {
+    if(!validPin(pin)) return;
+    std::lock_guard<std::mutex> lk(isrLock);
+    pinIsr[pin] = PinIsr();
+    pinIsr[pin].fnArg = isr; pinIsr[pin].arg = arg; pinIsr[pin].mode = mode;
+}
+void detachInterrupt(uint8_t pin) { if(validPin(pin)) { std::lock_guard<std::mutex> lk(isrLock); pinIsr[pin] = PinIsr(); } }
+
+// --- Trame DHT émise sur la broche ---
+// Relâchement après l'impulsion de start : réponse 80/80 µs puis 40 bits
+// (50 µs bas + 26 µs haut = 0, 70 µs haut = 1), front par front depuis un
+// thread qui attend activement chaque échéance, comme le capteur réel.
+static void dhtRespond(int pin, uint64_t lowUs) {
+    Sim::DHTState& st = Sim::dht(pin);
+    bool dht11 = st.model == 11;
+    Sim::setDigital(pin, HIGH);     // Pull-up : la ligne remonte au relâchement
+    if(lowUs < (dht11 ? 18000u : 800u)) return;
+
+    float t = st.temp, h = st.hum;
+    uint8_t b[5];
+    if(dht11) {
+        long hr = lroundf(h * 10), tr = lroundf(fabsf(t) * 10);
+        b[0] = hr / 10; b[1] = hr % 10;
+        b[2] = tr / 10; b[3] = (tr % 10) | (t < 0 ? 0x80 : 0);
+    } else {
+        uint16_t hr = (uint16_t)lroundf(h * 10), tr = (uint16_t)lroundf(fabsf(t) * 10);
+        b[0] = hr >> 8; b[1] = hr & 0xFF;
+        b[2] = (tr >> 8) | (t < 0 ? 0x80 : 0); b[3] = tr & 0xFF;
+    }
+    b[4] = b[0] + b[1] + b[2] + b[3];
+    if(st.corrupt) { st.corrupt--; b[1] ^= 0x01; }
+
+    std::thread([pin, b]() {
+        auto at = std::chrono::steady_clock::now();
+        auto edge = [&](uint32_t afterUs, int lvl) {
+            at += std::chrono::microseconds(afterUs);
+            while(std::chrono::steady_clock::now() < at) {}
+            Sim::setDigital(pin, lvl);
+        };
+        edge(30, LOW); edge(80, HIGH); edge(80, LOW);
+        for(int i=0; i<40; i++) {
+            bool one = b[i / 8] & (0x80 >> (i % 8));
+            edge(50, HIGH); edge(one ? 70 : 26, LOW);
+        }
+        edge(50, HIGH);
+        Sim::dht(pin).frames++;
+    }).detach();
+    Sim::counters().dhtReads++;
+    Sim::counters().dhtUs += lowUs;
+}
+
+// --- esp_timer : un thread par armement, annulé par numéro de génération ---
+struct TimerState {
+    esp_timer_cb_t cb;
+    void* arg;
+    std::atomic<uint32_t> gen{0};
+};
+struct NativeTimer { std::shared_ptr<TimerState> st; };
+
+static esp_err_t timerStart(esp_timer_handle_t t, uint64_t us, bool periodic) {
+    if(!t) return ESP_ERR_INVALID_STATE;
+    std::shared_ptr<TimerState> st = t->st;
+    uint32_t g = ++st->gen;
+    std::thread([st, g, us, periodic]() {
+        auto at = std::chrono::steady_clock::now();
+        do {
+            at += std::chrono::microseconds(us);
+            std::this_thread::sleep_until(at);
+            if(st->gen != g) return;
+            st->cb(st->arg);
+        } while(periodic);
+    }).detach();
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out) {
+    if(!args || !args->callback || !out) return ESP_FAIL;
+    *out = new NativeTimer{std::make_shared<TimerState>()};
+    (*out)->st->cb = args->callback;
+    (*out)->st->arg = args->arg;
+    return ESP_OK;
+}
+esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeoutUs) { return timerStart(t, timeoutUs, false); }
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t t, uint64_t periodUs) { return timerStart(t, periodUs, true); }
+esp_err_t esp_timer_stop(esp_timer_handle_t t) { if(t) t->st->gen++; return ESP_OK; }
+esp_err_t esp_timer_delete(esp_timer_handle_t t) { if(t) { t->st->gen++; delete t; } return ESP_OK; }
+int64_t esp_timer_get_time() { return (int64_t)uptimeUs(); }
+
+// --- ADC continu (DMA) : conversions générées à la lecture selon le temps écoulé ---
+static const uint8_t ADC1_PINS[8] = {36, 37, 38, 39, 32, 33, 34, 35};
+static std::atomic<uint16_t> pinNoise[Sim::PINS];
+static struct AdcDma {
+    std::mutex m;
+    bool init = false, running = false;
+    uint32_t freq = 20000;
+    adc_digi_pattern_config_t pattern[8];
+    uint32_t patternNum = 0, idx = 0;
+    uint64_t lastUs = 0;
+} adcDma;
+
+esp_err_t adc_digi_initialize(const adc_digi_init_config_t* cfg) {
+    std::lock_guard<std::mutex> lk(adcDma.m);
+    if(!cfg || cfg->adc2_chan_mask) return ESP_ERR_INVALID_ARG;     // ADC2 non disponible en DMA sur ESP32
+    adcDma.init = true;
+    return ESP_OK;
+}
+esp_err_t adc_digi_deinitialize() {
+    std::lock_guard<std::mutex> lk(adcDma.m);
+    adcDma.init = adcDma.running = false;
+    return ESP_OK;
+}
+esp_err_t adc_digi_controller_configure(const adc_digi_configuration_t* cfg) {
+    std::lock_guard<std::mutex> lk(adcDma.m);
+    if(!adcDma.init || !cfg || !cfg->pattern_num || cfg->pattern_num > 8) return ESP_ERR_INVALID_STATE;
+    if(cfg->sample_freq_hz < SOC_ADC_SAMPLE_FREQ_THRES_LOW || cfg->sample_freq_hz > SOC_ADC_SAMPLE_FREQ_THRES_HIGH) return ESP_ERR_INVALID_ARG;
+    adcDma.freq = cfg->sample_freq_hz;
+    adcDma.patternNum = cfg->pattern_num;
+    memcpy(adcDma.pattern, cfg->adc_pattern, cfg->pattern_num * sizeof(adc_digi_pattern_config_t));
+    adcDma.idx = 0;
+    return ESP_OK;
+}
+esp_err_t adc_digi_start() {
+    std::lock_guard<std::mutex> lk(adcDma.m);
+    if(!adcDma.init || !adcDma.patternNum) return ESP_ERR_INVALID_STATE;
+    adcDma.running = true;
+    adcDma.lastUs = uptimeUs();
+    return ESP_OK;
+}
+esp_err_t adc_digi_stop() {
+    std::lock_guard<std::mutex> lk(adcDma.m);
+    adcDma.running = false;
+    return ESP_OK;
+}
+esp_err_t adc_digi_read_bytes(uint8_t* buf, uint32_t len, uint32_t* out, uint32_t timeoutMs) {
+    *out = 0;
+    uint32_t want = len / sizeof(adc_digi_output_data_t);
+    uint64_t deadline = uptimeUs() + (uint64_t)timeoutMs * 1000;
+    for(;;) {
+        {
+            std::lock_guard<std::mutex> lk(adcDma.m);
+            if(!adcDma.running) return ESP_ERR_INVALID_STATE;
+            uint64_t now = uptimeUs();
+            uint64_t avail = (now - adcDma.lastUs) * adcDma.freq / 1000000;
+            // Buffer plein (lecteur en retard) : les plus anciennes conversions sont perdues
+            if(avail > 4 * want) { adcDma.lastUs = now - 4 * want * 1000000ull / adcDma.freq; avail = 4 * want; }
+            if(avail >= want || (avail && now >= deadline)) {
+                uint32_t n = (uint32_t)min<uint64_t>(avail, want);
+                adc_digi_output_data_t* d = (adc_digi_output_data_t*)buf;
+                for(uint32_t i=0; i<n; i++) {
+                    uint8_t ch = adcDma.pattern[adcDma.idx++ % adcDma.patternNum].channel & 7;
+                    int pin = ADC1_PINS[ch];
+                    int v = pinAnalog[pin];
+                    if(uint16_t nz = pinNoise[pin]) v += random(-(long)nz, (long)nz + 1);
+                    d[i].val = 0;
+                    d[i].type1.channel = ch;
+                    d[i].type1.data = constrain(v, 0, 4095);
+                }
+                adcDma.lastUs += (uint64_t)n * 1000000 / adcDma.freq;
+                *out = n * sizeof(adc_digi_output_data_t);
+                return ESP_OK;
+            }
+            if(now >= deadline) return ESP_ERR_TIMEOUT;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+}
+
+esp_adc_cal_value_t esp_adc_cal_characterize(adc_unit_t unit, adc_atten_t atten, adc_bits_width_t width,
+                                             uint32_t defaultVref, esp_adc_cal_characteristics_t* chars) {
+    chars->adc_num = unit; chars->atten = atten; chars->bit_width = width;
+    chars->vref = 1100; chars->coeff_a = 3300; chars->coeff_b = 0;
+    return ESP_ADC_CAL_VAL_EFUSE_VREF;
+}
+uint32_t esp_adc_cal_raw_to_voltage(uint32_t raw, const esp_adc_cal_characteristics_t* chars) {
+    return raw * chars->coeff_a / 4095 + chars->coeff_b;
+}
+
+// Mémoire de l'hôte pour l'instrumentation du simulateur (tâches en fond) :
+// seul le firmware est compté dans le tas DRAM simulé
+template<typename T> struct HostAlloc {
+    typedef T value_type;
+    HostAlloc() = default;
+    template<typename U> HostAlloc(const HostAlloc<U>&) {}
+    T* allocate(size_t n) { if(T* p = (T*)malloc(n * sizeof(T))) return p; throw std::bad_alloc(); }
+    void deallocate(T* p, size_t) { free(p); }
+    template<typename U> bool operator==(const HostAlloc<U>&) const { return true; }
+    template<typename U> bool operator!=(const HostAlloc<U>&) const { return false; }
+};
+typedef std::vector<uint8_t, HostAlloc<uint8_t>> HostBytes;
+
+// --- RMT (émission) : octets redécodés depuis les impulsions du traducteur ---
+static struct RmtChannel {
+    bool installed = false;
+    int gpio = -1;
+    uint8_t clkDiv = 80;
+    sample_to_rmt_t fn = nullptr;
+    uint64_t doneUs = 0;
+} rmtCh[RMT_CHANNEL_MAX];
+static std::mutex rmtLock;
+static HostBytes ledFrames[Sim::PINS];
+static uint32_t ledFrameCount[Sim::PINS];
+
+esp_err_t rmt_config(const rmt_config_t* cfg) {
+    if(!cfg || cfg->channel >= RMT_CHANNEL_MAX || !validPin(cfg->gpio_num) || !cfg->clk_div) return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::mutex> lk(rmtLock);
+    rmtCh[cfg->channel].gpio = cfg->gpio_num;
+    rmtCh[cfg->channel].clkDiv = cfg->clk_div;
+    pinMode_[cfg->gpio_num] = OUTPUT;
+    return ESP_OK;
+}
+esp_err_t rmt_driver_install(rmt_channel_t ch, size_t, int) {
+    std::lock_guard<std::mutex> lk(rmtLock);
+    if(ch >= RMT_CHANNEL_MAX || rmtCh[ch].installed) return ESP_ERR_INVALID_STATE;
+    rmtCh[ch].installed = true;
+    return ESP_OK;
+}
+esp_err_t rmt_driver_uninstall(rmt_channel_t ch) {
+    std::lock_guard<std::mutex> lk(rmtLock);
+    if(ch >= RMT_CHANNEL_MAX || !rmtCh[ch].installed) return ESP_ERR_INVALID_STATE;
+    rmtCh[ch] = RmtChannel();
+    return ESP_OK;
+}
+esp_err_t rmt_get_counter_clock(rmt_channel_t ch, uint32_t* hz) {
+    if(ch >= RMT_CHANNEL_MAX) return ESP_ERR_INVALID_ARG;
+    *hz = 80000000 / rmtCh[ch].clkDiv;
+    return ESP_OK;
+}
+esp_err_t rmt_translator_init(rmt_channel_t ch, sample_to_rmt_t fn) {
+    if(ch >= RMT_CHANNEL_MAX || !fn) return ESP_ERR_INVALID_ARG;
+    rmtCh[ch].fn = fn;
+    return ESP_OK;
+}
+esp_err_t rmt_wait_tx_done(rmt_channel_t ch, TickType_t ticks) {
+    if(ch >= RMT_CHANNEL_MAX || !rmtCh[ch].installed) return ESP_ERR_INVALID_STATE;
+    uint64_t deadline = uptimeUs() + (uint64_t)ticks * 1000;
+    while(uptimeUs() < rmtCh[ch].doneUs) {
+        if(uptimeUs() >= deadline) return ESP_ERR_TIMEOUT;
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    return ESP_OK;
+}
+// Comme le pilote : attend la fin de l'émission précédente, puis rend la main pendant la nouvelle
+esp_err_t rmt_write_sample(rmt_channel_t ch, const uint8_t* src, size_t len, bool wait) {
+    if(ch >= RMT_CHANNEL_MAX || !rmtCh[ch].installed || !rmtCh[ch].fn) return ESP_ERR_INVALID_STATE;
+    rmt_wait_tx_done(ch, portMAX_DELAY);
+    RmtChannel& c = rmtCh[ch];
+    HostBytes bytes;
+    uint64_t ticks = 0;
+    uint8_t cur = 0; int nbits = 0;
+    rmt_item32_t items[64];     // Un bloc mémoire RMT
+    size_t done = 0;
+    while(done < len) {
+        size_t used = 0, n = 0;
+        c.fn(src + done, items, len - done, 64, &used, &n);
+        if(!used && !n) return ESP_FAIL;
+        done += used;
+        for(size_t i=0; i<n; i++) {
+            ticks += items[i].duration0 + items[i].duration1;
+            cur = (cur << 1) | (items[i].level0 && items[i].duration0 > items[i].duration1);
+            if(++nbits == 8) { bytes.push_back(cur); cur = 0; nbits = 0; }
+        }
+    }
+    uint32_t us = (uint32_t)(ticks * c.clkDiv / 80);
+    c.doneUs = uptimeUs() + us;
+    Sim::counters().ledShows++;
+    Sim::counters().ledUs += us;
+    {
+        std::lock_guard<std::mutex> lk(rmtLock);
+        ledFrames[c.gpio] = std::move(bytes);
+        ledFrameCount[c.gpio]++;
+    }
+    if(wait) rmt_wait_tx_done(ch, portMAX_DELAY);
+    return ESP_OK;
+}
+
+// --- Mémoire : tas DRAM d'un ESP32 (320 Ko) simulé ---
+// operator new/delete y sont servis (premier bloc libre suffisant, fusion des
+// voisins à la libération) : ESP.getMaxAllocHeap() voit la fragmentation comme
+// sur la carte. Tas plein : repli sur malloc, compté dans Sim::heapOverflows().
+static const uint32_t HEAP_BUDGET = 320 * 1024, PSRAM_BUDGET = 4 * 1024 * 1024;
+static std::atomic<bool> psramPresent{false};
+static std::atomic<uint32_t> psramUsed{0};
+
+bool psramFound() { return psramPresent; }
+void* ps_malloc(size_t size) {
+    if(!psramPresent || psramUsed + size > PSRAM_BUDGET) return nullptr;
+    psramUsed += size;
+    return malloc(size);
+}
+
+namespace {
+class SimHeap {
+    static const size_t HDR = 16, MIN_BLOCK = 32;
+    struct FreeBlock { size_t size; FreeBlock* next; };     // Taille totale, en-tête compris
+    alignas(16) uint8_t _mem[HEAP_BUDGET] = {};
+    FreeBlock* _head = nullptr;     // Blocs libres triés par adresse
+    bool _init = false;
+    size_t _free = 0, _minFree = HEAP_BUDGET;
+    uint32_t _overflows = 0;
+    std::mutex _m;
+
+public:
+    bool owns(const void* p) const { return p >= _mem && p < _mem + HEAP_BUDGET; }
+
+    void* alloc(size_t n) {
+        size_t need = (n + HDR + 15) & ~(size_t)15;
+        if(need < MIN_BLOCK) need = MIN_BLOCK;
+        std::lock_guard<std::mutex> lk(_m);
+        if(!_init) { _head = (FreeBlock*)_mem; _head->size = HEAP_BUDGET; _head->next = nullptr; _free = HEAP_BUDGET; _init = true; }
+        for(FreeBlock** pp = &_head; *pp; pp = &(*pp)->next) {
+            FreeBlock* b = *pp;
+            if(b->size < need) continue;
+            if(b->size - need >= MIN_BLOCK) {
+                FreeBlock* rest = (FreeBlock*)((uint8_t*)b + need);
+                rest->size = b->size - need; rest->next = b->next;
+                *pp = rest;
+            } else { need = b->size; *pp = b->next; }
+            _free -= need;
+            if(_free < _minFree) _minFree = _free;
+            *(size_t*)b = need;
+            return (uint8_t*)b + HDR;
+        }
+        _overflows++;
+        return nullptr;
+    }
+
+    void release(void* p) {
+        FreeBlock* b = (FreeBlock*)((uint8_t*)p - HDR);
+        std::lock_guard<std::mutex> lk(_m);
+        size_t size = *(size_t*)b;
+        _free += size;
+        FreeBlock* prev = nullptr;
+        FreeBlock* next = _head;
+        while(next && next < b) { prev = next; next = next->next; }
+        b->size = size; b->next = next;
+        if(next && (uint8_t*)b + b->size == (uint8_t*)next) { b->size += next->size; b->next = next->next; }
+        if(prev && (uint8_t*)prev + prev->size == (uint8_t*)b) { prev->size += b->size; prev->next = b->next; }
+        else if(prev) prev->next = b;
+        else _head = b;
+    }
+
+    void stats(uint32_t& freeBytes, uint32_t& minFree, uint32_t& largest) {
+        std::lock_guard<std::mutex> lk(_m);
+        if(!_init) { freeBytes = minFree = largest = HEAP_BUDGET; return; }
+        size_t big = 0;
+        for(FreeBlock* b = _head; b; b = b->next) if(b->size > big) big = b->size;
+        freeBytes = _free; minFree = _minFree;
+        largest = big > HDR ? big - HDR : 0;
+    }
+
+    uint32_t overflows() { std::lock_guard<std::mutex> lk(_m); return _overflows; }
+};
+SimHeap simHeap;
+}
+
+void* operator new(size_t n) {
+    if(void* p = simHeap.alloc(n)) return p;
+    if(void* p = malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept {
+    if(!p) return;
+    if(simHeap.owns(p)) simHeap.release(p);
+    else free(p);
+}
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { operator delete(p); }
+
+uint32_t EspClass::getHeapSize() { return HEAP_BUDGET; }
+uint32_t EspClass::getFreeHeap() { uint32_t f, m, l; simHeap.stats(f, m, l); return f; }
+uint32_t EspClass::getMinFreeHeap() { uint32_t f, m, l; simHeap.stats(f, m, l); return m; }
+uint32_t EspClass::getMaxAllocHeap() { uint32_t f, m, l; simHeap.stats(f, m, l); return l; }
+uint32_t EspClass::getPsramSize() { return psramPresent ? PSRAM_BUDGET : 0; }
+uint32_t EspClass::getFreePsram() { return psramPresent ? PSRAM_BUDGET - psramUsed : 0; }
+void EspClass::restart() { fflush(stdout); std::_Exit(0); }
+
+// ==========================================
+// ÉTAT SIMULÉ
+// ==========================================
+namespace Sim {
+
+static std::atomic<bool> rt{true};
+static std::atomic<uint64_t> busyTotal{0};
+
+bool realtime() { return rt; }
+void setRealtime(bool on) { rt = on; }
+void busy(uint32_t us) {
+    busyTotal += us;
+    if(rt && us) std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+uint64_t busyUs() { return busyTotal; }
+uint32_t heapOverflows() { return simHeap.overflows(); }
+
+void setDigital(int pin, int lvl) {
+    if(!validPin(pin)) return;
+    pinForced[pin] = true;
+    int old = pinLevel[pin].exchange(lvl ? HIGH : LOW);
+    if(old == (lvl ? HIGH : LOW)) return;
+    PinIsr isr;
+    { std::lock_guard<std::mutex> lk(isrLock); isr = pinIsr[pin]; }
+    bool fire = isr.mode == CHANGE || (isr.mode == RISING && lvl) || (isr.mode == FALLING && !lvl);
+    if(!fire) return;
+    // Exécutée dans le thread appelant, comme une ISR préempte la tâche courante
+    if(isr.fn) isr.fn();
+    else if(isr.fnArg) isr.fnArg(isr.arg);
+}
+int level(int pin) { return validPin(pin) ? pinLevel[pin].load() : LOW; }
+int mode(int pin) { return validPin(pin) ? pinMode_[pin].load() : -1; }
+void setAnalog(int pin, uint16_t raw) { if(validPin(pin)) pinAnalog[pin] = min<uint16_t>(raw, 4095); }
+void setAnalogNoise(int pin, uint16_t lsb) { if(validPin(pin)) pinNoise[pin] = lsb; }
+void setPulse(int pin, uint32_t us) { if(validPin(pin)) pinPulse[pin] = us; }
+uint32_t pulse(int pin) { return validPin(pin) ? pinPulse[pin].load() : 0; }
+void setPsram(bool present) { psramPresent = present; }
+
+DHTState& dht(int pin) {
+    static DHTState states[PINS + 1];
+    return states[validPin(pin) ? pin : PINS];
+}
+
+I2CBus& i2c() { static I2CBus bus; return bus; }
+
+OneWireBus& oneWire(int pin) {
+    static OneWireBus buses[PINS + 1];
+    return buses[validPin(pin) ? pin : PINS];
+}
+
+Counters& counters() { static Counters c; return c; }
+
+std::vector<uint8_t> ledFrame(int pin, uint32_t* count) {
+    std::lock_guard<std::mutex> lk(rmtLock);
+    if(!validPin(pin)) return {};
+    if(count) *count = ledFrameCount[pin];
+    return std::vector<uint8_t>(ledFrames[pin].begin(), ledFrames[pin].end());
+}
+
+// ==========================================
+// SCÉNARIO PAR DÉFAUT
+// ==========================================
+// Banc complet : un périphérique de chaque famille, grandeurs qui dérivent
+// lentement, un client WebSocket et une commande relais à mi-parcours.
+// Usage : program [durée_s]   (OMNI_SIM_REALTIME=0 : timings bus non bloquants)
+
+static BME280 bme;
+static INA219 ina;
+static BH1750 bh;
+static LCD1602 lcd;
+static SSD1306 oled;
+static DS18B20 probe(0x00000A1B2C3DULL);
+static uint32_t durationMs = 10000, lastDrift = 0;
+static bool relayDone = false, configDone = false;
+static AsyncWebSocketClient* wsClient = nullptr;
+
+static const char* DEMO_CONFIG =
+    "{\"devices\":["
+    "{\"id\":\"dht_4\",\"driver\":\"DHT22\",\"name\":\"Serre\",\"pin\":4},"
+    "{\"id\":\"ds_5\",\"driver\":\"DS18B20\",\"name\":\"Cuve\",\"pin\":5},"
+    "{\"id\":\"ldr_34\",\"driver\":\"LDR\",\"name\":\"Jour\",\"pin\":34},"
+    "{\"id\":\"relay_26\",\"driver\":\"RELAY\",\"name\":\"Pompe\",\"pin\":26},"
+    "{\"id\":\"bme\",\"driver\":\"BME280\",\"name\":\"Air\",\"pin\":118},"
+    "{\"id\":\"ina\",\"driver\":\"INA219\",\"name\":\"Batterie\",\"pin\":64},"
+    "{\"id\":\"lux\",\"driver\":\"BH1750\",\"name\":\"Lumiere\",\"pin\":35},"
+    "{\"id\":\"lcd\",\"driver\":\"LCD_I2C\",\"name\":\"Ecran\",\"pin\":39},"
+    "{\"id\":\"oled\",\"driver\":\"OLED\",\"name\":\"Oled\",\"pin\":60}"
+    "],\"rules\":[{\"src\":\"bme\",\"prm\":\"temp\",\"op\":\">\",\"val\":24,\"tgt\":\"lcd\",\"act\":0}]}";
+
+__attribute__((weak)) void scenarioBegin(int argc, char** argv) {
+    if(argc > 1) durationMs = (uint32_t)(atof(argv[1]) * 1000);
+    const char* r = getenv("OMNI_SIM_REALTIME");
+    setRealtime(!r || strcmp(r, "0") != 0);
+
+    i2c().attach(0x76, &bme);
+    i2c().attach(0x40, &ina);
+    i2c().attach(0x23, &bh);
+    i2c().attach(0x27, &lcd);
+    i2c().attach(0x3C, &oled);
+    oneWire(5).attach(&probe);
+    dht(4).set(21.5f, 55.0f);
+    probe.set(18.25f);
+    bme.set(22.0f, 48.0f, 1013.25f);
+    ina.set(12.4f, 350.0f);
+    bh.set(320.0f);
+    setAnalog(34, 1800);
+
+    LittleFS.begin(true);
+    if(!LittleFS.exists("/config.json")) {
+        File f = LittleFS.open("/config.json", "w");
+        if(f) { f.print(DEMO_CONFIG); f.close(); }
+    }
+}
+
+__attribute__((weak)) bool scenarioStep(uint32_t nowMs) {
+    if(nowMs - lastDrift >= 100) {
+        lastDrift = nowMs;
+        float t = nowMs / 1000.0f;
+        dht(4).set(21.5f + 2.0f * sinf(t / 7), 55.0f + 5.0f * cosf(t / 11));
+        probe.set(18.25f + 0.5f * sinf(t / 5));
+        bme.set(22.0f + 3.0f * sinf(t / 9), 48.0f, 1013.25f + cosf(t / 13));
+        ina.set(12.4f - t * 0.001f, 350.0f + 40.0f * sinf(t));
+        bh.set(320.0f + 100.0f * sinf(t / 3));
+        setAnalog(34, (uint16_t)(1800 + 600 * sinf(t / 4)));
+    }
+    if(!wsClient && AsyncWebSocket::instance()) wsClient = AsyncWebSocket::instance()->simConnect();
+    if(!relayDone && nowMs >= durationMs / 2 && AsyncWebServer::instance()) {
+        relayDone = true;
+        AsyncWebServer::instance()->simRequest(HTTP_POST, "/api/control", "id=relay_26&cmd=toggle", "application/x-www-form-urlencoded");
+    }
+    // Deux envois de config entrelacés, le second coupé en cours de corps : le premier aboutit
+    if(!configDone && nowMs >= durationMs * 3 / 4 && AsyncWebServer::instance()) {
+        configDone = true;
+        AsyncWebServer* srv = AsyncWebServer::instance();
+        String cfg = DEMO_CONFIG;
+        size_t half = cfg.length() / 2;
+        AsyncWebServerRequest* a = srv->simOpen(HTTP_POST, "/api/config", cfg.length());
+        AsyncWebServerRequest* b = srv->simOpen(HTTP_POST, "/api/config", cfg.length());
+        srv->simBody(a, cfg.substring(0, half));
+        srv->simBody(b, cfg.substring(0, half));
+        srv->simAbort(b);
+        srv->simBody(a, cfg.substring(half));
+        Serial.printf("POST /api/config (envoi concurrent coupé) -> %d\n", srv->simClose(a).code);
+    }
+    return nowMs < durationMs;
+}
+
+__attribute__((weak)) void scenarioEnd() {
+    if(AsyncWebServer::instance()) {
+        AsyncWebServer::SimResponse r = AsyncWebServer::instance()->simRequest(HTTP_GET, "/api/status");
+        Serial.printf("GET /api/status -> %d\n", r.code);
+        Serial.println(r.body);
+    }
+    I2CBus::Stats& s = i2c().stats;
+    Serial.printf("I2C: %u transactions, %u NACK, %llu octets, %llu us occupés\n",
+                  (unsigned)s.transactions, (unsigned)s.nacks, (unsigned long long)s.bytes, (unsigned long long)s.busyUs);
+    Serial.printf("OneWire(5): %u resets, %llu us occupés\n", (unsigned)oneWire(5).stats.resets, (unsigned long long)oneWire(5).stats.busyUs);
+    Serial.printf("DHT: %u lectures, %llu us ; LED: %u show, %llu us\n", (unsigned)counters().dhtReads, (unsigned long long)counters().dhtUs,
+                  (unsigned)counters().ledShows, (unsigned long long)counters().ledUs);
+    if(wsClient) Serial.printf("WS client %u: %u trames, %llu octets\n", (unsigned)wsClient->id(), (unsigned)wsClient->queueLen(), (unsigned long long)wsClient->bytesOut);
+    Serial.printf("LCD: \"%s\" / \"%s\"\n", lcd.line(0).c_str(), lcd.line(1).c_str());
+}
+
+} // namespace Sim
+
+// pio test : main() fourni par chaque test Unity (test/)
+#ifndef PIO_UNIT_TESTING
+int main(int argc, char** argv) {
+    bootTime();
+    Sim::scenarioBegin(argc, argv);
+    setup();
+    // loopTask tourne sans pause sur la carte ; 1 ms ici pour ne pas monopoliser un cœur de l'hôte
+    while(Sim::scenarioStep(millis())) { loop(); delay(1); }
+    Sim::scenarioEnd();
+    // Les tâches (threads détachés) tournent encore : sortie sans destructeurs globaux
+    fflush(stdout);
+    std::_Exit(0);
+}
+#endif
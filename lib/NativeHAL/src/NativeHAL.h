@@ -0,0 +1,151 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// ==========================================
+// MATÉRIEL SIMULÉ (API DE SCÉNARIO)
+// ==========================================
+// État des broches, bus I2C et OneWire partagés par les drivers du build natif.
+// Un scénario (simScenario(), voir NativeHAL.cpp) branche des périphériques
+// émulés (SimPeripherals.h) et fait évoluer leurs grandeurs physiques.
+//
+// Les transactions bus coûtent leur durée physique (horloge I2C, timings
+// OneWire, trames DHT/WS2812) : en mode temps réel l'appelant est bloqué
+// comme sur la carte, sinon seul le compteur de temps occupé avance.
+
+namespace Sim {
+
+static const int PINS = 40;
+
+bool realtime();
+void setRealtime(bool on);
+// Occupe l'appelant `us` microsecondes (temps réel) ; toujours comptabilisé dans busyUs()
+void busy(uint32_t us);
+uint64_t busyUs();
+uint32_t heapOverflows();      // Allocations refusées par le tas DRAM simulé (servies par l'hôte)
+
+// --- GPIO / ADC / PWM ---
+void setDigital(int pin, int level);    // Niveau imposé de l'extérieur (déclenche les interruptions)
+int  level(int pin);                    // Niveau courant (écrit par le firmware ou imposé)
+int  mode(int pin);                     // Dernier pinMode() (-1 = jamais configurée)
+void setAnalog(int pin, uint16_t raw);  // Lecture ADC brute 12 bits
+void setAnalogNoise(int pin, uint16_t lsb);  // Bruit uniforme ±lsb sur les conversions DMA
+void setPulse(int pin, uint32_t us);    // Largeur d'impulsion PWM courante (servo)
+uint32_t pulse(int pin);
+void setPsram(bool present);
+
+// --- DHT11/22 (une sonde par broche) ---
+// Lu directement par le faux DHT.h, ou émis sur la broche : une impulsion
+// basse du firmware (>= 18 ms DHT11, >= 0,8 ms DHT22) suivie d'un relâchement
+// déclenche la trame de 40 bits, front par front, avec les timings réels.
+struct DHTState {
+    std::atomic<bool> present{false};
+    std::atomic<float> temp{NAN}, hum{NAN};
+    std::atomic<uint8_t> model{22};
+    std::atomic<uint32_t> frames{0}, corrupt{0};   // corrupt : trames suivantes émises avec un bit faux
+    void set(float t, float h, uint8_t m = 22) { temp = t; hum = h; model = m; present = true; }
+};
+DHTState& dht(int pin);
+
+// --- I2C ---
+class I2CDevice {
+public:
+    virtual ~I2CDevice() {}
+    virtual void write(const uint8_t* data, size_t len) = 0;   // Une transaction d'écriture (START .. STOP)
+    virtual size_t read(uint8_t* data, size_t len) = 0;        // Une transaction de lecture
+};
+
+class I2CBus {
+    I2CDevice* _dev[128] = {nullptr};
+    std::mutex _m;
+    std::atomic<uint32_t> _clock{100000};
+
+    // START + adresse + octets (9 bits chacun avec ACK) + STOP
+    void charge(size_t bytes) {
+        uint32_t us = (uint32_t)(((1 + bytes) * 9 + 2) * 1000000ull / _clock);
+        stats.busyUs += us;
+        busy(us);
+    }
+
+public:
+    struct Stats { std::atomic<uint32_t> transactions{0}, nacks{0}; std::atomic<uint64_t> bytes{0}, busyUs{0}; } stats;
+
+    void attach(uint8_t addr, I2CDevice* d) { std::lock_guard<std::mutex> lk(_m); _dev[addr & 0x7F] = d; }
+    void detach(uint8_t addr) { std::lock_guard<std::mutex> lk(_m); _dev[addr & 0x7F] = nullptr; }
+    I2CDevice* at(uint8_t addr) { std::lock_guard<std::mutex> lk(_m); return _dev[addr & 0x7F]; }
+    void setClock(uint32_t hz) { if(hz) _clock = hz; }
+    uint32_t clock() const { return _clock; }
+
+    // false = pas d'ACK sur l'adresse
+    bool write(uint8_t addr, const uint8_t* data, size_t len) {
+        std::lock_guard<std::mutex> lk(_m);
+        stats.transactions++;
+        I2CDevice* d = _dev[addr & 0x7F];
+        if(!d) { charge(0); stats.nacks++; return false; }
+        charge(len);
+        stats.bytes += len;
+        d->write(data, len);
+        return true;
+    }
+
+    size_t read(uint8_t addr, uint8_t* data, size_t len) {
+        std::lock_guard<std::mutex> lk(_m);
+        stats.transactions++;
+        I2CDevice* d = _dev[addr & 0x7F];
+        if(!d) { charge(0); stats.nacks++; return 0; }
+        charge(len);
+        stats.bytes += len;
+        return d->read(data, len);
+    }
+};
+I2CBus& i2c();
+
+// --- OneWire (un bus par broche) ---
+class OneWireDevice {
+public:
+    uint8_t rom[8] = {0};
+    virtual ~OneWireDevice() {}
+    virtual void reset() {}                     // Impulsion de reset : abandonne la commande en cours
+    virtual void write(uint8_t b) = 0;          // Octet de fonction/données (device sélectionné)
+    virtual uint8_t read() { return 0xFF; }     // Bus au repos = 1
+    virtual uint8_t readBit() { return 1; }
+};
+
+class OneWireBus {
+    std::vector<OneWireDevice*> _devs;
+    std::recursive_mutex _m;
+public:
+    struct Stats { std::atomic<uint32_t> resets{0}; std::atomic<uint64_t> bytes{0}, busyUs{0}; } stats;
+
+    void attach(OneWireDevice* d) { std::lock_guard<std::recursive_mutex> lk(_m); _devs.push_back(d); }
+    void detach(OneWireDevice* d) {
+        std::lock_guard<std::recursive_mutex> lk(_m);
+        for(size_t i=0; i<_devs.size(); i++) if(_devs[i] == d) { _devs.erase(_devs.begin() + i); break; }
+    }
+    size_t count() { std::lock_guard<std::recursive_mutex> lk(_m); return _devs.size(); }
+    OneWireDevice* at(size_t i) { std::lock_guard<std::recursive_mutex> lk(_m); return i < _devs.size() ? _devs[i] : nullptr; }
+    std::recursive_mutex& lock() { return _m; }
+    void charge(uint32_t us) { stats.busyUs += us; busy(us); }
+};
+OneWireBus& oneWire(int pin);
+
+// --- Compteurs des périphériques sans bus partagé ---
+struct Counters {
+    std::atomic<uint32_t> dhtReads{0}, ledShows{0};
+    std::atomic<uint64_t> dhtUs{0}, ledUs{0};
+};
+Counters& counters();
+
+// --- Rubans LED émis par RMT : dernière trame (octets dans l'ordre du fil) ---
+std::vector<uint8_t> ledFrame(int pin, uint32_t* count = nullptr);
+
+// --- Scénario (définitions faibles dans NativeHAL.cpp, redéfinissables) ---
+void scenarioBegin(int argc, char** argv);  // Avant setup() : périphériques, FS
+bool scenarioStep(uint32_t nowMs);          // Avant chaque loop() ; false = fin
+void scenarioEnd();                         // Rapport final
+
+} // namespace Sim
+
+#include "SimPeripherals.h"
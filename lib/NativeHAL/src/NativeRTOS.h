@@ -0,0 +1,140 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// ==========================================
+// SHIMS FREERTOS (THREADS HÔTE)
+// ==========================================
+// Tâche = std::thread détaché, mutex = std::timed_mutex, notifications = compteur
+// + condition_variable, section critique = spinlock. Tick = 1 ms.
+
+typedef int32_t BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xFFFFFFFFu
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+// --- Mutex & sémaphore binaire (donné par une autre tâche que celle qui le prend) ---
+struct NativeSemaphore {
+    std::timed_mutex m;
+    bool binary = false, given = false;
+    std::mutex bm;
+    std::condition_variable cv;
+};
+typedef NativeSemaphore* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return new NativeSemaphore(); }
+inline SemaphoreHandle_t xSemaphoreCreateBinary() { NativeSemaphore* s = new NativeSemaphore(); s->binary = true; return s; }
+inline void vSemaphoreDelete(SemaphoreHandle_t s) { delete s; }
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks) {
+    if(s->binary) {
+        std::unique_lock<std::mutex> lk(s->bm);
+        if(ticks == portMAX_DELAY) s->cv.wait(lk, [s] { return s->given; });
+        else s->cv.wait_for(lk, std::chrono::milliseconds(ticks), [s] { return s->given; });
+        if(!s->given) return pdFALSE;
+        s->given = false;
+        return pdTRUE;
+    }
+    if(ticks == portMAX_DELAY) { s->m.lock(); return pdTRUE; }
+    return s->m.try_lock_for(std::chrono::milliseconds(ticks)) ? pdTRUE : pdFALSE;
+}
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+    if(s->binary) {
+        { std::lock_guard<std::mutex> lk(s->bm); s->given = true; }
+        s->cv.notify_one();
+        return pdTRUE;
+    }
+    s->m.unlock();
+    return pdTRUE;
+}
+
+// --- Tâches & notifications ---
+struct NativeTask {
+    const char* name = "";
+    std::mutex m;
+    std::condition_variable cv;
+    uint32_t notify = 0;
+};
+typedef NativeTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+namespace NativeRTOS {
+    // Tâche courante ; le thread principal (loopTask) obtient la sienne à la première demande
+    inline NativeTask*& current() {
+        thread_local NativeTask* t = nullptr;
+        if(!t) { t = new NativeTask(); t->name = "loopTask"; }
+        return t;
+    }
+}
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                                          UBaseType_t prio, TaskHandle_t* out, BaseType_t core) {
+    (void)stack; (void)prio; (void)core;
+    NativeTask* t = new NativeTask();
+    t->name = name;
+    if(out) *out = t;
+    std::thread([t, fn, arg] { NativeRTOS::current() = t; fn(arg); }).detach();
+    return pdPASS;
+}
+
+inline BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                              UBaseType_t prio, TaskHandle_t* out) {
+    return xTaskCreatePinnedToCore(fn, name, stack, arg, prio, out, tskNO_AFFINITY);
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return NativeRTOS::current(); }
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+    NativeTask* t = NativeRTOS::current();
+    std::unique_lock<std::mutex> lk(t->m);
+    if(ticks == portMAX_DELAY) t->cv.wait(lk, [t] { return t->notify > 0; });
+    else t->cv.wait_for(lk, std::chrono::milliseconds(ticks), [t] { return t->notify > 0; });
+    uint32_t v = t->notify;
+    if(v) t->notify = clearOnExit ? 0 : v - 1;
+    return v;
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t t) {
+    { std::lock_guard<std::mutex> lk(t->m); t->notify++; }
+    t->cv.notify_one();
+    return pdPASS;
+}
+inline void vTaskNotifyGiveFromISR(TaskHandle_t t, BaseType_t* woken) { xTaskNotifyGive(t); if(woken) *woken = pdFALSE; }
+
+inline void vTaskDelay(TickType_t ticks) { std::this_thread::sleep_for(std::chrono::milliseconds(ticks)); }
+inline TickType_t xTaskGetTickCount() {
+    return (TickType_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+// Période fixe : réveil à *prev + inc (rattrapage sans dérive), *prev avancé d'autant
+inline void vTaskDelayUntil(TickType_t* prev, TickType_t inc) {
+    *prev += inc;
+    int32_t wait = (int32_t)(*prev - xTaskGetTickCount());
+    if(wait > 0) vTaskDelay(wait);
+}
+#define taskYIELD() std::this_thread::yield()
+#define portYIELD_FROM_ISR(...) ((void)0)
+
+// --- Sections critiques ---
+struct portMUX_TYPE { std::atomic<bool> locked{false}; };
+#define portMUX_INITIALIZER_UNLOCKED {}
+
+inline void vPortEnterCritical(portMUX_TYPE* m) { while(m->locked.exchange(true, std::memory_order_acquire)) std::this_thread::yield(); }
+inline void vPortExitCritical(portMUX_TYPE* m) { m->locked.store(false, std::memory_order_release); }
+#define portENTER_CRITICAL(m) vPortEnterCritical(m)
+#define portEXIT_CRITICAL(m) vPortExitCritical(m)
+#define portENTER_CRITICAL_ISR(m) vPortEnterCritical(m)
+#define portEXIT_CRITICAL_ISR(m) vPortExitCritical(m)
+#define taskENTER_CRITICAL(m) vPortEnterCritical(m)
+#define taskEXIT_CRITICAL(m) vPortExitCritical(m)
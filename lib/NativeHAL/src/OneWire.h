@@ -0,0 +1,118 @@
+#pragma once
+#include <Arduino.h>
+#include <algorithm>
+#include "NativeHAL.h"
+
+// OneWire sur le bus simulé de la broche (Sim::oneWire(pin)).
+// Couche ROM (MATCH/SKIP/SEARCH) gérée ici, couche fonction par les devices émulés.
+// Coûts : reset 960 µs, 70 µs par bit. Comme la bibliothèque : pas de tas par instance.
+
+class OneWire {
+    Sim::OneWireBus& _bus;
+    uint32_t _sel = 0;     // Devices sélectionnés (bit = rang sur le bus, 32 au plus)
+    enum RomState : uint8_t { ROM_IDLE, ROM_CMD, ROM_MATCH, ROM_FUNCTION } _state = ROM_IDLE;
+    uint8_t _match[8]; uint8_t _matchLen = 0;
+    size_t _searchNext = 0;
+
+    static uint64_t searchKey(const uint8_t* rom) {
+        // Ordre de l'algorithme de recherche Maxim : bit 0 de l'octet 0 en premier, 0 avant 1
+        uint64_t k = 0;
+        for(int i=0; i<64; i++) if(rom[i / 8] & (1 << (i % 8))) k |= 1ull << (63 - i);
+        return k;
+    }
+
+    std::vector<Sim::OneWireDevice*> sorted() {
+        std::vector<Sim::OneWireDevice*> v;
+        for(size_t i=0; i<_bus.count(); i++) v.push_back(_bus.at(i));
+        std::sort(v.begin(), v.end(), [](Sim::OneWireDevice* a, Sim::OneWireDevice* b) { return searchKey(a->rom) < searchKey(b->rom); });
+        return v;
+    }
+
+    template<typename F> void selected(F f) { for(size_t i=0; i<_bus.count() && i<32; i++) if(_sel >> i & 1) f(_bus.at(i)); }
+
+public:
+    explicit OneWire(uint8_t pin) : _bus(Sim::oneWire(pin)) {}
+
+    uint8_t reset() {
+        std::lock_guard<std::recursive_mutex> lk(_bus.lock());
+        _bus.stats.resets++;
+        _bus.charge(960);
+        _sel = 0; _state = ROM_CMD;
+        for(size_t i=0; i<_bus.count(); i++) _bus.at(i)->reset();
+        return _bus.count() ? 1 : 0;
+    }
+
+    void write(uint8_t v, uint8_t power = 0) {
+        (void)power;
+        std::lock_guard<std::recursive_mutex> lk(_bus.lock());
+        _bus.stats.bytes++;
+        _bus.charge(8 * 70);
+        switch(_state) {
+            case ROM_CMD:
+                if(v == 0xCC) { _sel = ~0u; _state = ROM_FUNCTION; }
+                else if(v == 0x55) { _matchLen = 0; _state = ROM_MATCH; }
+                else _state = ROM_IDLE;
+                break;
+            case ROM_MATCH:
+                _match[_matchLen++] = v;
+                if(_matchLen == 8) {
+                    for(size_t i=0; i<_bus.count() && i<32; i++) if(memcmp(_bus.at(i)->rom, _match, 8) == 0) _sel |= 1u << i;
+                    _state = ROM_FUNCTION;
+                }
+                break;
+            case ROM_FUNCTION:
+                selected([&](Sim::OneWireDevice* d) { d->write(v); });
+                break;
+            default: break;
+        }
+    }
+    void write_bytes(const uint8_t* buf, uint16_t n, bool power = 0) { for(uint16_t i=0; i<n; i++) write(buf[i], power); }
+
+    uint8_t read() {
+        std::lock_guard<std::recursive_mutex> lk(_bus.lock());
+        _bus.stats.bytes++;
+        _bus.charge(8 * 70);
+        uint8_t v = 0xFF;
+        if(_state == ROM_FUNCTION) selected([&](Sim::OneWireDevice* d) { v &= d->read(); });   // ET câblé
+        return v;
+    }
+    void read_bytes(uint8_t* buf, uint16_t n) { for(uint16_t i=0; i<n; i++) buf[i] = read(); }
+
+    uint8_t read_bit() {
+        std::lock_guard<std::recursive_mutex> lk(_bus.lock());
+        _bus.charge(70);
+        uint8_t v = 1;
+        if(_state == ROM_FUNCTION) selected([&](Sim::OneWireDevice* d) { v &= d->readBit(); });
+        return v;
+    }
+    void write_bit(uint8_t v) { (void)v; _bus.charge(70); }
+
+    void select(const uint8_t rom[8]) { write(0x55); write_bytes(rom, 8); }
+    void skip() { write(0xCC); }
+    void depower() {}
+
+    void reset_search() { _searchNext = 0; }
+    void target_search(uint8_t family) { (void)family; _searchNext = 0; }
+
+    // Un passage de recherche = reset + SEARCH ROM + 64 triplets de bits
+    bool search(uint8_t* newAddr, bool searchMode = true) {
+        (void)searchMode;
+        std::lock_guard<std::recursive_mutex> lk(_bus.lock());
+        auto devs = sorted();
+        if(_searchNext >= devs.size()) { _searchNext = 0; return false; }
+        reset();
+        _bus.charge(8 * 70 + 64 * 3 * 70);
+        _state = ROM_IDLE;
+        memcpy(newAddr, devs[_searchNext++]->rom, 8);
+        return true;
+    }
+
+    static uint8_t crc8(const uint8_t* addr, uint8_t len) {
+        uint8_t crc = 0;
+        while(len--) {
+            uint8_t b = *addr++;
+            for(int i=0; i<8; i++) { uint8_t mix = (crc ^ b) & 0x01; crc >>= 1; if(mix) crc ^= 0x8C; b >>= 1; }
+        }
+        return crc;
+    }
+};
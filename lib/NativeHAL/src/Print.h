@@ -0,0 +1,71 @@
+#pragma once
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class Print {
+    size_t printNumber(unsigned long long v, int base, bool neg) {
+        char buf[68]; int i = sizeof(buf) - 1; buf[i] = 0;
+        if(base < 2) base = 10;
+        do { int d = v % base; buf[--i] = d < 10 ? '0' + d : 'A' + d - 10; v /= base; } while(v);
+        if(neg) buf[--i] = '-';
+        return write(buf + i);
+    }
+    size_t printSigned(long long v, int base) {
+        if(base == 10 && v < 0) return printNumber((unsigned long long)(-v), 10, true);
+        return printNumber((unsigned long long)v, base, false);
+    }
+
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buf, size_t size) {
+        size_t n = 0;
+        while(size--) { if(!write(*buf++)) break; n++; }
+        return n;
+    }
+    size_t write(const char* s) { return s ? write((const uint8_t*)s, strlen(s)) : 0; }
+    size_t write(const char* buf, size_t size) { return write((const uint8_t*)buf, size); }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write(s.c_str(), s.length()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char v, int base = DEC) { return printNumber(v, base, false); }
+    size_t print(int v, int base = DEC) { return printSigned(v, base); }
+    size_t print(unsigned int v, int base = DEC) { return printNumber(v, base, false); }
+    size_t print(long v, int base = DEC) { return printSigned(v, base); }
+    size_t print(unsigned long v, int base = DEC) { return printNumber(v, base, false); }
+    size_t print(long long v, int base = DEC) { return printSigned(v, base); }
+    size_t print(unsigned long long v, int base = DEC) { return printNumber(v, base, false); }
+    size_t print(double v, int digits = 2) { char buf[64]; snprintf(buf, sizeof(buf), "%.*f", digits, v); return write(buf); }
+
+    size_t println() { return write("\r\n"); }
+    template<typename T> size_t println(const T& v) { size_t n = print(v); return n + println(); }
+    template<typename T> size_t println(const T& v, int fmt) { size_t n = print(v, fmt); return n + println(); }
+
+    size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        char loc[128];
+        va_list ap; va_start(ap, fmt);
+        va_list cp; va_copy(cp, ap);
+        int len = vsnprintf(loc, sizeof(loc), fmt, cp);
+        va_end(cp);
+        size_t n = 0;
+        if(len < 0) { va_end(ap); return 0; }
+        if((size_t)len < sizeof(loc)) n = write((const uint8_t*)loc, len);
+        else {
+            char* buf = (char*)malloc(len + 1);
+            if(buf) { vsnprintf(buf, len + 1, fmt, ap); n = write((const uint8_t*)buf, len); free(buf); }
+        }
+        va_end(ap);
+        return n;
+    }
+};
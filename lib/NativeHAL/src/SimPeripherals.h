@@ -0,0 +1,370 @@
+#pragma once
+#include "NativeHAL.h"
+
+// ==========================================
+// PÉRIPHÉRIQUES ÉMULÉS (NIVEAU REGISTRE / PROTOCOLE)
+// ==========================================
+// Chaque puce expose la même interface bus que le composant réel : les drivers
+// (et les bibliothèques qu'ils utilisent) lisent/écrivent des registres, jamais
+// des valeurs physiques directement.
+
+namespace Sim {
+
+// --- BME280 (0x76/0x77) : registres Bosch, calibration d'exemple de la datasheet ---
+class BME280 : public I2CDevice {
+    static constexpr uint16_t T1 = 27504; static constexpr int16_t T2 = 26435, T3 = -1000;
+    static constexpr uint16_t P1 = 36477;
+    static constexpr int16_t P2 = -10685, P3 = 3024, P4 = 2855, P5 = 140, P6 = -7, P7 = 15500, P8 = -14600, P9 = 6000;
+    static constexpr uint8_t H1 = 75, H3 = 0; static constexpr int16_t H2 = 362, H4 = 324, H5 = 50; static constexpr int8_t H6 = 30;
+
+    std::mutex _m;
+    uint8_t _reg[256];
+    uint8_t _ptr = 0;
+    float _t = 21.5f, _h = 45.0f, _p = 1013.25f;
+
+    // Compensation entière de la datasheet (section 4.2.3)
+    static int32_t tfine(int32_t adc) {
+        int32_t v1 = ((((adc >> 3) - ((int32_t)T1 << 1))) * ((int32_t)T2)) >> 11;
+        int32_t v2 = (((((adc >> 4) - ((int32_t)T1)) * ((adc >> 4) - ((int32_t)T1))) >> 12) * ((int32_t)T3)) >> 14;
+        return v1 + v2;
+    }
+    static float compP(int32_t adc, int32_t tf) {
+        int64_t v1 = (int64_t)tf - 128000;
+        int64_t v2 = v1 * v1 * (int64_t)P6;
+        v2 = v2 + ((v1 * (int64_t)P5) << 17);
+        v2 = v2 + (((int64_t)P4) << 35);
+        v1 = ((v1 * v1 * (int64_t)P3) >> 8) + ((v1 * (int64_t)P2) << 12);
+        v1 = (((((int64_t)1) << 47) + v1)) * ((int64_t)P1) >> 33;
+        if(v1 == 0) return 0;
+        int64_t p = 1048576 - adc;
+        p = (((p << 31) - v2) * 3125) / v1;
+        v1 = (((int64_t)P9) * (p >> 13) * (p >> 13)) >> 25;
+        v2 = (((int64_t)P8) * p) >> 19;
+        p = ((p + v1 + v2) >> 8) + (((int64_t)P7) << 4);
+        return (float)p / 256.0f;
+    }
+    static float compH(int32_t adc, int32_t tf) {
+        int32_t v = tf - 76800;
+        v = (((((adc << 14) - (((int32_t)H4) << 20) - (((int32_t)H5) * v)) + 16384) >> 15) *
+             (((((((v * ((int32_t)H6)) >> 10) * (((v * ((int32_t)H3)) >> 11) + 32768)) >> 10) + 2097152) * ((int32_t)H2) + 8192) >> 14));
+        v = v - (((((v >> 15) * (v >> 15)) >> 7) * ((int32_t)H1)) >> 4);
+        v = v < 0 ? 0 : v;
+        v = v > 419430400 ? 419430400 : v;
+        return (float)(v >> 12) / 1024.0f;
+    }
+
+    // Mesure brute produisant `target` : recherche dichotomique sur la compensation (monotone)
+    template<typename Fn>
+    static int32_t invert(int32_t lo, int32_t hi, float target, bool increasing, Fn f) {
+        while(lo < hi) {
+            int32_t mid = lo + (hi - lo) / 2;
+            if((f(mid) < target) == increasing) lo = mid + 1; else hi = mid;
+        }
+        return lo;
+    }
+
+    void refresh() {
+        int32_t aT = invert(0, 0xFFFFF, _t * 100.0f, true, [](int32_t a) { return (float)((tfine(a) * 5 + 128) >> 8); });
+        int32_t tf = tfine(aT);
+        int32_t aP = invert(0, 0xFFFFF, _p * 100.0f, false, [tf](int32_t a) { return compP(a, tf); });
+        int32_t aH = invert(0, 0xFFFF, _h, true, [tf](int32_t a) { return compH(a, tf); });
+        _reg[0xF7] = aP >> 12; _reg[0xF8] = (aP >> 4) & 0xFF; _reg[0xF9] = (aP & 0x0F) << 4;
+        _reg[0xFA] = aT >> 12; _reg[0xFB] = (aT >> 4) & 0xFF; _reg[0xFC] = (aT & 0x0F) << 4;
+        _reg[0xFD] = aH >> 8;  _reg[0xFE] = aH & 0xFF;
+    }
+
+    void put16(uint8_t r, uint16_t v) { _reg[r] = v & 0xFF; _reg[r + 1] = v >> 8; }
+
+public:
+    BME280() {
+        memset(_reg, 0, sizeof(_reg));
+        _reg[0xD0] = 0x60;
+        put16(0x88, T1); put16(0x8A, T2); put16(0x8C, T3);
+        put16(0x8E, P1); put16(0x90, P2); put16(0x92, P3); put16(0x94, P4); put16(0x96, P5);
+        put16(0x98, P6); put16(0x9A, P7); put16(0x9C, P8); put16(0x9E, P9);
+        _reg[0xA1] = H1; put16(0xE1, H2); _reg[0xE3] = H3;
+        _reg[0xE4] = H4 >> 4; _reg[0xE5] = (H4 & 0x0F) | ((H5 & 0x0F) << 4); _reg[0xE6] = H5 >> 4;
+        _reg[0xE7] = (uint8_t)H6;
+        refresh();
+    }
+
+    void set(float tempC, float humPct, float presHPa) {
+        std::lock_guard<std::mutex> lk(_m);
+        _t = tempC; _h = humPct; _p = presHPa;
+    }
+
+    void write(const uint8_t* d, size_t n) override {
+        std::lock_guard<std::mutex> lk(_m);
+        if(!n) return;
+        _ptr = d[0];
+        for(size_t i=1; i<n; i++, _ptr++) {
+            if(_ptr == 0xE0) continue;                          // Reset logiciel : rien à réinitialiser ici
+            if(_ptr == 0xF2 || _ptr == 0xF4 || _ptr == 0xF5) _reg[_ptr] = d[i];
+        }
+    }
+
+    size_t read(uint8_t* d, size_t n) override {
+        std::lock_guard<std::mutex> lk(_m);
+        if(_ptr <= 0xFE && _ptr + n > 0xF7) refresh();          // Lecture en rafale = valeurs cohérentes (shadowing)
+        for(size_t i=0; i<n; i++) d[i] = _reg[(uint8_t)(_ptr + i)];
+        _ptr += n;
+        return n;
+    }
+};
+
+// --- INA219 (0x40..0x4F) : registres 16 bits big-endian, shunt 0.1 ohm ---
+class INA219 : public I2CDevice {
+    std::mutex _m;
+    uint16_t _reg[6] = {0x399F, 0, 0, 0, 0, 0};
+    uint8_t _ptr = 0;
+    float _busV = 12.0f, _mA = 250.0f;
+
+    void refresh() {
+        int32_t shunt = lroundf(_mA * 10.0f);                   // LSB 10 µV sur 0.1 ohm = 0.1 mA
+        int32_t bus = lroundf(_busV / 0.004f);                  // LSB 4 mV
+        int32_t current = shunt * _reg[5] / 4096;
+        _reg[1] = (uint16_t)(int16_t)shunt;
+        _reg[2] = (uint16_t)((bus << 3) | 0x02);                // CNVR
+        _reg[4] = _reg[5] ? (uint16_t)(int16_t)current : 0;
+        _reg[3] = _reg[5] ? (uint16_t)(abs(current) * bus / 5000) : 0;
+    }
+
+public:
+    void set(float busVolts, float milliAmps) {
+        std::lock_guard<std::mutex> lk(_m);
+        _busV = busVolts; _mA = milliAmps;
+    }
+
+    void write(const uint8_t* d, size_t n) override {
+        std::lock_guard<std::mutex> lk(_m);
+        if(!n) return;
+        _ptr = d[0] % 6;
+        if(n >= 3 && (_ptr == 0 || _ptr == 5)) _reg[_ptr] = (d[1] << 8) | d[2];
+        if(_ptr == 0 && (_reg[0] & 0x8000)) { _reg[0] = 0x399F; _reg[5] = 0; }   // Bit RST
+    }
+
+    size_t read(uint8_t* d, size_t n) override {
+        std::lock_guard<std::mutex> lk(_m);
+        refresh();
+        for(size_t i=0; i<n; i++) d[i] = (i & 1) ? (_reg[_ptr] & 0xFF) : (_reg[_ptr] >> 8);
+        return n;
+    }
+};
+
+// --- BH1750 (0x23/0x5C) : opcodes d'une octet, lecture 2 octets ---
+class BH1750 : public I2CDevice {
+    std::mutex _m;
+    float _lux = 300.0f;
+    uint8_t _mode = 0;      // 0 = éteint / pas de mesure
+
+public:
+    void set(float lux) { std::lock_guard<std::mutex> lk(_m); _lux = lux; }
+
+    void write(const uint8_t* d, size_t n) override {
+        std::lock_guard<std::mutex> lk(_m);
+        for(size_t i=0; i<n; i++) {
+            uint8_t op = d[i];
+            if(op == 0x00) _mode = 0;
+            else if((op & 0xF0) == 0x10 || (op & 0xF0) == 0x20) _mode = op;
+        }
+    }
+
+    size_t read(uint8_t* d, size_t n) override {
+        std::lock_guard<std::mutex> lk(_m);
+        float scale = ((_mode & 0x03) == 0x01) ? 2.4f : 1.2f;   // Mode H2 : résolution 0.5 lx
+        uint32_t raw = _mode ? (uint32_t)lroundf(fmaxf(0, _lux) * scale) : 0;
+        if(raw > 0xFFFF) raw = 0xFFFF;
+        if((_mode & 0x03) == 0x03) raw &= ~0x3u;                // Mode L : 4 lx
+        if((_mode & 0xF0) == 0x20) _mode = 0;                   // One-time : retour en veille
+        for(size_t i=0; i<n; i++) d[i] = i == 0 ? raw >> 8 : (i == 1 ? raw & 0xFF : 0xFF);
+        return n;
+    }
+};
+
+// --- LCD 1602 sur expandeur PCF8574 (0x27/0x3F) : HD44780 en mode 4 bits ---
+class LCD1602 : public I2CDevice {
+    std::mutex _m;
+    uint8_t _last = 0, _hi = 0, _addr = 0;
+    bool _fourBit = false, _high = true;
+    char _ddram[128];
+
+    void exec(uint8_t b, bool rs) {
+        if(rs) { _ddram[_addr & 0x7F] = b; _addr = (_addr + 1) & 0x7F; chars++; return; }
+        if(b == 0x01) { memset(_ddram, ' ', sizeof(_ddram)); _addr = 0; }
+        else if((b & 0xFE) == 0x02) _addr = 0;
+        else if(b & 0x80) _addr = b & 0x7F;
+    }
+
+    // Front descendant de E : quartet haut D4..D7 = P4..P7, RS = P0
+    void latch(uint8_t nibble, bool rs) {
+        if(!_fourBit) { if(!rs && nibble == 0x2) _fourBit = true; return; }
+        if(_high) { _hi = nibble; _high = false; return; }
+        _high = true;
+        exec((_hi << 4) | nibble, rs);
+    }
+
+public:
+    uint32_t chars = 0;     // Caractères écrits en DDRAM
+
+    LCD1602() { memset(_ddram, ' ', sizeof(_ddram)); }
+
+    void write(const uint8_t* d, size_t n) override {
+        std::lock_guard<std::mutex> lk(_m);
+        for(size_t i=0; i<n; i++) {
+            uint8_t v = d[i];
+            if((_last & 0x04) && !(v & 0x04)) latch(v >> 4, v & 0x01);
+            _last = v;
+        }
+    }
+    size_t read(uint8_t* d, size_t n) override { for(size_t i=0; i<n; i++) d[i] = _last; return n; }
+
+    String line(int row) {
+        std::lock_guard<std::mutex> lk(_m);
+        return String(_ddram + (row ? 0x40 : 0x00), 16);
+    }
+};
+
+// --- SSD1306 128x64 (0x3C/0x3D) : GDDRAM miroir, adressage horizontal/vertical/page ---
+class SSD1306 : public I2CDevice {
+    std::mutex _m;
+    uint8_t _ram[8][128];
+    uint8_t _mode = 2, _colLo = 0, _colHi = 127, _pageLo = 0, _pageHi = 7, _col = 0, _page = 0;
+    uint8_t _cmd[8], _need = 0, _have = 0;
+
+    void apply() {
+        switch(_cmd[0]) {
+            case 0x20: _mode = _cmd[1] & 0x03; break;
+            case 0x21: _colLo = _cmd[1] & 0x7F; _colHi = _cmd[2] & 0x7F; _col = _colLo; break;
+            case 0x22: _pageLo = _cmd[1] & 0x07; _pageHi = _cmd[2] & 0x07; _page = _pageLo; break;
+        }
+    }
+
+    void command(uint8_t b) {
+        if(_need) { _cmd[_have++] = b; if(_have == _need) { apply(); _need = 0; } return; }
+        _cmd[0] = b; _have = 1;
+        switch(b) {
+            case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB: _need = 2; break;
+            case 0x21: case 0x22: case 0xA3: _need = 3; break;
+            case 0x29: case 0x2A: _need = 6; break;
+            case 0x26: case 0x27: _need = 7; break;
+            default:
+                if(b >= 0xB0 && b <= 0xB7) _page = b & 0x07;                    // Mode page
+                else if(b <= 0x0F) _col = (_col & 0xF0) | b;
+                else if(b >= 0x10 && b <= 0x1F) _col = ((b & 0x07) << 4) | (_col & 0x0F);
+        }
+    }
+
+    void data(uint8_t b) {
+        _ram[_page][_col] = b;
+        dataBytes++;
+        if(_mode == 0) {
+            if(++_col > _colHi) { _col = _colLo; if(++_page > _pageHi) _page = _pageLo; }
+        } else if(_mode == 1) {
+            if(++_page > _pageHi) { _page = _pageLo; if(++_col > _colHi) _col = _colLo; }
+        } else _col = (_col + 1) & 0x7F;
+    }
+
+public:
+    uint64_t dataBytes = 0;     // Octets GDDRAM transférés depuis le début
+
+    SSD1306() { memset(_ram, 0, sizeof(_ram)); }
+
+    void write(const uint8_t* d, size_t n) override {
+        std::lock_guard<std::mutex> lk(_m);
+        if(!n) return;
+        bool isData = d[0] & 0x40;      // Octet de contrôle : Co=0, D/C#
+        for(size_t i=1; i<n; i++) isData ? data(d[i]) : command(d[i]);
+    }
+    size_t read(uint8_t* d, size_t n) override { memset(d, 0, n); return n; }
+
+    bool pixel(int x, int y) {
+        std::lock_guard<std::mutex> lk(_m);
+        return (x >= 0 && x < 128 && y >= 0 && y < 64) && (_ram[y / 8][x] & (1 << (y & 7)));
+    }
+    // Même disposition que le buffer Adafruit (page par page)
+    bool equals(const uint8_t* buf) {
+        std::lock_guard<std::mutex> lk(_m);
+        return memcmp(_ram, buf, sizeof(_ram)) == 0;
+    }
+};
+
+// --- DS18B20 (OneWire, famille 0x28) ---
+class DS18B20 : public OneWireDevice {
+    std::mutex _m;
+    float _t = 20.0f;
+    uint8_t _pad[9] = {0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10, 0};  // 85 °C à la mise sous tension
+    uint32_t _convStart = 0;
+    bool _converting = false, _brownout = false;
+    uint8_t _out[9]; uint8_t _outLen = 0, _outPos = 0;
+    uint8_t _writeLeft = 0;     // Octets restants de WRITE SCRATCHPAD
+    uint8_t _lastCmd = 0;
+
+    static uint8_t crc8(const uint8_t* p, size_t n) {
+        uint8_t crc = 0;
+        while(n--) {
+            uint8_t b = *p++;
+            for(int i=0; i<8; i++) { uint8_t mix = (crc ^ b) & 0x01; crc >>= 1; if(mix) crc ^= 0x8C; b >>= 1; }
+        }
+        return crc;
+    }
+    uint8_t bits() const { return 9 + ((_pad[4] >> 5) & 0x03); }
+    uint32_t convUs() const { return 93750u << (bits() - 9); }
+
+    void finishConversion() {
+        if(!_converting || micros() - _convStart < convUs()) return;
+        _converting = false;
+        if(_brownout) {
+            // Réinitialisée pendant la conversion : registres de mise sous tension (configuration en EEPROM gardée)
+            _pad[0] = 0x50; _pad[1] = 0x05; _pad[6] = 0x0C;
+            return;
+        }
+        int16_t raw = (int16_t)lroundf(_t * 16.0f);
+        raw &= ~((1 << (12 - bits())) - 1);
+        _pad[0] = raw & 0xFF; _pad[1] = (raw >> 8) & 0xFF;
+        _pad[6] = 0x10 - (raw & 0x0F);      // Octet réservé : reste du compteur, comme les sondes d'origine
+    }
+
+public:
+    explicit DS18B20(uint64_t serial) {
+        rom[0] = 0x28;
+        for(int i=1; i<7; i++) rom[i] = (serial >> (8 * (i - 1))) & 0xFF;
+        rom[7] = crc8(rom, 7);
+    }
+
+    void set(float tempC) { std::lock_guard<std::mutex> lk(_m); _t = tempC; }
+    // Alimentation défaillante : chaque conversion se termine par une remise à zéro de la sonde
+    void setBrownout(bool on) { std::lock_guard<std::mutex> lk(_m); _brownout = on; }
+    uint8_t resolution() { std::lock_guard<std::mutex> lk(_m); return bits(); }
+
+    void reset() override { std::lock_guard<std::mutex> lk(_m); _outLen = _outPos = 0; _writeLeft = 0; _lastCmd = 0; }
+
+    void write(uint8_t b) override {
+        std::lock_guard<std::mutex> lk(_m);
+        finishConversion();
+        if(_writeLeft) { _pad[5 - _writeLeft] = b; if(--_writeLeft == 0) _pad[4] = (_pad[4] & 0x60) | 0x1F; return; }
+        _lastCmd = b;
+        switch(b) {
+            case 0x44: _converting = true; _convStart = micros(); break;
+            case 0xBE:
+                _pad[8] = crc8(_pad, 8);
+                memcpy(_out, _pad, 9); _outLen = 9; _outPos = 0;
+                break;
+            case 0x4E: _writeLeft = 3; break;
+        }
+    }
+
+    uint8_t read() override {
+        std::lock_guard<std::mutex> lk(_m);
+        return _outPos < _outLen ? _out[_outPos++] : 0xFF;
+    }
+
+    // Après CONVERT T : 0 tant que la conversion est en cours ; après READ POWER SUPPLY : 1 = alimentation externe
+    uint8_t readBit() override {
+        std::lock_guard<std::mutex> lk(_m);
+        finishConversion();
+        if(_lastCmd == 0x44) return _converting ? 0 : 1;
+        return 1;
+    }
+};
+
+} // namespace Sim
@@ -0,0 +1,27 @@
+#pragma once
+#include "Print.h"
+
+class Stream : public Print {
+protected:
+    unsigned long _timeout = 1000;
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long ms) { _timeout = ms; }
+    unsigned long getTimeout() const { return _timeout; }
+
+    virtual size_t readBytes(char* buf, size_t len) {
+        size_t n = 0;
+        while(n < len) { int c = read(); if(c < 0) break; buf[n++] = (char)c; }
+        return n;
+    }
+    size_t readBytes(uint8_t* buf, size_t len) { return readBytes((char*)buf, len); }
+
+    String readString() {
+        String s; int c;
+        while((c = read()) >= 0) s += (char)c;
+        return s;
+    }
+};
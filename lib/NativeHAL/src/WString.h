@@ -0,0 +1,135 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <string>
+
+// ==========================================
+// String (SÉMANTIQUE ARDUINO, STOCKAGE std::string)
+// ==========================================
+
+class String {
+    std::string _s;
+
+    static std::string num(long long v, unsigned base) {
+        if(base == 10) return std::to_string(v);
+        if(v < 0) return "-" + unum((unsigned long long)(-v), base);
+        return unum((unsigned long long)v, base);
+    }
+    static std::string unum(unsigned long long v, unsigned base) {
+        if(base < 2 || base > 36) base = 10;
+        char buf[66]; int i = sizeof(buf) - 1; buf[i] = 0;
+        do { unsigned d = v % base; buf[--i] = d < 10 ? '0' + d : 'a' + d - 10; v /= base; } while(v);
+        return buf + i;
+    }
+    static std::string flt(double v, unsigned decimals) {
+        char buf[64]; snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+        return buf;
+    }
+
+public:
+    String(const char* s = "") : _s(s ? s : "") {}
+    String(const char* s, size_t n) : _s(s ? s : "", s ? n : 0) {}
+    String(const String&) = default;
+    String(String&&) = default;
+    explicit String(char c) : _s(1, c) {}
+    explicit String(unsigned char v, unsigned char base = 10) : _s(unum(v, base)) {}
+    explicit String(int v, unsigned char base = 10) : _s(num(v, base)) {}
+    explicit String(unsigned int v, unsigned char base = 10) : _s(unum(v, base)) {}
+    explicit String(long v, unsigned char base = 10) : _s(num(v, base)) {}
+    explicit String(unsigned long v, unsigned char base = 10) : _s(unum(v, base)) {}
+    explicit String(long long v, unsigned char base = 10) : _s(num(v, base)) {}
+    explicit String(unsigned long long v, unsigned char base = 10) : _s(unum(v, base)) {}
+    explicit String(float v, unsigned int decimals = 2) : _s(flt(v, decimals)) {}
+    explicit String(double v, unsigned int decimals = 2) : _s(flt(v, decimals)) {}
+
+    String& operator=(const String&) = default;
+    String& operator=(String&&) = default;
+    String& operator=(const char* s) { _s = s ? s : ""; return *this; }
+
+    const char* c_str() const { return _s.c_str(); }
+    unsigned int length() const { return _s.size(); }
+    bool isEmpty() const { return _s.empty(); }
+    bool reserve(unsigned int n) { _s.reserve(n); return true; }
+    void clear() { _s.clear(); }
+
+    bool concat(const String& s) { _s += s._s; return true; }
+    bool concat(const char* s) { if(!s) return false; _s += s; return true; }
+    bool concat(const char* s, unsigned int n) { if(!s) return false; _s.append(s, n); return true; }
+    bool concat(char c) { _s += c; return true; }
+    bool concat(unsigned char v) { _s += unum(v, 10); return true; }
+    bool concat(int v) { _s += num(v, 10); return true; }
+    bool concat(unsigned int v) { _s += unum(v, 10); return true; }
+    bool concat(long v) { _s += num(v, 10); return true; }
+    bool concat(unsigned long v) { _s += unum(v, 10); return true; }
+    bool concat(long long v) { _s += num(v, 10); return true; }
+    bool concat(unsigned long long v) { _s += unum(v, 10); return true; }
+    bool concat(float v) { _s += flt(v, 2); return true; }
+    bool concat(double v) { _s += flt(v, 2); return true; }
+
+    template<typename T> String& operator+=(const T& v) { concat(v); return *this; }
+    String& operator+=(const char* s) { concat(s); return *this; }
+
+    char charAt(unsigned int i) const { return i < _s.size() ? _s[i] : 0; }
+    void setCharAt(unsigned int i, char c) { if(i < _s.size()) _s[i] = c; }
+    char operator[](unsigned int i) const { return charAt(i); }
+    char& operator[](unsigned int i) { static char dummy; if(i >= _s.size()) { dummy = 0; return dummy; } return _s[i]; }
+
+    bool equals(const String& o) const { return _s == o._s; }
+    bool equals(const char* o) const { return _s == (o ? o : ""); }
+    bool equalsIgnoreCase(const String& o) const { return strcasecmp(c_str(), o.c_str()) == 0; }
+    int compareTo(const String& o) const { return strcmp(c_str(), o.c_str()); }
+    bool startsWith(const String& p) const { return _s.compare(0, p._s.size(), p._s) == 0; }
+    bool endsWith(const String& p) const { return _s.size() >= p._s.size() && _s.compare(_s.size() - p._s.size(), p._s.size(), p._s) == 0; }
+
+    int indexOf(char c, unsigned int from = 0) const { size_t p = _s.find(c, from); return p == std::string::npos ? -1 : (int)p; }
+    int indexOf(const String& s, unsigned int from = 0) const { size_t p = _s.find(s._s, from); return p == std::string::npos ? -1 : (int)p; }
+    int lastIndexOf(char c) const { size_t p = _s.rfind(c); return p == std::string::npos ? -1 : (int)p; }
+    int lastIndexOf(const String& s) const { size_t p = _s.rfind(s._s); return p == std::string::npos ? -1 : (int)p; }
+
+    String substring(unsigned int left) const { return substring(left, _s.size()); }
+    String substring(unsigned int left, unsigned int right) const {
+        if(left > right) { unsigned int t = left; left = right; right = t; }
+        if(left >= _s.size()) return String();
+        if(right > _s.size()) right = _s.size();
+        return String(_s.c_str() + left, right - left);
+    }
+    void remove(unsigned int index) { if(index < _s.size()) _s.erase(index); }
+    void remove(unsigned int index, unsigned int count) { if(index < _s.size()) _s.erase(index, count); }
+    void replace(char a, char b) { for(auto& c : _s) if(c == a) c = b; }
+    void replace(const String& a, const String& b) {
+        if(a._s.empty()) return;
+        for(size_t p = 0; (p = _s.find(a._s, p)) != std::string::npos; p += b._s.size()) _s.replace(p, a._s.size(), b._s);
+    }
+    void toLowerCase() { for(auto& c : _s) c = tolower((unsigned char)c); }
+    void toUpperCase() { for(auto& c : _s) c = toupper((unsigned char)c); }
+    void trim() {
+        size_t b = _s.find_first_not_of(" \t\r\n"), e = _s.find_last_not_of(" \t\r\n");
+        _s = (b == std::string::npos) ? std::string() : _s.substr(b, e - b + 1);
+    }
+
+    long toInt() const { return atol(c_str()); }
+    float toFloat() const { return (float)atof(c_str()); }
+    double toDouble() const { return atof(c_str()); }
+
+    friend bool operator==(const String& a, const String& b) { return a._s == b._s; }
+    friend bool operator==(const String& a, const char* b) { return a.equals(b); }
+    friend bool operator==(const char* a, const String& b) { return b.equals(a); }
+    friend bool operator!=(const String& a, const String& b) { return !(a == b); }
+    friend bool operator!=(const String& a, const char* b) { return !(a == b); }
+    friend bool operator!=(const char* a, const String& b) { return !(a == b); }
+    friend bool operator<(const String& a, const String& b) { return a._s < b._s; }
+};
+
+// Type intermédiaire des concaténations, comme sur le core Arduino
+class StringSumHelper : public String {
+public:
+    StringSumHelper(const String& s) : String(s) {}
+    StringSumHelper(const char* s) : String(s) {}
+};
+
+template<typename T>
+inline StringSumHelper operator+(const String& lhs, const T& rhs) { StringSumHelper r(lhs); r += rhs; return r; }
+inline StringSumHelper operator+(const char* lhs, const String& rhs) { StringSumHelper r(lhs); r += rhs; return r; }
@@ -0,0 +1,24 @@
+#pragma once
+#include <Arduino.h>
+
+// Réseau simulé : toujours connecté, adresse fixe (le serveur web est piloté en mémoire)
+
+#define WL_CONNECTED 3
+#define WIFI_STA 1
+
+class IPAddress {
+    uint8_t _b[4];
+public:
+    IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : _b{a, b, c, d} {}
+    String toString() const { char s[16]; snprintf(s, sizeof(s), "%u.%u.%u.%u", _b[0], _b[1], _b[2], _b[3]); return s; }
+};
+
+class WiFiClass {
+public:
+    bool mode(int m) { (void)m; return true; }
+    int status() { return WL_CONNECTED; }
+    bool isConnected() { return true; }
+    IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+    int8_t RSSI() { return -50; }
+};
+extern WiFiClass WiFi;
@@ -0,0 +1,10 @@
+#pragma once
+#include <WiFi.h>
+
+class WiFiManager {
+public:
+    void setClass(const char* c) { (void)c; }
+    void setConfigPortalTimeout(unsigned long s) { (void)s; }
+    bool autoConnect(const char* ssid = nullptr, const char* pass = nullptr) { (void)ssid; (void)pass; return true; }
+    void resetSettings() {}
+};
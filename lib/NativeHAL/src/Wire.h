@@ -0,0 +1,62 @@
+#pragma once
+#include <Arduino.h>
+#include "NativeHAL.h"
+
+// TwoWire sur le bus I2C simulé (Sim::i2c()), mêmes codes retour que le core ESP32
+#define I2C_BUFFER_LENGTH 128
+
+class TwoWire : public Stream {
+    uint8_t _tx[I2C_BUFFER_LENGTH], _rx[I2C_BUFFER_LENGTH];
+    size_t _txLen = 0, _rxLen = 0, _rxPos = 0;
+    uint8_t _addr = 0;
+    bool _inTx = false;
+    uint16_t _timeout = 50;
+
+public:
+    using Print::write;
+
+    bool begin() { return true; }
+    bool begin(int sda, int scl, uint32_t freq = 0) { (void)sda; (void)scl; if(freq) setClock(freq); return true; }
+    bool end() { return true; }
+    bool setClock(uint32_t hz) { Sim::i2c().setClock(hz); return true; }
+    uint32_t getClock() { return Sim::i2c().clock(); }
+    void setTimeOut(uint16_t ms) { _timeout = ms; }
+    uint16_t getTimeOut() { return _timeout; }
+
+    void beginTransmission(uint8_t addr) { _addr = addr; _txLen = 0; _inTx = true; }
+    void beginTransmission(int addr) { beginTransmission((uint8_t)addr); }
+
+    // 0 = OK, 1 = trop de données, 2 = NACK adresse
+    uint8_t endTransmission(bool sendStop = true) {
+        (void)sendStop;
+        if(!_inTx) return 4;
+        _inTx = false;
+        return Sim::i2c().write(_addr, _tx, _txLen) ? 0 : 2;
+    }
+
+    size_t requestFrom(int addr, int len, bool sendStop = true) {
+        (void)sendStop;
+        if(len < 0) len = 0;
+        if(len > I2C_BUFFER_LENGTH) len = I2C_BUFFER_LENGTH;
+        _rxPos = 0;
+        _rxLen = Sim::i2c().read((uint8_t)addr, _rx, len);
+        return _rxLen;
+    }
+
+    size_t write(uint8_t c) override {
+        if(!_inTx || _txLen >= sizeof(_tx)) return 0;
+        _tx[_txLen++] = c;
+        return 1;
+    }
+    size_t write(const uint8_t* buf, size_t n) override {
+        size_t k = 0;
+        while(k < n && write(buf[k])) k++;
+        return k;
+    }
+
+    int available() override { return _rxLen - _rxPos; }
+    int read() override { return _rxPos < _rxLen ? _rx[_rxPos++] : -1; }
+    int peek() override { return _rxPos < _rxLen ? _rx[_rxPos] : -1; }
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,27 @@
+#pragma once
+#include <stdint.h>
+#include "esp_err.h"
+
+// esp_timer (ESP-IDF) sur threads hôte : le callback s'exécute dans un thread
+// dédié à l'échéance, comme dans la tâche esp_timer de la carte.
+
+typedef void (*esp_timer_cb_t)(void* arg);
+typedef enum { ESP_TIMER_TASK, ESP_TIMER_ISR } esp_timer_dispatch_t;
+
+typedef struct {
+    esp_timer_cb_t callback;
+    void* arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char* name;
+    bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+struct NativeTimer;
+typedef NativeTimer* esp_timer_handle_t;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out);
+esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeoutUs);
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t t, uint64_t periodUs);
+esp_err_t esp_timer_stop(esp_timer_handle_t t);
+esp_err_t esp_timer_delete(esp_timer_handle_t t);
+int64_t esp_timer_get_time();
@@ -26,4 +26,39 @@
 
 #include <Servo.h>
 
-int ServoBase::channel_next_free = 0;
+uint32_t ServoBase::channels_used = 0;
+portMUX_TYPE ServoBase::channels_lock = portMUX_INITIALIZER_UNLOCKED;
+
+int ServoBase::claimChannel() {
+    int channel = -1;
+    portENTER_CRITICAL(&channels_lock);
+    for (int c = 0; c < LEDC_CHANNELS; c++) {
+        if (!(channels_used & (1u << c))) {
+            channels_used |= 1u << c;
+            channel = c;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&channels_lock);
+    return channel;
+}
+
+bool ServoBase::claimChannel(int channel) {
+    if (channel < 0 || channel >= LEDC_CHANNELS) {
+        return false;
+    }
+    portENTER_CRITICAL(&channels_lock);
+    bool free = !(channels_used & (1u << channel));
+    channels_used |= 1u << channel;
+    portEXIT_CRITICAL(&channels_lock);
+    return free;
+}
+
+void ServoBase::releaseChannel(int channel) {
+    if (channel < 0 || channel >= LEDC_CHANNELS) {
+        return;
+    }
+    portENTER_CRITICAL(&channels_lock);
+    channels_used &= ~(1u << channel);
+    portEXIT_CRITICAL(&channels_lock);
+}
@@ -30,21 +30,33 @@
 
 #include "Arduino.h"
 
+// From esp32-hal-ledc.c
+#ifdef SOC_LEDC_SUPPORT_HS_MODE
+#define LEDC_CHANNELS (SOC_LEDC_CHANNEL_NUM << 1)
+#else
+#define LEDC_CHANNELS (SOC_LEDC_CHANNEL_NUM)
+#endif
+
 class ServoBase {
    protected:
     // The main purpose of ServoBase is to make sure that multiple instances of
-    // ServoTemplate class with different types share channel_next_free.
-    static int channel_next_free;
+    // ServoTemplate class with different types share the LEDC channel pool.
+    // One bit per channel, set while a servo holds it; detach() gives the
+    // channel back, so servos can be created and destroyed indefinitely.
+    static uint32_t channels_used;
+    static portMUX_TYPE channels_lock;
+
+    // Lowest free channel, now reserved, or -1 if all are taken
+    static int claimChannel();
+    // Reserve a given channel; false if out of range or already taken
+    static bool claimChannel(int channel);
+    static void releaseChannel(int channel);
 };
 
+static_assert(LEDC_CHANNELS <= 32, "channels_used has one bit per LEDC channel");
+
 template <class T>
 class ServoTemplate : public ServoBase {
-// From esp32-hal-ledc.c
-#ifdef SOC_LEDC_SUPPORT_HS_MODE
-#define LEDC_CHANNELS (SOC_LEDC_CHANNEL_NUM << 1)
-#else
-#define LEDC_CHANNELS (SOC_LEDC_CHANNEL_NUM)
-#endif
    public:
     static constexpr int DEFAULT_MIN_ANGLE = 0;
     static constexpr int DEFAULT_MAX_ANGLE = 180;
@@ -72,15 +84,18 @@ class ServoTemplate : public ServoBase {
         if (tempPeriodUs <= maxPulseWidthUs) {
             return false;
         }
+        if (this->attached()) {
+            detach();
+        }
         if (channel == CHANNEL_NOT_ATTACHED) {
-            if (channel_next_free == LEDC_CHANNELS) {
+            channel = claimChannel();
+            if (channel == CHANNEL_NOT_ATTACHED) {
                 return false;
             }
-            _channel = channel_next_free;
-            channel_next_free++;
-        } else {
-            _channel = channel;
+        } else if (!claimChannel(channel)) {
+            return false;
         }
+        _channel = channel;
 
         _pin = pin;
         _minAngle = minAngle;
@@ -99,10 +114,9 @@ class ServoTemplate : public ServoBase {
             return false;
         }
 
-        if (_channel == (channel_next_free - 1))
-            channel_next_free--;
-
         ledcDetachPin(_pin);
+        releaseChannel(_channel);
+        _channel = CHANNEL_NOT_ATTACHED;
         _pin = PIN_NOT_ATTACHED;
         return true;
     }
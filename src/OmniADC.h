@@ -0,0 +1,260 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include <driver/adc.h>
+#include <esp_adc_cal.h>
+
+// ==========================================
+// ADC CONTINU (DMA) + FILTRES
+// ==========================================
+// Le contrôleur numérique de l'ADC1 convertit en boucle toutes les broches
+// analogiques configurées à fréquence fixe ; la tâche "adc" dépile les blocs
+// DMA, moyenne `os` conversions par canal (suréchantillonnage), passe le
+// résultat dans le filtre du canal et publie la valeur. Les drivers lisent la
+// dernière valeur publiée sans jamais attendre une conversion.
+// L'ADC2 n'a pas de mode DMA et sert au WiFi : ses broches sont refusées
+// aux drivers analogiques (PINS_ADC).
+
+#ifndef OMNI_ADC_HZ
+#define OMNI_ADC_HZ 20000       // Conversions/s, réparties entre les canaux actifs
+#endif
+#define OMNI_ADC_BLOCK 128      // Conversions par lecture DMA
+#define OMNI_ADC_WIN 16         // Fenêtre maximale des filtres
+#define OMNI_ADC_OS 64          // Suréchantillonnage par défaut
+#define OMNI_ADC_OS_MAX 1024
+
+enum ADCFilterMode : uint8_t { ADC_FILTER_NONE, ADC_FILTER_MA, ADC_FILTER_IIR, ADC_FILTER_MEDIAN };
+
+// Filtre d'un canal sur les valeurs brutes déjà suréchantillonnées
+struct ADCFilter {
+    uint8_t mode = ADC_FILTER_MA, win = 8;
+    uint16_t ring[OMNI_ADC_WIN];
+    uint8_t idx = 0, count = 0;
+    int32_t iir = -1;           // Sortie IIR en 1/16 de LSB (-1 = vide)
+
+    void reset() { idx = count = 0; iir = -1; }
+
+    void configure(uint8_t m, uint8_t w) {
+        mode = m <= ADC_FILTER_MEDIAN ? m : ADC_FILTER_MA;
+        win = constrain(w, 1, OMNI_ADC_WIN);
+        reset();
+    }
+
+    uint16_t push(uint16_t x) {
+        ring[idx] = x;
+        idx = (idx + 1) % win;
+        if(count < win) count++;
+        switch(mode) {
+            case ADC_FILTER_MA: {
+                uint32_t s = 0;
+                for(uint8_t i=0; i<count; i++) s += ring[i];
+                return (s + count / 2) / count;
+            }
+            case ADC_FILTER_IIR:
+                // y += (x - y) / win : constante de temps de `win` échantillons
+                if(iir < 0) iir = (int32_t)x << 4;
+                else iir += (((int32_t)x << 4) - iir) / win;
+                return (iir + 8) >> 4;
+            case ADC_FILTER_MEDIAN: {
+                uint16_t s[OMNI_ADC_WIN];
+                for(uint8_t i=0; i<count; i++) {
+                    uint8_t j = i;
+                    for(; j > 0 && s[j - 1] > ring[i]; j--) s[j] = s[j - 1];
+                    s[j] = ring[i];
+                }
+                return s[count / 2];
+            }
+            default: return x;
+        }
+    }
+};
+
+// Canal ADC1 d'une broche (-1 = hors ADC1)
+inline int8_t adc1Channel(int pin) {
+    static const uint8_t PINS[8] = {36, 37, 38, 39, 32, 33, 34, 35};
+    for(int8_t c=0; c<8; c++) if(PINS[c] == pin) return c;
+    return -1;
+}
+
+class ADCSampler {
+    struct Channel {
+        uint8_t refs = 0;
+        uint16_t os = OMNI_ADC_OS;
+        ADCFilter filter;
+        bool reset = false;                 // Réglages changés : la tâche repart de zéro
+        uint16_t raw = 0, mv = 0;
+        uint32_t stamp = 0, count = 0;      // millis() de la dernière valeur publiée, nombre de valeurs
+    };
+    // Accumulateurs, propres à la tâche
+    struct Acc { uint32_t sum = 0; uint16_t n = 0; };
+
+    Channel _ch[8];
+    portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+    TaskHandle_t _task = nullptr;
+    std::atomic<bool> _reconfig{false};
+    esp_adc_cal_characteristics_t _cal;
+    esp_adc_cal_value_t _calSource = ESP_ADC_CAL_VAL_DEFAULT_VREF;
+
+    static void taskEntry(void* arg) { static_cast<ADCSampler*>(arg)->run(); }
+
+    uint8_t mask() {
+        portENTER_CRITICAL(&_lock);
+        uint8_t m = 0;
+        for(uint8_t c=0; c<8; c++) if(_ch[c].refs) m |= 1 << c;
+        portEXIT_CRITICAL(&_lock);
+        return m;
+    }
+
+    // Arrête le DMA puis le relance sur les canaux de `m` (rien si vide)
+    bool restart(uint8_t m, bool& running) {
+        if(running) { adc_digi_stop(); adc_digi_deinitialize(); running = false; }
+        if(!m) return true;
+        adc_digi_init_config_t init = {};
+        init.max_store_buf_size = OMNI_ADC_BLOCK * sizeof(adc_digi_output_data_t) * 4;
+        init.conv_num_each_intr = OMNI_ADC_BLOCK * sizeof(adc_digi_output_data_t);
+        init.adc1_chan_mask = m;
+        if(adc_digi_initialize(&init) != ESP_OK) return false;
+        adc_digi_pattern_config_t pattern[8];
+        uint8_t n = 0;
+        for(uint8_t c=0; c<8; c++) {
+            if(!(m & (1 << c))) continue;
+            pattern[n].atten = ADC_ATTEN_DB_11;
+            pattern[n].channel = c;
+            pattern[n].unit = 0;
+            pattern[n].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+            n++;
+        }
+        adc_digi_configuration_t cfg = {};
+        cfg.conv_limit_en = 1;
+        cfg.conv_limit_num = 250;
+        cfg.pattern_num = n;
+        cfg.adc_pattern = pattern;
+        cfg.sample_freq_hz = OMNI_ADC_HZ;
+        cfg.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+        cfg.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+        if(adc_digi_controller_configure(&cfg) != ESP_OK || adc_digi_start() != ESP_OK) {
+            adc_digi_deinitialize();
+            return false;
+        }
+        running = true;
+        return true;
+    }
+
+    // Fin d'une fenêtre de suréchantillonnage : filtre et publie
+    void publish(uint8_t c, Acc& a) {
+        uint16_t avg = (a.sum + a.n / 2) / a.n;
+        a.sum = 0; a.n = 0;
+        portENTER_CRITICAL(&_lock);
+        Channel& ch = _ch[c];
+        ch.raw = ch.filter.push(avg);
+        ch.mv = esp_adc_cal_raw_to_voltage(ch.raw, &_cal);
+        ch.stamp = millis();
+        ch.count++;
+        portEXIT_CRITICAL(&_lock);
+    }
+
+    void run() {
+        adc_digi_output_data_t buf[OMNI_ADC_BLOCK];
+        Acc acc[8];
+        bool running = false;
+        for(;;) {
+            if(_reconfig.exchange(false) || !running) {
+                uint8_t m = mask();
+                if(!restart(m, running)) errors++;
+                for(Acc& a : acc) a = Acc();
+                if(!running) { ulTaskNotifyTake(pdTRUE, m ? 1000 : portMAX_DELAY); continue; }
+            }
+            uint32_t got = 0;
+            esp_err_t err = adc_digi_read_bytes((uint8_t*)buf, sizeof(buf), &got, 100);
+            if(err == ESP_ERR_TIMEOUT) continue;
+            if(err != ESP_OK) { errors++; restart(0, running); continue; }
+
+            // Réglages du bloc (os) et remise à zéro demandée par configure()
+            uint16_t os[8];
+            portENTER_CRITICAL(&_lock);
+            for(uint8_t c=0; c<8; c++) {
+                os[c] = _ch[c].refs ? _ch[c].os : 0;
+                if(_ch[c].reset) { _ch[c].reset = false; _ch[c].filter.reset(); acc[c] = Acc(); }
+            }
+            portEXIT_CRITICAL(&_lock);
+
+            for(uint32_t i=0; i<got / sizeof(adc_digi_output_data_t); i++) {
+                uint8_t c = buf[i].type1.channel;
+                if(c >= 8 || !os[c]) continue;
+                Acc& a = acc[c];
+                a.sum += buf[i].type1.data;
+                if(++a.n >= os[c]) publish(c, a);
+            }
+        }
+    }
+
+public:
+    std::atomic<uint32_t> errors{0};    // Échecs de configuration / lecture DMA
+
+    // Broche ADC1 ajoutée au balayage DMA ; false si la broche n'est pas sur l'ADC1
+    bool attach(int pin) {
+        int8_t c = adc1Channel(pin);
+        if(c < 0) return false;
+        if(!_task) {
+            _calSource = esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12, 1100, &_cal);
+            xTaskCreatePinnedToCore(taskEntry, "adc", 3072, this, 1, &_task, 1);
+        }
+        portENTER_CRITICAL(&_lock);
+        bool first = _ch[c].refs++ == 0;
+        if(first) { _ch[c].os = OMNI_ADC_OS; _ch[c].filter.configure(ADC_FILTER_MA, 8); _ch[c].stamp = 0; _ch[c].reset = true; }
+        portEXIT_CRITICAL(&_lock);
+        if(first) { _reconfig = true; xTaskNotifyGive(_task); }
+        return true;
+    }
+
+    void detach(int pin) {
+        int8_t c = adc1Channel(pin);
+        if(c < 0 || !_task) return;
+        portENTER_CRITICAL(&_lock);
+        bool last = _ch[c].refs && --_ch[c].refs == 0;
+        portEXIT_CRITICAL(&_lock);
+        if(last) { _reconfig = true; xTaskNotifyGive(_task); }
+    }
+
+    // Suréchantillonnage (conversions moyennées par valeur) et filtre d'un canal
+    void configure(int pin, uint16_t os, uint8_t mode, uint8_t win) {
+        int8_t c = adc1Channel(pin);
+        if(c < 0) return;
+        portENTER_CRITICAL(&_lock);
+        _ch[c].os = constrain(os, 1, OMNI_ADC_OS_MAX);
+        _ch[c].filter.configure(mode, win);
+        _ch[c].reset = true;
+        portEXIT_CRITICAL(&_lock);
+    }
+
+    // Dernière valeur filtrée (brute 12 bits et mV calibrés) ; false tant qu'aucune n'est publiée
+    bool get(int pin, uint16_t& raw, uint16_t& mv, uint32_t* stamp = nullptr) {
+        int8_t c = adc1Channel(pin);
+        if(c < 0) return false;
+        portENTER_CRITICAL(&_lock);
+        const Channel& ch = _ch[c];
+        bool ok = ch.refs && ch.stamp;
+        raw = ch.raw; mv = ch.mv;
+        if(stamp) *stamp = ch.stamp;
+        portEXIT_CRITICAL(&_lock);
+        return ok;
+    }
+
+    // Valeurs publiées par seconde pour un canal (os et nombre de canaux actifs)
+    uint32_t rate(int pin) {
+        int8_t c = adc1Channel(pin);
+        uint8_t n = __builtin_popcount(mask());
+        if(c < 0 || !n) return 0;
+        portENTER_CRITICAL(&_lock);
+        uint16_t os = _ch[c].os;
+        portEXIT_CRITICAL(&_lock);
+        return OMNI_ADC_HZ / n / os;
+    }
+
+    bool efuseCalibrated() const { return _calSource != ESP_ADC_CAL_VAL_DEFAULT_VREF; }
+};
+
+inline ADCSampler& adcSampler() {
+    static ADCSampler s;
+    return s;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+
+// ==========================================
+// FICHIERS WEB EMBARQUÉS (GZIP + ETAG)
+// ==========================================
+// tools/embed_assets.py compresse data/ au build et génère OmniAssetsData.h :
+// tableaux gzip en flash, ETag = hash du contenu. Chaque fichier est servi
+// tel quel avec Content-Encoding: gzip, sans lecture LittleFS ; un client
+// qui renvoie l'ETag reçoit un 304 sans corps. Sans le header généré (build
+// hors PlatformIO), tout reste servi depuis LittleFS.
+
+struct EmbeddedAsset {
+    const char* path;       // URL ("/index.html")
+    const char* type;
+    const char* etag;       // Entre guillemets (ETag fort)
+    const char* cache;      // Cache-Control
+    const uint8_t* gz;
+    size_t len;
+};
+
+#if __has_include("OmniAssetsData.h")
+#include "OmniAssetsData.h"
+#define OMNI_EMBEDDED_ASSETS 1
+#endif
+
+#ifdef OMNI_EMBEDDED_ASSETS
+inline void sendAsset(AsyncWebServerRequest* req, const EmbeddedAsset& a) {
+    AsyncWebServerResponse* r;
+    const AsyncWebHeader* inm = req->getHeader("If-None-Match");
+    if(inm && inm->value().indexOf(a.etag) >= 0) {
+        r = req->beginResponse(304);
+    } else {
+        r = req->beginResponse_P(200, a.type, a.gz, a.len);
+        r->addHeader("Content-Encoding", "gzip");
+    }
+    r->addHeader("ETag", a.etag);
+    r->addHeader("Cache-Control", a.cache);
+    r->addHeader("Vary", "Accept-Encoding");
+    req->send(r);
+}
+#endif
+
+// A enregistrer avant serveStatic() : les fichiers embarqués passent en premier, "/" = index.html
+inline void serveAssets(AsyncWebServer& server) {
+#ifdef OMNI_EMBEDDED_ASSETS
+    for(const EmbeddedAsset& a : EMBEDDED_ASSETS) {
+        const EmbeddedAsset* p = &a;
+        server.on(a.path, HTTP_GET, [p](AsyncWebServerRequest* req) { sendAsset(req, *p); });
+        if(strcmp(a.path, "/index.html") == 0) server.on("/", HTTP_GET, [p](AsyncWebServerRequest* req) { sendAsset(req, *p); });
+    }
+#else
+    (void)server;
+#endif
+}
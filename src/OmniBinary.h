@@ -0,0 +1,197 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "OmniSampler.h"
+
+// ==========================================
+// PROTOCOLE BINAIRE WEBSOCKET (TLV COMPACT)
+// ==========================================
+// Sous-protocole optionnel sur /ws. Le client l'active en envoyant une trame
+// binaire HELLO juste après la connexion ; sinon il reste en JSON texte.
+// Le serveur répond par son propre HELLO ; le binaire n'est activé que si les
+// versions sont égales, sinon le client reste en JSON.
+// Tous les entiers et flottants sont little-endian.
+//
+//   HELLO    C<->S [0x00][version]
+//   SCHEMA   S->C  [0x01][n] n x ([slot][len][id][len][driver][nch] nch x ([len][key]))
+//   KEYFRAME S->C  [0x02][n] n x ([slot][nch] nch x ([ch][f32]))
+//   DELTA    S->C  [0x03][n] (même format, seuls les canaux modifiés)
+//   CMD      C->S  [0x10][seq u16][slot][op][f32]        op: 0=set, 1=toggle
+//   TEXT     C->S  [0x11][seq u16][slot][len][utf8]
+//   ACK      S->C  [0x12][seq u16][status]               status: 0=OK, 1=slot inconnu, 2=trame invalide
+//
+// Seuls les canaux numériques du snapshot sont transportés ; les champs texte
+// (ex: "display") restent disponibles via JSON et /api/status.
+
+static_assert(OMNI_MAX_DEVICES <= 255, "Le protocole binaire adresse les slots sur un octet");
+
+namespace OmniBin {
+
+enum MsgType : uint8_t { MSG_HELLO = 0x00, MSG_SCHEMA = 0x01, MSG_KEYFRAME = 0x02, MSG_DELTA = 0x03,
+                         MSG_CMD = 0x10, MSG_TEXT = 0x11, MSG_ACK = 0x12 };
+enum CmdOp : uint8_t { OP_SET = 0, OP_TOGGLE = 1 };
+enum AckStatus : uint8_t { ACK_OK = 0, ACK_UNKNOWN_SLOT = 1, ACK_BAD_FRAME = 2 };
+static const uint8_t VERSION = 1;
+
+class Writer {
+    uint8_t* _buf; size_t _cap, _len = 0; bool _ovf = false;
+public:
+    Writer(uint8_t* buf, size_t cap) : _buf(buf), _cap(cap) {}
+    void u8(uint8_t v) { if(_len < _cap) _buf[_len++] = v; else _ovf = true; }
+    void u16(uint16_t v) { u8(v & 0xFF); u8(v >> 8); }
+    void f32(float v) { uint32_t b; memcpy(&b, &v, 4); u16(b & 0xFFFF); u16(b >> 16); }
+    void str(const char* s) { size_t n = min(strlen(s), (size_t)255); u8(n); for(size_t i=0; i<n; i++) u8(s[i]); }
+    void patch(size_t pos, uint8_t v) { if(pos < _len) _buf[pos] = v; }
+    size_t length() const { return _len; }
+    bool ok() const { return !_ovf; }
+};
+
+class Reader {
+    const uint8_t* _p; size_t _len, _pos = 0; bool _err = false;
+public:
+    Reader(const uint8_t* p, size_t len) : _p(p), _len(len) {}
+    uint8_t u8() { if(_pos < _len) return _p[_pos++]; _err = true; return 0; }
+    uint16_t u16() { uint16_t lo = u8(); return lo | (u8() << 8); }
+    float f32() { uint32_t b = u16(); b |= (uint32_t)u16() << 16; float v; memcpy(&v, &b, 4); return v; }
+    void str(char* out, size_t cap) {
+        size_t n = u8();
+        for(size_t i=0; i<n; i++) { char c = u8(); if(i + 1 < cap) out[i] = c; }
+        if(cap) out[min(n, cap - 1)] = 0;
+    }
+    bool ok() const { return !_err; }
+    bool done() const { return _pos >= _len; }
+};
+
+inline size_t encodeHello(uint8_t* buf, size_t cap) {
+    Writer w(buf, cap);
+    w.u8(MSG_HELLO); w.u8(VERSION);
+    return w.ok() ? w.length() : 0;
+}
+
+// HELLO bien formé et de la même version que le serveur
+inline bool acceptHello(const uint8_t* data, size_t len) {
+    Reader r(data, len);
+    uint8_t type = r.u8(), version = r.u8();
+    return r.ok() && r.done() && type == MSG_HELLO && version == VERSION;
+}
+
+struct Command { uint16_t seq; uint8_t slot; bool isText; uint8_t op; float val; char text[64]; };
+
+inline size_t encodeCommand(const Command& c, uint8_t* buf, size_t cap) {
+    Writer w(buf, cap);
+    w.u8(c.isText ? MSG_TEXT : MSG_CMD); w.u16(c.seq); w.u8(c.slot);
+    if(c.isText) w.str(c.text); else { w.u8(c.op); w.f32(c.val); }
+    return w.ok() ? w.length() : 0;
+}
+
+inline bool decodeCommand(const uint8_t* data, size_t len, Command& c) {
+    Reader r(data, len);
+    uint8_t type = r.u8();
+    if(type != MSG_CMD && type != MSG_TEXT) return false;
+    c.isText = (type == MSG_TEXT);
+    c.seq = r.u16(); c.slot = r.u8();
+    if(c.isText) { r.str(c.text, sizeof(c.text)); c.op = OP_SET; c.val = 0; }
+    else { c.op = r.u8(); c.val = r.f32(); c.text[0] = 0; }
+    return r.ok() && r.done();
+}
+
+inline size_t encodeAck(uint16_t seq, uint8_t status, uint8_t* buf, size_t cap) {
+    Writer w(buf, cap);
+    w.u8(MSG_ACK); w.u16(seq); w.u8(status);
+    return w.ok() ? w.length() : 0;
+}
+
+// Ouvre une trame KEYFRAME/DELTA ; renvoie la position du compteur à patcher
+inline size_t beginSamples(Writer& w, MsgType type) { w.u8(type); size_t pos = w.length(); w.u8(0); return pos; }
+
+// Ajoute les canaux `mask` (bit c = canal c) d'un slot
+inline void appendSample(Writer& w, uint8_t slot, const DeviceSample& s, uint8_t mask) {
+    w.u8(slot); w.u8(__builtin_popcount(mask));
+    for(uint8_t c=0; c<s.nch; c++) if(mask & (1 << c)) { w.u8(c); w.f32(s.val[c]); }
+}
+
+inline void encodeSchema(Writer& w, const DeviceSnapshot& snap, uint8_t* nchOut) {
+    w.u8(MSG_SCHEMA);
+    size_t pos = w.length(); w.u8(0);
+    uint8_t n = 0;
+    DeviceSample s;
+    for(size_t i=0; i<snap.count(); i++) {
+        if(!snap.read(i, s)) continue;
+        w.u8(i); w.str(s.id); w.str(s.driver); w.u8(s.nch);
+        for(uint8_t c=0; c<s.nch; c++) w.str(s.key[c]);
+        if(nchOut) nchOut[i] = s.nch;
+        n++;
+    }
+    w.patch(pos, n);
+}
+
+// Décode une trame KEYFRAME/DELTA ; fn(slot, ch, value) par canal
+template<typename Fn>
+bool decodeSamples(const uint8_t* data, size_t len, Fn&& fn) {
+    Reader r(data, len);
+    uint8_t type = r.u8();
+    if(type != MSG_KEYFRAME && type != MSG_DELTA) return false;
+    uint8_t n = r.u8();
+    for(uint8_t k=0; k<n && r.ok(); k++) {
+        uint8_t slot = r.u8(), nch = r.u8();
+        for(uint8_t c=0; c<nch && r.ok(); c++) { uint8_t ch = r.u8(); float v = r.f32(); if(r.ok()) fn(slot, ch, v); }
+    }
+    return r.ok() && r.done();
+}
+
+#ifdef OMNI_BENCH
+// Taille et coût d'une keyframe : chemin serializeJson contre trame binaire
+// (aller-retour encode/décode vérifié par test/test_binary)
+inline void bench(Print& out) {
+    const size_t nDev = 40, iters = 100;
+    DeviceSnapshot* snap = new DeviceSnapshot();
+    DeviceSample s; memset(&s, 0, sizeof(s));
+    for(size_t i=0; i<nDev; i++) {
+        snprintf(s.id, sizeof(s.id), "dev_%u", (unsigned)i);
+        s.nch = 3; s.valid = 0x07; s.stamp = 1;
+        strcpy(s.key[0], "temp"); strcpy(s.key[1], "hum"); strcpy(s.key[2], "pres");
+        s.val[0] = 20.0f + i * 0.37f; s.val[1] = 40.0f + i; s.val[2] = 1013.25f - i;
+        snprintf(s.json, sizeof(s.json), "{\"temp\":%g,\"hum\":%g,\"pres\":%g}", s.val[0], s.val[1], s.val[2]);
+        snap->publish(i, s);
+    }
+    snap->setCount(nDev);
+
+    // Chemin JSON historique
+    size_t jsonLen = 0;
+    uint32_t t0 = micros();
+    for(size_t it=0; it<iters; it++) {
+        DynamicJsonDocument doc(4096);
+        JsonArray arr = doc.createNestedArray("devices");
+        for(size_t i=0; i<nDev; i++) {
+            snap->read(i, s);
+            JsonObject obj = arr.createNestedObject();
+            obj["id"] = s.id;
+            JsonObject val = obj.createNestedObject("val");
+            for(uint8_t c=0; c<s.nch; c++) val[s.key[c]] = s.val[c];
+        }
+        String o; serializeJson(doc, o);
+        jsonLen = o.length();
+    }
+    uint32_t jsonUs = micros() - t0;
+
+    // Chemin binaire
+    uint8_t* buf = new uint8_t[1024];
+    size_t binLen = 0;
+    t0 = micros();
+    for(size_t it=0; it<iters; it++) {
+        Writer w(buf, 1024);
+        size_t pos = beginSamples(w, MSG_KEYFRAME);
+        for(size_t i=0; i<nDev; i++) { snap->read(i, s); appendSample(w, i, s, 0xFF >> (8 - s.nch)); }
+        w.patch(pos, nDev);
+        binLen = w.length();
+    }
+    uint32_t binUs = micros() - t0;
+
+    out.printf("[BENCH] keyframe %u devices: json %u B / %u us, binary %u B / %u us (x%u iters)\n",
+               (unsigned)nDev, (unsigned)jsonLen, jsonUs, (unsigned)binLen, binUs, (unsigned)iters);
+    delete[] buf;
+    delete snap;
+}
+#endif
+
+} // namespace OmniBin
@@ -0,0 +1,295 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <vector>
+#include "OmniDrivers.h"
+#include "OmniSampler.h"
+#include "OmniRules.h"
+#include "OmniRegistry.h"
+
+// ==========================================
+// INGESTION DE CONFIGURATION (PAR CHUNKS)
+// ==========================================
+// Découpe le JSON au fil des chunks reçus, sans jamais le garder en entier :
+// chaque élément de "devices" / "rules" (et l'objet "telemetry") est capturé
+// dans un petit buffer, décodé et validé dès qu'il est complet.
+// La config n'est appliquée qu'une fois le corps entier accepté.
+
+#ifndef OMNI_CONFIG_MAX_BODY
+#define OMNI_CONFIG_MAX_BODY (32 * 1024)
+#endif
+#define OMNI_CONFIG_ITEM_MAX 320
+#define OMNI_OPTS_LEN 160                       // "opts" d'un device, sérialisé (8 ROM DS18B20)
+typedef StaticJsonDocument<384> DeviceOptions;  // "opts" décodé
+
+class ConfigIngest {
+public:
+    struct DeviceEntry {
+        char id[OMNI_ID_LEN]; char name[OMNI_NAME_LEN]; char driver[OMNI_DRIVER_LEN]; int pin;
+        char opts[OMNI_OPTS_LEN];   // Objet "opts" sérialisé ; "" = absent (options actuelles conservées)
+        // false si absent ou invalide
+        bool options(DeviceOptions& doc) const { return opts[0] && !deserializeJson(doc, opts) && doc.is<JsonObject>(); }
+    };
+
+    std::vector<DeviceEntry> devices;
+    std::vector<Rule> rules;
+    String telemetry;           // Objet "telemetry" brut (vide si absent)
+    bool hasRules = false;
+    bool oversize = false;      // Refusé dès l'en-tête (HTTP 413)
+    String error;
+
+    // strict = false (chargement au boot) : les devices invalides sont ignorés au lieu de tout rejeter
+    explicit ConfigIngest(bool strict = true) : _strict(strict) {}
+
+    // `total` = Content-Length ; sert à refuser tôt et à dimensionner le staging
+    bool begin(size_t total) {
+        if(total > OMNI_CONFIG_MAX_BODY) { oversize = true; return fail("Config trop grande (max " + String(OMNI_CONFIG_MAX_BODY) + " octets)"); }
+        devices.reserve(min((size_t)OMNI_MAX_DEVICES, total / 48 + 1));
+        return true;
+    }
+
+    bool feed(const uint8_t* data, size_t len) {
+        if(error.length()) return false;
+        for(size_t k=0; k<len; k++) if(!step((char)data[k])) return false;
+        return true;
+    }
+
+    bool finish() {
+        if(error.length()) return false;
+        if(!_done) return fail("JSON incomplet");
+        return true;
+    }
+
+private:
+    enum Section : uint8_t { SEC_NONE, SEC_DEVICES, SEC_RULES, SEC_TELEMETRY, SEC_SKIP };
+
+    bool _strict;
+    uint8_t _depth = 0;
+    bool _inStr = false, _esc = false, _expectKey = false, _keyMode = false, _done = false;
+    char _key[12] = {0}; uint8_t _keyLen = 0;
+    Section _sec = SEC_NONE;
+    bool _capturing = false; uint8_t _capDepth = 0;
+    char _buf[OMNI_CONFIG_ITEM_MAX]; size_t _len = 0;
+
+    bool fail(const String& msg) { if(!error.length()) error = msg; return false; }
+
+    bool step(char c) {
+        if(_done) return (c == ' ' || c == '\n' || c == '\r' || c == '\t') ? true : fail("Données après le JSON");
+        if(_capturing) {
+            if(_len >= sizeof(_buf) - 1) return fail("Élément trop grand");
+            _buf[_len++] = c;
+        }
+        if(_inStr) {
+            if(_esc) _esc = false;
+            else if(c == '\\') _esc = true;
+            else if(c == '"') { _inStr = false; if(_keyMode) { _key[_keyLen] = 0; _keyMode = false; _expectKey = false; } }
+            else if(_keyMode && _keyLen < sizeof(_key) - 1) _key[_keyLen++] = c;
+            return true;
+        }
+        switch(c) {
+            case '"':
+                _inStr = true;
+                if(_depth == 1 && _expectKey) { _keyMode = true; _keyLen = 0; }
+                break;
+            case '{': case '[':
+                if(_depth == 0) {
+                    if(c != '{') return fail("Objet JSON attendu");
+                    _expectKey = true;
+                } else if(_depth == 1) {
+                    if(strcmp(_key, "devices") == 0) _sec = SEC_DEVICES;
+                    else if(strcmp(_key, "rules") == 0) { _sec = SEC_RULES; hasRules = true; rules.clear(); }
+                    else if(strcmp(_key, "telemetry") == 0) _sec = SEC_TELEMETRY;
+                    else _sec = SEC_SKIP;
+                    if((_sec == SEC_DEVICES || _sec == SEC_RULES) && c != '[') return fail(String(_key) + " doit être un tableau");
+                    if(_sec == SEC_TELEMETRY) { if(c != '{') return fail("telemetry doit être un objet"); capture(c); }
+                } else if(_depth == 2 && c == '{' && (_sec == SEC_DEVICES || _sec == SEC_RULES)) {
+                    capture(c);
+                }
+                if(++_depth > 8) return fail("JSON trop imbriqué");
+                break;
+            case '}': case ']':
+                if(_depth == 0) return fail("JSON invalide");
+                _depth--;
+                if(_capturing && _depth == _capDepth) { _buf[_len] = 0; _capturing = false; if(!emit()) return false; }
+                if(_depth == 1) _sec = SEC_NONE;
+                if(_depth == 0) _done = true;
+                break;
+            case ',':
+                if(_depth == 1) _expectKey = true;
+                break;
+        }
+        return true;
+    }
+
+    void capture(char c) { _capturing = true; _capDepth = _depth; _buf[0] = c; _len = 1; }
+
+    bool emit() {
+        if(_sec == SEC_TELEMETRY) { telemetry = _buf; return true; }
+
+        StaticJsonDocument<512> doc;
+        if(deserializeJson(doc, _buf, _len)) return fail("Élément JSON invalide");
+        JsonObjectConst obj = doc.as<JsonObjectConst>();
+
+        if(_sec == SEC_RULES) {
+            Rule r = {obj["src"] | "", obj["prm"] | "", obj["op"] | "", obj["val"] | 0.0f, obj["tgt"] | "", obj["act"] | 0.0f};
+            r.trig = obj["trig"] | "level";
+            r.hyst = obj["hyst"] | 0.0f;
+            r.minOn = obj["on_ms"] | 0u;
+            r.minOff = obj["off_ms"] | 0u;
+            r.cooldown = obj["cool_ms"] | 0u;
+            r.elseVal = obj["else"] | NAN;
+            rules.push_back(r);
+            return true;
+        }
+
+        DeviceEntry e;
+        strlcpy(e.id, obj["id"] | "", sizeof(e.id));
+        strlcpy(e.name, obj["name"] | "", sizeof(e.name));
+        strlcpy(e.driver, obj["driver"] | "", sizeof(e.driver));
+        e.pin = obj["pin"] | -1;
+        e.opts[0] = 0;
+        // Tronqué s'il est trop long : refusé par checkEntry()
+        if(!obj["opts"].isNull()) serializeJson(obj["opts"], e.opts, sizeof(e.opts));
+        String why = validate(e);
+        if(!why.length()) { devices.push_back(e); return true; }
+        if(!_strict) { Serial.printf("Config: device '%s' ignoré (%s)\n", e.id, why.c_str()); return true; }
+        return fail(why);
+    }
+
+    String validate(const DeviceEntry& e) const {
+        String why = checkEntry(e);
+        if(why.length()) return why;
+        if(devices.size() >= OMNI_MAX_DEVICES) return "Trop de devices (max " + String(OMNI_MAX_DEVICES) + ")";
+        for(auto& o : devices) {
+            why = conflict(e, o.id, o.driver, o.pin);
+            if(why.length()) return why;
+        }
+        return "";
+    }
+
+public:
+    // Contrôles propres à l'entrée (id, driver, broche/adresse) ; "" si valide
+    static String checkEntry(const DeviceEntry& e) {
+        String id = e.id;
+        if(!e.id[0]) return "Device sans id";
+        if(!isKnownDriver(e.driver)) return "Driver inconnu pour " + id + ": " + e.driver;
+        if(isADC2Pin(e.pin, e.driver)) return "Pin ADC2 (occupé par le WiFi) pour " + id + ": " + String(e.pin) + ", utiliser GPIO 32-39";
+        if(!isPinValid(e.pin, e.driver)) return "Pin invalide pour " + id + ": " + String(e.pin);
+        DeviceOptions opts;
+        if(e.opts[0] && !e.options(opts)) return "Options invalides pour " + id;
+        return "";
+    }
+
+    // Conflit avec un autre device (même id, ou même broche / adresse I2C)
+    static String conflict(const DeviceEntry& e, const char* id, const char* driver, int pin) {
+        if(strcmp(id, e.id) == 0) return "Id en double: " + String(e.id);
+        if(pin == e.pin && isI2CDriver(driver) == isI2CDriver(e.driver)) return "Pin/Adresse déjà utilisé: " + String(e.pin);
+        return "";
+    }
+
+    // Un seul device contre la configuration active (sous mutex) : l'entrée remplace le device de même id
+    static String validateLive(const DeviceEntry& e, const DeviceRegistry& reg) {
+        String why = checkEntry(e);
+        if(why.length()) return why;
+        if(reg.find(e.id) < 0 && reg.live() >= OMNI_MAX_DEVICES) return "Trop de devices (max " + String(OMNI_MAX_DEVICES) + ")";
+        for(Device* d : reg) {
+            if(!d || strcmp(d->getId(), e.id) == 0) continue;
+            why = conflict(e, d->getId(), d->getDriver(), d->getPin());
+            if(why.length()) return why;
+        }
+        return "";
+    }
+};
+
+// ==========================================
+// APPLICATION INCRÉMENTALE
+// ==========================================
+// Compare la configuration voulue aux devices actifs, par id : même driver,
+// même broche et mêmes options => device conservé tel quel (objet, état,
+// slot, historique), nom seul changé => renommé sur place. Sinon il est
+// détruit puis recréé dans son slot (avec ses options si "opts" est absent). Toutes les destructions passent avant les créations : une broche
+// ou une interruption libérée peut être reprise par un autre device.
+// A appeler sous mutex ; l'appelant repart ensuite des slots listés.
+
+class DeviceDiff {
+public:
+    typedef ConfigIngest::DeviceEntry Entry;
+
+    uint16_t added = 0, removed = 0, replaced = 0, renamed = 0, kept = 0, failed = 0;
+    std::vector<uint16_t> reset;        // Slots créés, recréés ou libérés : échantillon et historique à vider
+    std::vector<uint16_t> touched;      // Slots renommés : métadonnées à republier
+
+    bool changed() const { return added || removed || replaced || renamed || failed; }
+
+    // Configuration complète : les devices absents de `want` sont retirés
+    void apply(DeviceRegistry& reg, const std::vector<Entry>& want) {
+        bool listed[OMNI_MAX_DEVICES] = {false};
+        std::vector<std::pair<int, Entry>> create;
+        for(const Entry& w : want) {
+            Entry e = w;
+            int slot = reg.find(e.id);
+            if(slot >= 0) listed[slot] = true;
+            if(slot < 0 || !update(reg, slot, e)) create.push_back({slot, e});
+        }
+        for(size_t i=0; i<reg.size(); i++) if(reg[i] && !listed[i]) drop(reg, i);
+        // Slots réservés des devices recréés d'abord, puis les nouveaux dans les trous restants
+        for(auto& c : create) if(c.first >= 0) spawn(reg, c.first, c.second);
+        for(auto& c : create) if(c.first < 0) spawn(reg, -1, c.second);
+    }
+
+    // Un seul device créé ou mis à jour (déjà validé par ConfigIngest::validateLive)
+    void put(DeviceRegistry& reg, Entry e) {
+        int slot = reg.find(e.id);
+        if(slot < 0 || !update(reg, slot, e)) spawn(reg, slot, e);
+    }
+
+    // false si l'id est inconnu
+    bool remove(DeviceRegistry& reg, const char* id) {
+        int slot = reg.find(id);
+        if(slot < 0) return false;
+        drop(reg, slot);
+        return true;
+    }
+
+private:
+    // true si le device est conservé ; sinon il est détruit et son slot réservé
+    bool update(DeviceRegistry& reg, size_t slot, Entry& e) {
+        Device* d = reg[slot];
+        DeviceOptions opts;
+        bool sameDriver = strcmp(d->getDriver(), e.driver) == 0;
+        bool reopt = e.options(opts) && !d->sameOptions(opts.as<JsonObjectConst>());
+        if(!sameDriver || d->getPin() != e.pin || reopt) {
+            // Même driver : le device recréé reprend ses options pour les clés absentes de "opts"
+            DeviceOptions cur;
+            if(sameDriver && d->getOptions(cur.to<JsonObject>())) {
+                if(e.opts[0]) for(JsonPairConst kv : opts.as<JsonObjectConst>()) cur[kv.key()] = kv.value();
+                if(measureJson(cur) < sizeof(e.opts)) serializeJson(cur, e.opts, sizeof(e.opts));
+            }
+            delete reg.remove(slot);
+            reset.push_back(slot);
+            return false;
+        }
+        if(strcmp(d->getName(), e.name) != 0) { d->setName(e.name); renamed++; touched.push_back(slot); }
+        else kept++;
+        return true;
+    }
+
+    void drop(DeviceRegistry& reg, size_t slot) {
+        delete reg.remove(slot);
+        reset.push_back(slot);
+        removed++;
+    }
+
+    // slot < 0 : premier slot libre
+    void spawn(DeviceRegistry& reg, int slot, const Entry& e) {
+        Device* d = DeviceFactory::create(e.driver, e.id, e.name, e.pin);
+        int at = !d ? -1 : slot >= 0 ? (reg.insertAt(slot, d) ? slot : -1) : reg.insert(d);
+        if(at < 0) { delete d; failed++; return; }
+        DeviceOptions opts;
+        e.options(opts);
+        d->setOptions(opts.as<JsonObjectConst>());
+        d->begin();
+        if(slot >= 0) replaced++;
+        else { added++; reset.push_back(at); }
+    }
+};
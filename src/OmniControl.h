@@ -0,0 +1,116 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <vector>
+#include "OmniDrivers.h"
+#include "OmniRegistry.h"
+#include "OmniSampler.h"
+
+// ==========================================
+// COMMANDES GROUPÉES (HTTP + WEBSOCKET)
+// ==========================================
+// Un lot d'opérations appliqué sous une seule prise du mutex : tous les ids
+// sont résolus d'abord, rien n'est écrit si l'un d'eux est inconnu. Les
+// servos d'un même lot démarrent ensemble et arrivent en même temps.
+//
+//   {"seq":7,"ops":[{"id":"relay_23","cmd":"toggle"},{"id":"servo_18","cmd":"set","val":90},
+//                   {"id":"lcd_39","text":"Bonjour"}]}
+//
+// Un tableau nu ou une opération seule ({"id":..,"cmd":..}) sont aussi acceptés.
+// Même format sur POST /api/batch et en trame texte sur /ws, acquittée par
+//   {"ack":7,"ok":true,"applied":3}   ou   {"ack":7,"ok":false,"index":1,"error":"..."}
+
+#ifndef OMNI_BATCH_MAX
+#define OMNI_BATCH_MAX 32
+#endif
+#define OMNI_BATCH_MAX_BODY 4096
+
+struct ControlOp {
+    char id[OMNI_ID_LEN];
+    char cmd[12];
+    float val;
+    bool isText;
+    char text[64];
+};
+
+class ControlBatch {
+public:
+    std::vector<ControlOp> ops;
+    int32_t seq = -1;       // Numéro fourni par le client (-1 = absent)
+    int16_t index = -1;     // Opération en cause si erreur
+    uint16_t applied = 0;
+    String error;
+
+    bool parse(const char* json, size_t len) {
+        if(len > OMNI_BATCH_MAX_BODY) return fail("Lot trop grand (max " + String(OMNI_BATCH_MAX_BODY) + " octets)");
+        DynamicJsonDocument doc(JSON_ARRAY_SIZE(OMNI_BATCH_MAX) + OMNI_BATCH_MAX * JSON_OBJECT_SIZE(4) + JSON_OBJECT_SIZE(2) + len);
+        if(deserializeJson(doc, json, len)) return fail("JSON invalide");
+
+        JsonArrayConst list;
+        if(doc.is<JsonArrayConst>()) list = doc.as<JsonArrayConst>();
+        else {
+            JsonObjectConst root = doc.as<JsonObjectConst>();
+            if(root.isNull()) return fail("JSON invalide");
+            seq = root["seq"] | -1;
+            if(root.containsKey("ops")) list = root["ops"];
+            else return add(root);
+        }
+        if(list.isNull()) return fail("ops doit être un tableau");
+        if(list.size() > OMNI_BATCH_MAX) return fail("Trop d'opérations (max " + String(OMNI_BATCH_MAX) + ")");
+        ops.reserve(list.size());
+        for(JsonObjectConst o : list) if(!add(o)) return false;
+        return true;
+    }
+
+    // Sous mutex. false (rien d'appliqué) si un id est inconnu
+    bool apply(DeviceRegistry& reg, Sampler& sampler) {
+        int16_t slots[OMNI_BATCH_MAX];
+        for(size_t i=0; i<ops.size(); i++) {
+            slots[i] = reg.find(ops[i].id);
+            if(slots[i] < 0) { index = i; return fail("Device inconnu: " + String(ops[i].id)); }
+        }
+        motion().hold();
+        for(size_t i=0; i<ops.size(); i++) {
+            Device* d = reg[slots[i]];
+            if(ops[i].isText) d->timedWriteText(ops[i].text);
+            else d->timedWrite(ops[i].cmd, ops[i].val);
+            sampler.kick(slots[i]);
+            applied++;
+        }
+        motion().release();
+        return true;
+    }
+
+    String ack() const {
+        StaticJsonDocument<192> doc;
+        doc["ack"] = seq;
+        doc["ok"] = !error.length();
+        if(error.length()) { doc["index"] = index; doc["error"] = error; }
+        else doc["applied"] = applied;
+        String out;
+        serializeJson(doc, out);
+        return out;
+    }
+
+private:
+    bool fail(const String& why) { error = why; return false; }
+
+    bool add(JsonObjectConst o) {
+        index = ops.size();
+        if(o.isNull()) return fail("Opération invalide");
+        if(ops.size() >= OMNI_BATCH_MAX) return fail("Trop d'opérations (max " + String(OMNI_BATCH_MAX) + ")");
+        ControlOp op = {};
+        strlcpy(op.id, o["id"] | "", sizeof(op.id));
+        if(!op.id[0]) return fail("id requis");
+        op.isText = o.containsKey("text");
+        if(op.isText) strlcpy(op.text, o["text"] | "", sizeof(op.text));
+        else {
+            strlcpy(op.cmd, o["cmd"] | "", sizeof(op.cmd));
+            if(!op.cmd[0]) return fail("cmd ou text requis");
+            op.val = o["val"] | 0.0f;
+        }
+        ops.push_back(op);
+        index = -1;
+        return true;
+    }
+};
@@ -2,6 +2,8 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <Wire.h>
+#include <esp_timer.h>
+#include <type_traits>
 #include <vector>
 
 // --- LIBRARIES ---
@@ -9,179 +11,677 @@
 #include <Adafruit_NeoPixel.h>
 #include <OneWire.h>
 #include <DallasTemperature.h>
-#include <ESP32Servo.h>
-#include <Adafruit_BME280.h>
 #include <Adafruit_INA219.h>
 #include <BH1750.h>
 #include <LiquidCrystal_I2C.h>
 #include <Adafruit_SSD1306.h>
 
+#include "OmniMetrics.h"
+#include "OmniI2C.h"
+#include "OmniADC.h"
+#include "OmniEvents.h"
+#include "OmniPool.h"
+#include "OmniLeds.h"
+#include "OmniMotion.h"
+
 enum DeviceType { SENSOR_BIN, SENSOR_VAL, ACTUATOR_BIN, ACTUATOR_VAL, DISPLAY_DEV };
 
+// Identifiants à capacité fixe (tronqués si trop longs) : aucun accesseur n'alloue
+#define OMNI_ID_LEN 24
+#define OMNI_NAME_LEN 32
+#define OMNI_DRIVER_LEN 12
+
+// ==========================================
+// CANAUX TYPÉS
+// ==========================================
+// Chaque driver déclare ses canaux numériques (clé, unité) dans un tableau
+// statique ; l'indice dans ce tableau est l'id du canal. sample() remplit un
+// Reading de taille fixe : ni clé recopiée, ni JSON, ni allocation. La sortie
+// JSON historique ({"clé": valeur, ...}) en est dérivée par Device::toJson().
+
+#ifndef OMNI_MAX_CHANNELS
+#define OMNI_MAX_CHANNELS 8     // Masques de canaux sur 8 bits (télémétrie, protocole binaire)
+#endif
+#define OMNI_KEY_LEN 8          // Clé de canal, zéro final compris
+static_assert(OMNI_MAX_CHANNELS <= 8, "Masques de canaux sur un octet");
+
+enum ChannelUnit : uint8_t { UNIT_NONE, UNIT_BOOL, UNIT_COUNT, UNIT_RAW, UNIT_CELSIUS, UNIT_PERCENT, UNIT_HPA,
+                             UNIT_LUX, UNIT_VOLT, UNIT_MA, UNIT_MW, UNIT_HZ, UNIT_DEGREE };
+
+inline const char* unitName(ChannelUnit u) {
+    static const char* NAMES[] = { "", "bool", "count", "raw", "°C", "%", "hPa", "lx", "V", "mA", "mW", "Hz", "°" };
+    return u < sizeof(NAMES) / sizeof(NAMES[0]) ? NAMES[u] : "";
+}
+
+struct Channel { const char* key; ChannelUnit unit; };
+
+struct Reading {
+    float val[OMNI_MAX_CHANNELS];
+    uint8_t valid = 0;          // Bit c : canal c mesuré par ce sample()
+    void set(uint8_t c, float v) { val[c] = v; valid |= 1 << c; }
+};
+
+// Nombre d'entrées d'un tableau de canaux (constexpr)
+template<size_t N> constexpr uint8_t channelCount(const Channel (&)[N]) {
+    static_assert(N <= OMNI_MAX_CHANNELS, "Trop de canaux");
+    return N;
+}
+
 class Device {
 protected:
-    String _id, _name, _driver;
+    char _id[OMNI_ID_LEN], _name[OMNI_NAME_LEN], _driver[OMNI_DRIVER_LEN];
     int _pin;
+    int8_t _metric = -1;    // Entrée de ce driver dans metrics() (résolue au premier appel)
+    // Délai jusqu'à une échéance millis() pour samplePeriod() (>= 1 ms)
+    static uint32_t msUntil(uint32_t deadline) {
+        int32_t d = (int32_t)(deadline - millis());
+        return d > 0 ? (uint32_t)d : 1;
+    }
 public:
-    Device(String id, String name, String driver, int pin) 
-        : _id(id), _name(name), _driver(driver), _pin(pin) {}
+    Device(const char* id, const char* name, const char* driver, int pin) : _pin(pin) {
+        strlcpy(_id, id ? id : "", sizeof(_id));
+        strlcpy(_name, name ? name : "", sizeof(_name));
+        strlcpy(_driver, driver ? driver : "", sizeof(_driver));
+    }
     virtual ~Device() {}
 
-    String getId() { return _id; }
-    String getName() { return _name; }
-    String getDriver() { return _driver; } 
-    int getPin() { return _pin; }
+    // Servis par devicePool() : les reconfigurations ne fragmentent pas le tas
+    static void* operator new(size_t size) { return devicePool().allocOrHeap(size); }
+    static void operator delete(void* p) { devicePool().release(p); }
+
+    const char* getId() const { return _id; }
+    const char* getName() const { return _name; }
+    // Renommage à chaud : le nom n'affecte ni le matériel ni le slot
+    void setName(const char* name) { strlcpy(_name, name ? name : "", sizeof(_name)); }
+    const char* getDriver() const { return _driver; } 
+    int getPin() const { return _pin; }
     
     virtual void begin() = 0;
-    virtual void read(JsonObject& doc) = 0; 
+    // Options propres au driver ("opts" de la config), appliquées avant begin()
+    virtual void setOptions(JsonObjectConst opts) {}
+    // false : pas d'options
+    virtual bool getOptions(JsonObject opts) const { return false; }
+    // Options actives identiques à `opts` (clé absente = défaut) ; sinon le device est recréé
+    virtual bool sameOptions(JsonObjectConst opts) const { return true; }
+    // Canaux numériques, ordre fixe (l'indice est l'id du canal)
+    virtual uint8_t channels(const Channel*& list) const { list = nullptr; return 0; }
+    // Mesure typée ; un canal sans valeur (pas encore mesuré, non configuré) reste hors de r.valid
+    virtual void sample(Reading& r) = 0;
+    // Champs JSON hors canaux : texte lisible, entiers exacts (réécrit la clé du canal)
+    virtual void readExtra(JsonObject& doc) {}
     virtual void write(String cmd, float val) {} 
     virtual void writeText(String text) {} 
     virtual DeviceType getType() = 0;
+    // Période d'échantillonnage souhaitée par la tâche Sampler (ms)
+    virtual uint32_t samplePeriod() { return 1000; }
+    // Événement matériel en attente : le Sampler ramène l'échéance à samplePeriod() à partir de maintenant
+    virtual bool eventPending() { return false; }
+
+    // Adaptateur JSON : forme historique, à partir d'un Reading déjà mesuré
+    void toJson(const Reading& r, JsonObject& doc) {
+        const Channel* ch;
+        uint8_t n = channels(ch);
+        for(uint8_t c=0; c<n; c++) if(r.valid & (1 << c)) doc[ch[c].key] = r.val[c];
+        readExtra(doc);
+    }
+    void read(JsonObject& doc) { Reading r; sample(r); toJson(r, doc); }
+
+    // Appels chronométrés (latence par driver dans /api/metrics) : à utiliser hors des drivers
+    void timedSample(Reading& r) {
+        uint32_t t0 = micros();
+        sample(r);
+        metrics().driverCall(_driver, _metric, false, micros() - t0);
+    }
+    void timedWrite(const String& cmd, float val) {
+        uint32_t t0 = micros();
+        write(cmd, val);
+        metrics().driverCall(_driver, _metric, true, micros() - t0);
+    }
+    void timedWriteText(const String& text) {
+        uint32_t t0 = micros();
+        writeText(text);
+        metrics().driverCall(_driver, _metric, true, micros() - t0);
+    }
 };
 
 // ==========================================
 // 1. DRIVERS GPIO (DIGITAL / ANALOG)
 // ==========================================
 
+// Entrées : fronts capturés sur interruption (OmniEvents.h) et rejoués un par un,
+// chaque niveau restant publié OMNI_EDGE_HOLD ms pour que règles et WebSocket le voient.
 class Driver_Digital : public Device {
     bool _isOutput, _inverted, _state;
+    EdgeInput _edges;
+    uint32_t _at = 0, _shownMs = 0;     // millis() du front affiché / de sa publication
 public:
-    Driver_Digital(String id, String name, String type, int pin, bool out, bool inv) 
+    static constexpr Channel CHANNELS[] = { {"val", UNIT_BOOL}, {"edges", UNIT_COUNT} };   // Sorties : "val" seul
+    Driver_Digital(const char* id, const char* name, const char* type, int pin, bool out, bool inv) 
         : Device(id, name, type, pin), _isOutput(out), _inverted(inv), _state(false) {}
     
     void begin() override { 
         pinMode(_pin, _isOutput ? OUTPUT : INPUT_PULLUP); 
         if(_isOutput) apply(); 
+        else {
+            _edges.begin(_pin, EdgeInput::EDGE_EVENTS, OMNI_DEBOUNCE_MS * 1000);
+            _state = (digitalRead(_pin) == (_inverted ? LOW : HIGH));
+        }
     }
     
+    // Entrées : debounce = anti-rebond en ms
     void write(String cmd, float val) override { 
-        if(!_isOutput) return; 
+        if(!_isOutput) {
+            if(cmd == "debounce") _edges.setDebounce((uint32_t)max(val, 0.0f) * 1000);
+            return;
+        }
         _state = (cmd == "toggle") ? !_state : (val >= 1); 
         apply(); 
     }
     
     void apply() { digitalWrite(_pin, _inverted ? !_state : _state); }
     
-    void read(JsonObject& doc) override {
+    uint8_t channels(const Channel*& list) const override { list = CHANNELS; return _isOutput ? 1 : 2; }
+    void sample(Reading& r) override {
         if(!_isOutput) {
-            bool phy = digitalRead(_pin);
-            _state = (phy == (_inverted ? LOW : HIGH));
+            _edges.settle();
+            EdgeEvent e;
+            if(_edges.pop(e)) {
+                _state = (e.level == (_inverted ? LOW : HIGH));
+                _at = EdgeInput::toMillis(e.us);
+                _shownMs = millis();
+            }
+            r.set(1, _edges.count());
         }
-        doc["val"] = _state ? 1 : 0;
+        r.set(0, _state ? 1 : 0);
+    }
+    // at : millis() du front affiché (horodatage, pas une mesure)
+    void readExtra(JsonObject& doc) override {
         doc["human"] = _state ? "ON" : "OFF";
+        if(!_isOutput) doc["at"] = _at;
     }
     DeviceType getType() override { return _isOutput ? ACTUATOR_BIN : SENSOR_BIN; }
+    uint32_t samplePeriod() override {
+        if(_isOutput) return 1000;
+        if(_edges.pending()) return msUntil(_shownMs + OMNI_EDGE_HOLD);
+        uint32_t settle = _edges.settleIn();
+        return settle ? settle : 1000;
+    }
+    bool eventPending() override { return !_isOutput && _edges.pending(); }
 };
 
+// Compteur d'impulsions (débitmètre, compteur d'énergie) : fronts montants comptés sur interruption.
+// scale = impulsions par unité (ex: 450 /L, 1000 /kWh) → total (unités) et rate (unités/h)
+class Driver_Pulse : public Device {
+    EdgeInput _edges;
+    float _scale = 0;
+    uint32_t _lastCount = 0, _lastMs = 0;
+public:
+    // total et rate seulement avec scale > 0
+    static constexpr Channel CHANNELS[] = { {"count", UNIT_COUNT}, {"hz", UNIT_HZ}, {"total", UNIT_NONE}, {"rate", UNIT_NONE} };
+
+    Driver_Pulse(const char* id, const char* name, int pin) : Device(id, name, "PULSE", pin) {}
+
+    void begin() override {
+        pinMode(_pin, INPUT_PULLUP);
+        _edges.begin(_pin, EdgeInput::EDGE_COUNT, 0);
+        _lastMs = millis();
+    }
+
+    // reset = remise à zéro du compteur, debounce = µs entre deux impulsions, scale = impulsions par unité
+    void write(String cmd, float val) override {
+        if(cmd == "reset") { _edges.resetCount(); _lastCount = 0; }
+        else if(cmd == "debounce") _edges.setDebounce((uint32_t)max(val, 0.0f));
+        else if(cmd == "scale") _scale = max(val, 0.0f);
+    }
+
+    uint8_t channels(const Channel*& list) const override { list = CHANNELS; return channelCount(CHANNELS); }
+    void sample(Reading& r) override {
+        uint32_t n = _edges.count(), now = millis();
+        uint32_t dn = n - _lastCount, dt = now - _lastMs;
+        uint32_t lastUs, periodUs;
+        _edges.lastPulse(lastUs, periodUs);
+        // Fréquence sur la fenêtre si assez d'impulsions, sinon d'après la dernière période
+        // (nulle si plus rien depuis deux périodes)
+        float hz = 0;
+        if(dn >= 4 && dt) hz = dn * 1000.0f / dt;
+        else if(periodUs && micros() - lastUs < 2 * periodUs) hz = 1e6f / periodUs;
+        _lastCount = n; _lastMs = now;
+        r.set(0, n);
+        r.set(1, hz);
+        if(_scale > 0) {
+            r.set(2, n / _scale);
+            r.set(3, hz * 3600 / _scale);
+        }
+    }
+    // Compteur exact au-delà de 2^24 impulsions
+    void readExtra(JsonObject& doc) override { doc["count"] = _lastCount; }
+    DeviceType getType() override { return SENSOR_VAL; }
+};
+
+// Broches ADC1 (PINS_ADC) : dernière valeur du balayage DMA (OmniADC.h), jamais d'attente de conversion.
 class Driver_Analog : public Device {
+    bool _dma = false;
+    uint16_t _os = OMNI_ADC_OS;
+    uint8_t _mode = ADC_FILTER_MA, _win = 8;    // Réglages seulement : le filtrage tourne dans adcSampler()
 public:
-    Driver_Analog(String id, String name, String type, int pin) : Device(id, name, type, pin) {}
-    void begin() override { pinMode(_pin, INPUT); }
-    void read(JsonObject& doc) override {
-        int raw = analogRead(_pin);
-        doc["val"] = raw;
-        doc["volts"] = (raw * 3.3) / 4095.0;
+    static constexpr Channel CHANNELS[] = { {"val", UNIT_RAW}, {"volts", UNIT_VOLT} };
+
+    Driver_Analog(const char* id, const char* name, const char* type, int pin) : Device(id, name, type, pin) {}
+    ~Driver_Analog() { if(_dma) adcSampler().detach(_pin); }
+
+    void begin() override { _dma = adcSampler().attach(_pin); }
+
+    // os = conversions moyennées par valeur, filter = 0 aucun / 1 moyenne glissante / 2 IIR / 3 médiane, win = fenêtre
+    void write(String cmd, float val) override {
+        if(cmd == "os") _os = constrain((int)val, 1, OMNI_ADC_OS_MAX);
+        else if(cmd == "filter") _mode = (uint8_t)val <= ADC_FILTER_MEDIAN ? (uint8_t)val : ADC_FILTER_MA;
+        else if(cmd == "win") _win = constrain((int)val, 1, OMNI_ADC_WIN);
+        else return;
+        if(_dma) adcSampler().configure(_pin, _os, _mode, _win);
+    }
+
+    uint8_t channels(const Channel*& list) const override { list = CHANNELS; return channelCount(CHANNELS); }
+    void sample(Reading& r) override {
+        uint16_t raw, mv;
+        if(!_dma || !adcSampler().get(_pin, raw, mv)) return;
+        r.set(0, raw);
+        r.set(1, mv / 1000.0f);
     }
     DeviceType getType() override { return SENSOR_VAL; }
+    uint32_t samplePeriod() override { return 200; }
 };
 
 // ==========================================
 // 2. DRIVERS CAPTEURS COMPLEXES (NON-BLOQUANTS)
 // ==========================================
 
-class Driver_DHT : public Device {
-    DHT* dht;
+// Bibliothèque Adafruit : trame bit-bangée (~5 ms) interruptions coupées.
+// Conservée derrière OMNI_DHT_ADAFRUIT pour comparaison.
+class Driver_DHTAdafruit : public Device {
+    DHT dht;
     float lastT = 0, lastH = 0;
     unsigned long lastRead = 0;
 public:
-    Driver_DHT(String id, String name, int pin, int type) 
-        : Device(id, name, type==DHT11?"DHT11":"DHT22", pin) { dht = new DHT(pin, type); }
-    ~Driver_DHT() { delete dht; }
+    static constexpr Channel CHANNELS[] = { {"temp", UNIT_CELSIUS}, {"hum", UNIT_PERCENT} };
+
+    Driver_DHTAdafruit(const char* id, const char* name, int pin, int type) 
+        : Device(id, name, type==DHT11?"DHT11":"DHT22", pin), dht(pin, type) {}
     
-    void begin() override { dht->begin(); }
+    void begin() override { dht.begin(); }
     
-    void read(JsonObject& doc) override {
+    uint8_t channels(const Channel*& list) const override { list = CHANNELS; return channelCount(CHANNELS); }
+    void sample(Reading& r) override {
         // NON-BLOCKING LOGIC: Read only every 2 seconds
         if(millis() - lastRead > 2000) {
-            float t = dht->readTemperature();
-            float h = dht->readHumidity();
+            float t = dht.readTemperature();
+            float h = dht.readHumidity();
             if(!isnan(t) && !isnan(h)) {
                 lastT = t; lastH = h;
                 lastRead = millis();
             }
         }
-        doc["temp"] = lastT; 
-        doc["hum"] = lastH;
+        r.set(0, lastT);
+        r.set(1, lastH);
     }
     DeviceType getType() override { return SENSOR_VAL; }
+    uint32_t samplePeriod() override { return 2000; }
 };
 
-class Driver_Dallas : public Device {
-    OneWire* oneWire; DallasTemperature* sensors;
-    float lastT = -127;
-    unsigned long lastRead = 0;
+// Capture par interruptions de front : read() tire la ligne à 0, un esp_timer
+// la relâche après l'impulsion de start et arme l'ISR, qui horodate chaque
+// front. L'appel suivant décode la trame (bits = largeur des paliers hauts).
+// Aucune fenêtre interruptions coupées, aucune attente dans la tâche appelante ;
+// une trame donne les deux canaux, la dernière valeur valide est conservée.
+#define OMNI_DHT_PERIOD 2000
+#define OMNI_DHT_MAX_EDGES 96
+
+class Driver_DHTCapture : public Device {
+    esp_timer_handle_t _timer = nullptr;
+    uint8_t _model;
+    volatile uint32_t _edgeUs[OMNI_DHT_MAX_EDGES];
+    volatile uint8_t _edgeLvl[OMNI_DHT_MAX_EDGES];
+    volatile uint8_t _nEdges = 0;
+    bool _capturing = false, _valid = false;
+    uint32_t _startMs = 0, _nextStart = 0;
+    float _t = NAN, _h = NAN;
+
+    // Impulsion de start : >= 18 ms (DHT11), ~1 ms (DHT22)
+    uint32_t startUs() const { return _model == DHT11 ? 20000 : 1100; }
+    // Start + réponse 160 µs + 40 bits de 76..120 µs : trame complète bien avant
+    uint32_t collectAt() const { return _startMs + startUs() / 1000 + 8; }
+
+    static void IRAM_ATTR onEdge(void* arg) {
+        Driver_DHTCapture* self = (Driver_DHTCapture*)arg;
+        uint8_t n = self->_nEdges;
+        if(n >= OMNI_DHT_MAX_EDGES) return;
+        self->_edgeUs[n] = micros();
+        self->_edgeLvl[n] = digitalRead(self->_pin);
+        self->_nEdges = n + 1;
+    }
+
+    // Tâche esp_timer : fin de l'impulsion de start
+    static void onRelease(void* arg) {
+        Driver_DHTCapture* self = (Driver_DHTCapture*)arg;
+        pinMode(self->_pin, INPUT_PULLUP);
+        attachInterruptArg(self->_pin, onEdge, self, CHANGE);
+    }
+
+    // Les 40 derniers paliers hauts complets : ignore la réponse et un éventuel
+    // front manqué au début. Palier > 48 µs = 1.
+    bool decode() {
+        uint8_t w[OMNI_DHT_MAX_EDGES / 2], nw = 0, n = _nEdges;
+        for(uint8_t i=0; i+1<n; i++) {
+            if(_edgeLvl[i] != HIGH || _edgeLvl[i+1] != LOW) continue;
+            w[nw++] = (uint8_t)min<uint32_t>(_edgeUs[i+1] - _edgeUs[i], 255);
+        }
+        if(nw < 40) return false;
+        uint8_t b[5] = {0};
+        for(uint8_t i=0; i<40; i++) b[i / 8] = (b[i / 8] << 1) | (w[nw - 40 + i] > 48);
+        if((uint8_t)(b[0] + b[1] + b[2] + b[3]) != b[4]) return false;
+
+        if(_model == DHT11) {
+            _h = b[0] + b[1] * 0.1f;
+            _t = b[2] + (b[3] & 0x0F) * 0.1f;
+            if(b[3] & 0x80) _t = -_t;
+        } else {
+            _h = ((b[0] << 8) | b[1]) * 0.1f;
+            _t = (((b[2] & 0x7F) << 8) | b[3]) * 0.1f;
+            if(b[2] & 0x80) _t = -_t;
+        }
+        return true;
+    }
+
 public:
-    Driver_Dallas(String id, String name, int pin) : Device(id, name, "DS18B20", pin) { 
-        oneWire = new OneWire(pin); 
-        sensors = new DallasTemperature(oneWire); 
+    static constexpr Channel CHANNELS[] = { {"temp", UNIT_CELSIUS}, {"hum", UNIT_PERCENT} };
+
+    Driver_DHTCapture(const char* id, const char* name, int pin, int type)
+        : Device(id, name, type==DHT11?"DHT11":"DHT22", pin), _model(type == DHT11 ? DHT11 : DHT22) {}
+    ~Driver_DHTCapture() {
+        if(_timer) { esp_timer_stop(_timer); esp_timer_delete(_timer); }
+        detachInterrupt(_pin);
+    }
+
+    void begin() override {
+        esp_timer_create_args_t args = {};
+        args.callback = onRelease;
+        args.arg = this;
+        args.name = "dht";
+        esp_timer_create(&args, &_timer);
+        pinMode(_pin, INPUT_PULLUP);
+        _nextStart = millis() + 1000;   // Capteur stable ~1 s après mise sous tension
+    }
+
+    uint8_t channels(const Channel*& list) const override { list = CHANNELS; return channelCount(CHANNELS); }
+    void sample(Reading& r) override {
+        uint32_t now = millis();
+        if(_capturing && (int32_t)(now - collectAt()) >= 0) {
+            detachInterrupt(_pin);
+            _capturing = false;
+            if(decode()) _valid = true;
+        }
+        if(!_capturing && _timer && (int32_t)(now - _nextStart) >= 0) {
+            _nEdges = 0;
+            pinMode(_pin, OUTPUT);
+            digitalWrite(_pin, LOW);
+            esp_timer_start_once(_timer, startUs());
+            _capturing = true;
+            _startMs = now;
+            _nextStart = now + OMNI_DHT_PERIOD;
+        }
+        // Rien avant la première trame valide (pas de 0/0 transitoire)
+        if(!_valid) return;
+        r.set(0, _t);
+        r.set(1, _h);
+    }
+
+    DeviceType getType() override { return SENSOR_VAL; }
+    uint32_t samplePeriod() override { return msUntil(_capturing ? collectAt() : _nextStart); }
+};
+
+#ifdef OMNI_DHT_ADAFRUIT
+using Driver_DHT = Driver_DHTAdafruit;
+#else
+using Driver_DHT = Driver_DHTCapture;
+#endif
+
+// Toutes les sondes du bus, sans bloquer : un seul CONVERT T diffusé (skip ROM)
+// pour le bus entier, scratchpads relus une fois le délai de la résolution
+// écoulé. samplePeriod() ramène le Sampler pile à la fin de la conversion.
+// Canaux liés à la ROM des sondes, pas à l'ordre de recherche : la 1re ROM vue
+// donne "temp", les suivantes "temp1" .. "temp7". La table survit aux rescans
+// (sonde absente = canal invalide, les autres ne bougent pas) et est
+// sauvegardée dans l'option "roms".
+#ifndef OMNI_DS18B20_RES
+#define OMNI_DS18B20_RES 12     // 9..12 bits : 94 .. 750 ms de conversion
+#endif
+#define OMNI_DS18B20_MAX_PROBES 8
+#define OMNI_DS18B20_PERIOD 2000
+#define OMNI_DS18B20_RESCAN 30000
+
+class Driver_Dallas : public Device {
+    OneWire oneWire; DallasTemperature sensors;
+    DeviceAddress _addr[OMNI_DS18B20_MAX_PROBES];   // ROM du canal i
+    float _t[OMNI_DS18B20_MAX_PROBES];
+    uint8_t _n = 0, _res = OMNI_DS18B20_RES;        // _n : canaux attribués
+    uint8_t _present = 0;       // Bit i : sonde du canal i vue au dernier scan
+    uint8_t _ok = 0;            // Bit i : _t[i] est une mesure (ni sonde absente, ni registre de mise sous tension)
+    bool _converting = false, _rescan = false;
+    uint32_t _convStart = 0, _nextConv = 0, _lastScan = 0;
+
+    int channelOf(const uint8_t* rom) const {
+        for(uint8_t i=0; i<_n; i++) if(memcmp(_addr[i], rom, sizeof(DeviceAddress)) == 0) return i;
+        return -1;
+    }
+
+    void scan() {
+        sensors.begin();
+        _present = 0;
+        DeviceAddress rom;
+        for(uint8_t i=0; i<sensors.getDeviceCount(); i++) {
+            if(!sensors.getAddress(rom, i)) continue;
+            int ch = channelOf(rom);
+            // Nouvelle sonde : canal libre suivant (table pleine : ignorée)
+            if(ch < 0 && _n < OMNI_DS18B20_MAX_PROBES) { memcpy(_addr[_n], rom, sizeof(DeviceAddress)); ch = _n++; }
+            if(ch >= 0) _present |= 1 << ch;
+        }
+        _ok = 0;
+        sensors.setResolution(_res);
+        sensors.setWaitForConversion(false);
+        _converting = _rescan = false;
+        _lastScan = millis();
+    }
+
+    static uint8_t parse(JsonObjectConst o) { return constrain(o["res"] | OMNI_DS18B20_RES, 9, 12); }
+
+    // "roms" : 14 chiffres hexa par canal (famille + numéro de série, CRC recalculé)
+    static uint8_t parseRoms(JsonArrayConst list, DeviceAddress* out) {
+        uint8_t n = 0;
+        for(JsonVariantConst v : list) {
+            const char* hex = v | "";
+            if(n >= OMNI_DS18B20_MAX_PROBES || strlen(hex) != 14 || strspn(hex, "0123456789abcdefABCDEF") != 14) break;
+            for(uint8_t b=0; b<7; b++) { char h[3] = {hex[2 * b], hex[2 * b + 1], 0}; out[n][b] = strtoul(h, nullptr, 16); }
+            out[n][7] = OneWire::crc8(out[n], 7);
+            n++;
+        }
+        return n;
     }
-    ~Driver_Dallas() { delete sensors; delete oneWire; }
+
+public:
+    static constexpr Channel CHANNELS[] = { {"temp", UNIT_CELSIUS}, {"temp1", UNIT_CELSIUS}, {"temp2", UNIT_CELSIUS}, {"temp3", UNIT_CELSIUS},
+                                            {"temp4", UNIT_CELSIUS}, {"temp5", UNIT_CELSIUS}, {"temp6", UNIT_CELSIUS}, {"temp7", UNIT_CELSIUS} };
+    static_assert(channelCount(CHANNELS) == OMNI_DS18B20_MAX_PROBES, "Un canal par sonde");
+
+    Driver_Dallas(const char* id, const char* name, int pin) : Device(id, name, "DS18B20", pin), oneWire(pin), sensors(&oneWire) {}
     
-    void begin() override { sensors->begin(); }
+    // Options : {"res":10,"roms":["28A1B2C3D4E5F6", ...]} (résolution 9..12 bits, défaut
+    // OMNI_DS18B20_RES ; ROM de chaque canal, apprise au scan si absente)
+    void setOptions(JsonObjectConst o) override { _res = parse(o); _n = parseRoms(o["roms"], _addr); }
+    bool getOptions(JsonObject o) const override {
+        o["res"] = _res;
+        if(!_n) return true;
+        JsonArray list = o.createNestedArray("roms");
+        for(uint8_t i=0; i<_n; i++) {
+            char hex[15];
+            for(uint8_t b=0; b<7; b++) snprintf(hex + 2 * b, 3, "%02X", _addr[i][b]);
+            list.add(hex);
+        }
+        return true;
+    }
+    // Sans "roms" : table apprise conservée
+    bool sameOptions(JsonObjectConst o) const override {
+        if(parse(o) != _res) return false;
+        if(o["roms"].isNull()) return true;
+        DeviceAddress roms[OMNI_DS18B20_MAX_PROBES];
+        uint8_t n = parseRoms(o["roms"], roms);
+        return n == _n && memcmp(roms, _addr, n * sizeof(DeviceAddress)) == 0;
+    }
+
+    void begin() override { scan(); }
     
-    void read(JsonObject& doc) override {
-        // NON-BLOCKING: Request conversion sparingly
-        if(millis() - lastRead > 2000) {
-            sensors->requestTemperatures();
-            lastT = sensors->getTempCByIndex(0);
-            lastRead = millis();
+    uint8_t channels(const Channel*& list) const override { list = CHANNELS; return _n; }
+    void sample(Reading& r) override {
+        uint32_t now = millis();
+        if(_converting && now - _convStart >= sensors.millisToWaitForConversion(_res)) {
+            _ok = 0;
+            uint8_t pad[9];
+            for(uint8_t i=0; i<_n; i++) {
+                if(!(_present & (1 << i))) continue;
+                if(!sensors.isConnected(_addr[i], pad)) { _rescan = true; continue; }
+                int16_t raw = (int16_t)((pad[1] << 8) | pad[0]);
+                // Registre de mise sous tension (sonde réinitialisée par une chute d'alimentation) :
+                // 85 °C avec l'octet réservé 6 à 0x0C. Une conversion y laisse 0x10 - (raw & 0x0F),
+                // soit 0x10 pour une vraie mesure à 85 °C.
+                if(raw == 0x0550 && pad[6] == 0x0C) continue;
+                raw &= ~((1 << (12 - _res)) - 1);      // Bits non définis en basse résolution
+                _t[i] = raw / 16.0f;
+                _ok |= 1 << i;
+            }
+            _converting = false;
+            _nextConv = _convStart + OMNI_DS18B20_PERIOD;
+        }
+        if(!_converting && (int32_t)(now - _nextConv) >= 0) {
+            // Sonde perdue ou bus vide : nouvelle recherche de ROM, espacée
+            bool missing = _rescan || !_n || _present != (uint8_t)((1u << _n) - 1);
+            if(missing && now - _lastScan >= OMNI_DS18B20_RESCAN) scan();
+            if(_present) { sensors.requestTemperatures(); _converting = true; _convStart = millis(); }
+            else _nextConv = now + OMNI_DS18B20_PERIOD;
         }
-        doc["temp"] = lastT;
+        // Seules les sondes lues à la dernière conversion : rien avant la première, ni après un rescan
+        for(uint8_t i=0; i<_n; i++) if(_ok & (1 << i)) r.set(i, _t[i]);
+    }
+
+    // "res" : résolution 9..12 bits appliquée à toutes les sondes (option "res", gardée à la sauvegarde)
+    void write(String cmd, float val) override {
+        if(cmd != "res") return;
+        _res = constrain((int)val, 9, 12);
+        sensors.setResolution(_res);
     }
+
     DeviceType getType() override { return SENSOR_VAL; }
+    uint32_t samplePeriod() override {
+        return msUntil(_converting ? _convStart + sensors.millisToWaitForConversion(_res) : _nextConv);
+    }
 };
 
 // ==========================================
 // 3. ACTIONNEURS AVANCÉS
 // ==========================================
 
+// Consigne suivie selon le profil de l'axe (OmniMotion.h) : write() ne fait que planifier
 class Driver_Servo : public Device {
-    Servo servo; int _pos = 0;
+    ServoAxis _axis;
 public:
-    Driver_Servo(String id, String name, int pin) : Device(id, name, "SERVO", pin) {}
-    ~Driver_Servo() { servo.detach(); }
-    
-    void begin() override {
-        // ESP32Servo specific setup
-        servo.setPeriodHertz(50);
-        servo.attach(_pin, 500, 2400); 
+    Driver_Servo(const char* id, const char* name, int pin) : Device(id, name, "SERVO", pin) {}
+    ~Driver_Servo() { _axis.end(); }
+
+    void begin() override { _axis.begin(_pin, 500, 2400); }
+
+    // speed °/s (0 = immédiat), accel °/s² (0 = vitesse constante), profile 0 linéaire / 1 trapèze / 2 sinus ;
+    // autre commande : angle cible (0..180)
+    void write(String cmd, float val) override {
+        if(cmd == "speed") _axis.speed = max(val, 0.0f);
+        else if(cmd == "accel") _axis.accel = max(val, 0.0f);
+        else if(cmd == "profile") _axis.profile = constrain((int)val, 0, MOTION_COUNT - 1);
+        else motion().move(_axis, constrain(val, 0, 180));
     }
-    
-    void write(String cmd, float val) override { 
-        _pos = constrain((int)val, 0, 180); 
-        servo.write(_pos); 
+    static constexpr Channel CHANNELS[] = { {"angle", UNIT_DEGREE}, {"target", UNIT_DEGREE} };
+    uint8_t channels(const Channel*& list) const override { list = CHANNELS; return channelCount(CHANNELS); }
+    void sample(Reading& r) override {
+        r.set(0, roundf(_axis.position()));
+        r.set(1, roundf(_axis.target()));
     }
-    void read(JsonObject& doc) override { doc["angle"] = _pos; }
     DeviceType getType() override { return ACTUATOR_VAL; }
+    // Position publiée pendant le mouvement
+    uint32_t samplePeriod() override { return _axis.moving() ? 100 : 1000; }
 };
 
+// Ruban adressable : effet rendu et émis par la tâche "leds" (OmniLeds.h), write() ne bloque pas.
+// Options : {"count":60,"order":"GRBW"} (défaut : 16 pixels GRB)
 class Driver_Neo : public Device {
-    Adafruit_NeoPixel* pixels; int _count;
+    LedStrip _strip;
+    uint16_t _count = OMNI_LED_DEFAULT;
+    const LedOrder* _order = &LED_ORDERS[0];
+
+    static void parse(JsonObjectConst o, uint16_t& count, const LedOrder*& order) {
+        count = constrain(o["count"] | OMNI_LED_DEFAULT, 1, OMNI_LED_MAX);
+        order = ledOrder(o["order"] | "GRB");
+        if(!order) order = &LED_ORDERS[0];
+    }
 public:
-    Driver_Neo(String id, String name, int pin, int count) 
-        : Device(id, name, "NEOPIXEL", pin), _count(count) { 
-        pixels = new Adafruit_NeoPixel(count, pin, NEO_GRB + NEO_KHZ800); 
+    Driver_Neo(const char* id, const char* name, int pin) : Device(id, name, "NEOPIXEL", pin) {}
+    ~Driver_Neo() { _strip.end(); }
+
+    void setOptions(JsonObjectConst o) override { parse(o, _count, _order); }
+    bool getOptions(JsonObject o) const override { o["count"] = _count; o["order"] = _order->name; return true; }
+    bool sameOptions(JsonObjectConst o) const override {
+        uint16_t n; const LedOrder* ord;
+        parse(o, n, ord);
+        return n == _count && ord == _order;
     }
-    ~Driver_Neo() { delete pixels; }
-    
-    void begin() override { pixels->begin(); pixels->show(); }
-    
+
+    void begin() override {
+        if(!_strip.begin(_pin, _count, _order)) Serial.printf("NeoPixel %s: ruban indisponible (mémoire ou canal RMT)\n", _id);
+    }
+
+    // fx 0..4, hue/hue2 0..65535, sat/bright 0..255, speed (ms par cycle), power 0/1, toggle ;
+    // autre commande : teinte unie `val` (forme historique)
     void write(String cmd, float val) override {
-        uint32_t color = pixels->ColorHSV((uint16_t)val);
-        for(int i=0; i<_count; i++) pixels->setPixelColor(i, color);
-        pixels->show();
+        LedParams p = _strip.params();
+        if(cmd == "fx") { p.fx = constrain((int)val, 0, FX_COUNT - 1); p.on = true; }
+        else if(cmd == "hue") p.hue = constrain(val, 0, 65535);
+        else if(cmd == "hue2") p.hue2 = constrain(val, 0, 65535);
+        else if(cmd == "sat") p.sat = constrain(val, 0, 255);
+        else if(cmd == "bright") p.bright = constrain(val, 0, 255);
+        else if(cmd == "speed") p.period = constrain(val, 100, 60000);
+        else if(cmd == "power") p.on = val != 0;
+        else if(cmd == "toggle") p.on = !p.on;
+        else { p.fx = FX_SOLID; p.hue = (uint16_t)val; p.on = true; }
+        _strip.setParams(p);
+    }
+    // Nom d'effet ("rainbow", ...), "on" ou "off"
+    void writeText(String text) override {
+        LedParams p = _strip.params();
+        int8_t fx = ledEffect(text.c_str());
+        if(fx >= 0) { p.fx = fx; p.on = true; }
+        else if(text.equalsIgnoreCase("on") || text.equalsIgnoreCase("off")) p.on = text.equalsIgnoreCase("on");
+        else return;
+        _strip.setParams(p);
+    }
+
+    static constexpr Channel CHANNELS[] = { {"on", UNIT_BOOL}, {"bright", UNIT_RAW} };
+    uint8_t channels(const Channel*& list) const override { list = CHANNELS; return channelCount(CHANNELS); }
+    void sample(Reading& r) override {
+        LedParams p = _strip.params();
+        r.set(0, p.on);
+        r.set(1, p.bright);
+    }
+    void readExtra(JsonObject& doc) override {
+        LedParams p = _strip.params();
+        doc["fx"] = ledEffectName(p.fx);
+        doc["hue"] = p.hue;
+        doc["count"] = _count;
+        if(!_strip.active()) doc["status"] = "Erreur";
     }
-    void read(JsonObject& doc) override { doc["status"] = "Active"; }
     DeviceType getType() override { return ACTUATOR_VAL; }
 };
 
@@ -189,124 +689,602 @@ public:
 // 4. DRIVERS I2C INDUSTRIELS
 // ==========================================
 
+// Aucun accès direct à Wire : tout passe par la tâche bus (OmniI2C.h).
+// read() ne fait que publier le dernier résultat et déposer la mesure
+// suivante ; samplePeriod() ramène le Sampler dès que la réponse est arrivée.
+// Les drivers à bibliothèque (INA219, BH1750, écrans) l'exécutent dans onBus().
+#define OMNI_I2C_PERIOD 1000
+#define OMNI_DISPLAY_TEXT 32
+
 class Driver_I2C_Base : public Device {
+protected:
+    I2CPriority _prio;
+    std::atomic<bool> _pending{false};  // Requête déposée, callback pas encore reçu
+    bool _fresh = false;                // Résultat non encore publié (sous _mux)
+    uint8_t _raw[OMNI_I2C_RX];          // Dernière rafale reçue (sous _mux)
+    uint32_t _next = 0;
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+
+    static void onBurst(void* ctx, uint8_t err, const uint8_t* rx, uint8_t len) {
+        Driver_I2C_Base* self = (Driver_I2C_Base*)ctx;
+        if(!err) {
+            portENTER_CRITICAL(&self->_mux);
+            memcpy(self->_raw, rx, len);
+            self->_fresh = true;
+            portEXIT_CRITICAL(&self->_mux);
+        }
+        self->_pending = false;
+    }
+    static void onJob(void* ctx) {
+        Driver_I2C_Base* self = (Driver_I2C_Base*)ctx;
+        self->onBus();
+        self->_pending = false;
+    }
+
+    // Tâche bus : code bibliothèque du driver (Wire disponible)
+    virtual void onBus() {}
+
+    bool due() const { return !_pending && (int32_t)(millis() - _next) >= 0; }
+    void requestRegs(uint8_t reg, uint8_t len) {
+        _next = millis() + OMNI_I2C_PERIOD;
+        _pending = true;
+        if(!i2cBus().readRegs(_pin, reg, len, onBurst, this, _prio)) _pending = false;
+    }
+    void requestJob(uint32_t period = OMNI_I2C_PERIOD) {
+        _next = millis() + period;
+        _pending = true;
+        if(!i2cBus().job(onJob, this, _prio)) _pending = false;
+    }
+    // Copie la dernière rafale si elle n'a pas encore été publiée
+    bool collect(uint8_t* out, size_t len) {
+        portENTER_CRITICAL(&_mux);
+        bool f = _fresh;
+        if(f) { memcpy(out, _raw, len); _fresh = false; }
+        portEXIT_CRITICAL(&_mux);
+        return f;
+    }
+    // A appeler en tête du destructeur dérivé : plus aucun callback ensuite
+    void detachBus() { i2cBus().cancel(this); }
+
 public:
-    Driver_I2C_Base(String id, String name, String type, int addr) : Device(id, name, type, addr) {}
+    Driver_I2C_Base(const char* id, const char* name, const char* type, int addr, I2CPriority prio = I2C_NORMAL)
+        : Device(id, name, type, addr), _prio(prio) {}
+    uint32_t samplePeriod() override { return _pending ? 2 : msUntil(_next); }
 };
 
 class Driver_INA219 : public Driver_I2C_Base {
-    Adafruit_INA219* ina;
+    Adafruit_INA219 ina;
+    bool _ok = false, _valid = false;
+    float _v = 0, _mA = 0, _mW = 0;
+protected:
+    void onBus() override {
+        if(!_ok && !(_ok = ina.begin())) { Serial.println("INA Fail"); return; }
+        float v = ina.getBusVoltage_V(), mA = ina.getCurrent_mA(), mW = ina.getPower_mW();
+        portENTER_CRITICAL(&_mux);
+        _v = v; _mA = mA; _mW = mW; _valid = true;
+        portEXIT_CRITICAL(&_mux);
+    }
 public:
-    Driver_INA219(String id, String name, int addr) : Driver_I2C_Base(id, name, "INA219", addr) { ina = new Adafruit_INA219(addr); }
-    ~Driver_INA219() { delete ina; }
-    void begin() override { if(!ina->begin()) Serial.println("INA Fail"); }
-    void read(JsonObject& doc) override {
-        doc["volts"] = ina->getBusVoltage_V();
-        doc["mA"] = ina->getCurrent_mA();
-        doc["mW"] = ina->getPower_mW();
+    static constexpr Channel CHANNELS[] = { {"volts", UNIT_VOLT}, {"mA", UNIT_MA}, {"mW", UNIT_MW} };
+
+    Driver_INA219(const char* id, const char* name, int addr) : Driver_I2C_Base(id, name, "INA219", addr), ina(addr) {}
+    ~Driver_INA219() { detachBus(); }
+    void begin() override { requestJob(); }
+    uint8_t channels(const Channel*& list) const override { list = CHANNELS; return channelCount(CHANNELS); }
+    void sample(Reading& r) override {
+        if(due()) requestJob();
+        portENTER_CRITICAL(&_mux);
+        bool valid = _valid; float v = _v, mA = _mA, mW = _mW;
+        portEXIT_CRITICAL(&_mux);
+        if(!valid) return;
+        r.set(0, v);
+        r.set(1, mA);
+        r.set(2, mW);
     }
     DeviceType getType() override { return SENSOR_VAL; }
 };
 
+// Registres lus en une rafale (0xF7..0xFE : pression, température, humidité),
+// compensation entière de la datasheet (§4.2.3) faite ici avec les
+// coefficients lus à l'initialisation.
 class Driver_BME280 : public Driver_I2C_Base {
-    Adafruit_BME280* bme;
+    uint16_t T1, P1; int16_t T2, T3, P2, P3, P4, P5, P6, P7, P8, P9;
+    uint8_t H1, H3; int16_t H2, H4, H5; int8_t H6;
+    std::atomic<bool> _ok{false};
+    bool _valid = false;
+    float _t = 0, _h = 0, _p = 0;
+
+    static uint16_t u16(const uint8_t* b) { return b[0] | (b[1] << 8); }
+
+    // Tâche bus : identification, coefficients, puis mode normal x1 (humidité, température, pression)
+    void onBus() override {
+        uint8_t reg = 0xD0, id = 0, c[26], h[7];
+        if(i2cBus().transfer(_pin, &reg, 1, &id, 1) || id != 0x60) { Serial.println("BME Fail"); return; }
+        reg = 0x88; if(i2cBus().transfer(_pin, &reg, 1, c, 26)) return;
+        reg = 0xE1; if(i2cBus().transfer(_pin, &reg, 1, h, 7)) return;
+        T1 = u16(c); T2 = u16(c + 2); T3 = u16(c + 4);
+        P1 = u16(c + 6); P2 = u16(c + 8); P3 = u16(c + 10); P4 = u16(c + 12); P5 = u16(c + 14);
+        P6 = u16(c + 16); P7 = u16(c + 18); P8 = u16(c + 20); P9 = u16(c + 22);
+        H1 = c[25]; H2 = u16(h); H3 = h[2];
+        H4 = (int16_t)((int8_t)h[3] * 16) | (h[4] & 0x0F);
+        H5 = (int16_t)((int8_t)h[5] * 16) | (h[4] >> 4);
+        H6 = (int8_t)h[6];
+        static const uint8_t init[3][2] = {{0xF2, 0x01}, {0xF4, 0x27}, {0xF5, 0x00}};
+        for(auto& w : init) if(i2cBus().transfer(_pin, w, 2)) return;
+        _ok = true;
+    }
+
+    int32_t tfine(int32_t adc) const {
+        int32_t v1 = ((((adc >> 3) - ((int32_t)T1 << 1))) * ((int32_t)T2)) >> 11;
+        int32_t v2 = (((((adc >> 4) - ((int32_t)T1)) * ((adc >> 4) - ((int32_t)T1))) >> 12) * ((int32_t)T3)) >> 14;
+        return v1 + v2;
+    }
+    float pressure(int32_t adc, int32_t tf) const {     // Pa
+        int64_t v1 = (int64_t)tf - 128000;
+        int64_t v2 = v1 * v1 * (int64_t)P6;
+        v2 = v2 + ((v1 * (int64_t)P5) << 17);
+        v2 = v2 + (((int64_t)P4) << 35);
+        v1 = ((v1 * v1 * (int64_t)P3) >> 8) + ((v1 * (int64_t)P2) << 12);
+        v1 = (((((int64_t)1) << 47) + v1)) * ((int64_t)P1) >> 33;
+        if(v1 == 0) return 0;
+        int64_t p = 1048576 - adc;
+        p = (((p << 31) - v2) * 3125) / v1;
+        v1 = (((int64_t)P9) * (p >> 13) * (p >> 13)) >> 25;
+        v2 = (((int64_t)P8) * p) >> 19;
+        p = ((p + v1 + v2) >> 8) + (((int64_t)P7) << 4);
+        return (float)p / 256.0f;
+    }
+    float humidity(int32_t adc, int32_t tf) const {     // %
+        int32_t v = tf - 76800;
+        v = (((((adc << 14) - (((int32_t)H4) << 20) - (((int32_t)H5) * v)) + 16384) >> 15) *
+             (((((((v * ((int32_t)H6)) >> 10) * (((v * ((int32_t)H3)) >> 11) + 32768)) >> 10) + 2097152) * ((int32_t)H2) + 8192) >> 14));
+        v = v - (((((v >> 15) * (v >> 15)) >> 7) * ((int32_t)H1)) >> 4);
+        v = constrain(v, 0, 419430400);
+        return (float)(v >> 12) / 1024.0f;
+    }
+
 public:
-    Driver_BME280(String id, String name, int addr) : Driver_I2C_Base(id, name, "BME280", addr) { bme = new Adafruit_BME280(); }
-    ~Driver_BME280() { delete bme; }
-    void begin() override { bme->begin(_pin); }
-    void read(JsonObject& doc) override {
-        doc["temp"] = bme->readTemperature();
-        doc["hum"] = bme->readHumidity();
-        doc["pres"] = bme->readPressure() / 100.0F;
+    static constexpr Channel CHANNELS[] = { {"temp", UNIT_CELSIUS}, {"hum", UNIT_PERCENT}, {"pres", UNIT_HPA} };
+
+    Driver_BME280(const char* id, const char* name, int addr) : Driver_I2C_Base(id, name, "BME280", addr) {}
+    ~Driver_BME280() { detachBus(); }
+    void begin() override { requestJob(0); }   // Initialisation, première rafale juste après
+    uint8_t channels(const Channel*& list) const override { list = CHANNELS; return channelCount(CHANNELS); }
+    void sample(Reading& r) override {
+        uint8_t b[8];
+        if(collect(b, sizeof(b))) {
+            int32_t aP = ((uint32_t)b[0] << 12) | (b[1] << 4) | (b[2] >> 4);
+            int32_t aT = ((uint32_t)b[3] << 12) | (b[4] << 4) | (b[5] >> 4);
+            int32_t aH = (b[6] << 8) | b[7];
+            if(aT != 0x80000) {     // 0x80000 : mesure pas encore faite
+                int32_t tf = tfine(aT);
+                _t = ((tf * 5 + 128) >> 8) / 100.0f;
+                _p = pressure(aP, tf) / 100.0f;
+                _h = humidity(aH, tf);
+                _valid = true;
+            }
+        }
+        if(due()) { if(_ok) requestRegs(0xF7, 8); else requestJob(); }   // Réessaie l'init toutes les secondes
+        if(!_valid) return;
+        r.set(0, _t);
+        r.set(1, _h);
+        r.set(2, _p);
     }
     DeviceType getType() override { return SENSOR_VAL; }
 };
 
 class Driver_BH1750 : public Driver_I2C_Base {
-    BH1750* lightMeter;
+    BH1750 lightMeter;
+    bool _ok = false, _valid = false;
+    float _lux = 0;
+protected:
+    void onBus() override {
+        if(!_ok && !(_ok = lightMeter.begin())) return;
+        float lux = lightMeter.readLightLevel();
+        portENTER_CRITICAL(&_mux);
+        _lux = lux; _valid = lux >= 0;
+        portEXIT_CRITICAL(&_mux);
+    }
 public:
-    Driver_BH1750(String id, String name, int addr) : Driver_I2C_Base(id, name, "BH1750", addr) { lightMeter = new BH1750(addr); }
-    ~Driver_BH1750() { delete lightMeter; }
-    void begin() override { lightMeter->begin(); }
-    void read(JsonObject& doc) override { doc["lux"] = lightMeter->readLightLevel(); }
+    static constexpr Channel CHANNELS[] = { {"lux", UNIT_LUX} };
+
+    Driver_BH1750(const char* id, const char* name, int addr) : Driver_I2C_Base(id, name, "BH1750", addr), lightMeter(addr) {}
+    ~Driver_BH1750() { detachBus(); }
+    void begin() override { requestJob(); }
+    uint8_t channels(const Channel*& list) const override { list = CHANNELS; return channelCount(CHANNELS); }
+    void sample(Reading& r) override {
+        if(due()) requestJob();
+        portENTER_CRITICAL(&_mux);
+        bool valid = _valid; float lux = _lux;
+        portEXIT_CRITICAL(&_mux);
+        if(valid) r.set(0, lux);
+    }
     DeviceType getType() override { return SENSOR_VAL; }
 };
 
-class Driver_LCD : public Driver_I2C_Base {
-    LiquidCrystal_I2C* lcd;
-    String _txt = "Ready";
+// Écrans : writeText() ne fait que copier le texte et déposer un rendu en
+// priorité basse ; plusieurs textes en attente se résument au dernier, un
+// texte identique n'en dépose aucun. Un rendu au plus tous les
+// OMNI_DISPLAY_MIN_MS : un texte arrivé pendant la fenêtre est repris par le
+// tick du Sampler. Chaque écran n'envoie que ce qui diffère de l'image déjà
+// affichée (cellules LCD, segments de pages SSD1306).
+#ifndef OMNI_DISPLAY_MIN_MS
+#define OMNI_DISPLAY_MIN_MS 250
+#endif
+
+class Driver_Display : public Driver_I2C_Base {
+    char _show[OMNI_DISPLAY_TEXT + 1] = "";
+    bool _dirty = false, _init = false;
+protected:
+
+    virtual bool init() = 0;                    // Tâche bus : false = écran absent
+    virtual void render(const char* text) = 0;  // Tâche bus
+
+    void onBus() override {
+        if(!_init && !(_init = init())) return;
+        char text[sizeof(_show)];
+        portENTER_CRITICAL(&_mux);
+        bool dirty = _dirty;
+        memcpy(text, _show, sizeof(text));
+        _dirty = false;
+        portEXIT_CRITICAL(&_mux);
+        if(dirty) render(text);
+    }
 public:
-    Driver_LCD(String id, String name, int addr) : Driver_I2C_Base(id, name, "LCD_I2C", addr) { lcd = new LiquidCrystal_I2C(addr, 16, 2); }
-    ~Driver_LCD() { delete lcd; }
-    void begin() override { lcd->init(); lcd->backlight(); lcd->setCursor(0,0); lcd->print("OmniESP V2"); }
+    Driver_Display(const char* id, const char* name, const char* type, int addr) : Driver_I2C_Base(id, name, type, addr, I2C_LOW) {
+        strlcpy(_show, "Ready", sizeof(_show));
+    }
+    void begin() override { requestJob(0); }
     void writeText(String text) override {
-        lcd->clear();
-        lcd->setCursor(0,0); lcd->print(_name.substring(0,16));
-        lcd->setCursor(0,1); lcd->print(text.substring(0,16));
-        _txt = text;
+        portENTER_CRITICAL(&_mux);
+        bool same = strncmp(_show, text.c_str(), sizeof(_show) - 1) == 0;
+        if(!same) { strlcpy(_show, text.c_str(), sizeof(_show)); _dirty = true; }
+        portEXIT_CRITICAL(&_mux);
+        if(!same && due()) requestJob(OMNI_DISPLAY_MIN_MS);
     }
     void write(String cmd, float val) override { writeText(String(val)); }
-    void read(JsonObject& doc) override { doc["display"] = _txt; }
+    void sample(Reading& r) override {
+        if(_dirty && due()) requestJob(OMNI_DISPLAY_MIN_MS);    // Rendu différé par la fenêtre
+    }
+    void readExtra(JsonObject& doc) override {
+        char text[sizeof(_show)];
+        portENTER_CRITICAL(&_mux);
+        memcpy(text, _show, sizeof(text));
+        portEXIT_CRITICAL(&_mux);
+        doc["display"] = text;
+    }
     DeviceType getType() override { return DISPLAY_DEV; }
+    uint32_t samplePeriod() override { return _dirty ? OMNI_DISPLAY_MIN_MS : 1000; }
 };
 
-// --- DRIVER OLED (NOUVEAU) ---
-class Driver_OLED : public Driver_I2C_Base {
-    Adafruit_SSD1306* display;
-    String _txt = "Ready";
+class Driver_LCD : public Driver_Display {
+    static const uint8_t COLS = 16, ROWS = 2;
+    LiquidCrystal_I2C lcd;
+    char _cells[ROWS][COLS];    // Contenu affiché
+
+    // Réécrit les seules cellules modifiées ; le curseur avance seul entre cellules contiguës
+    void putRow(uint8_t row, const char* s) {
+        int cursor = -1;
+        for(uint8_t c=0; c<COLS; c++) {
+            char ch = *s ? *s++ : ' ';
+            if(ch == _cells[row][c]) continue;
+            if(cursor != c) lcd.setCursor(c, row);
+            lcd.write((uint8_t)ch);
+            _cells[row][c] = ch;
+            cursor = c + 1;
+        }
+    }
+protected:
+    bool init() override {
+        lcd.init(); lcd.backlight();
+        memset(_cells, ' ', sizeof(_cells));    // init() efface l'écran
+        putRow(0, "OmniESP V2");
+        return true;
+    }
+    void render(const char* text) override {
+        putRow(0, _name);
+        putRow(1, text);
+    }
 public:
-    Driver_OLED(String id, String name, int addr) : Driver_I2C_Base(id, name, "OLED", addr) {
-        display = new Adafruit_SSD1306(128, 64, &Wire, -1);
+    Driver_LCD(const char* id, const char* name, int addr) : Driver_Display(id, name, "LCD_I2C", addr), lcd(addr, COLS, ROWS) {}
+    ~Driver_LCD() { detachBus(); }
+};
+
+// --- DRIVER OLED (NOUVEAU) ---
+#define OMNI_OLED_W 128
+#define OMNI_OLED_PAGES 8
+#define OMNI_OLED_FB (OMNI_OLED_W * OMNI_OLED_PAGES)
+class Driver_OLED : public Driver_Display {
+    // Framebuffer pris dans bufferPool() avant begin() (la bibliothèque ne l'alloue que s'il est nul)
+    struct Panel : Adafruit_SSD1306 {
+        using Adafruit_SSD1306::Adafruit_SSD1306;
+        bool begin(uint8_t vcs, uint8_t addr) {
+            if(!buffer) buffer = (uint8_t*)bufferPool().alloc(OMNI_OLED_FB);
+            return Adafruit_SSD1306::begin(vcs, addr);
+        }
+        ~Panel() { if(bufferPool().owns(buffer)) { bufferPool().free(buffer); buffer = nullptr; } }
+    } display;
+    uint8_t* _shown = nullptr;  // Copie de la GDDRAM (bufferPool, sinon tas) ; nul = envoi complet
+
+    // Colonnes [c0, c1] d'une page, en adressage horizontal comme display()
+    void pushSpan(uint8_t page, uint8_t c0, uint8_t c1) {
+        const uint8_t cmd[] = {0x00, 0x22, page, page, 0x21, c0, c1};
+        Wire.beginTransmission(_pin); Wire.write(cmd, sizeof(cmd)); Wire.endTransmission();
+        const uint8_t* p = display.getBuffer() + page * OMNI_OLED_W + c0;
+        for(size_t n = c1 - c0 + 1; n; ) {
+            size_t k = min(n, (size_t)I2C_BUFFER_LENGTH - 1);
+            Wire.beginTransmission(_pin); Wire.write((uint8_t)0x40); Wire.write(p, k); Wire.endTransmission();
+            p += k; n -= k;
+        }
     }
-    ~Driver_OLED() { delete display; }
-    
-    void begin() override {
-        if(!display->begin(SSD1306_SWITCHCAPVCC, _pin)) { Serial.println("OLED Fail"); return; }
-        display->clearDisplay();
-        display->setTextSize(1); display->setTextColor(SSD1306_WHITE);
-        display->setCursor(0,0); display->println("OmniESP V2");
-        display->println("Industrial"); display->display();
+
+    // Par page : seul l'intervalle de colonnes modifiées part sur le bus
+    void flush() {
+        const uint8_t* fb = display.getBuffer();
+        if(!_shown) { display.display(); return; }
+        for(uint8_t pg=0; pg<OMNI_OLED_PAGES; pg++) {
+            const uint8_t* a = fb + pg * OMNI_OLED_W;
+            uint8_t* b = _shown + pg * OMNI_OLED_W;
+            int c0 = 0, c1 = OMNI_OLED_W - 1;
+            while(c0 < OMNI_OLED_W && a[c0] == b[c0]) c0++;
+            if(c0 == OMNI_OLED_W) continue;
+            while(a[c1] == b[c1]) c1--;
+            pushSpan(pg, c0, c1);
+            memcpy(b + c0, a + c0, c1 - c0 + 1);
+        }
     }
-    
-    void writeText(String text) override {
-        display->clearDisplay();
-        display->setTextSize(1); display->setCursor(0,0); display->println(_name);
-        display->drawLine(0, 10, 128, 10, SSD1306_WHITE);
-        display->setTextSize(2); display->setCursor(0, 20); display->println(text);
-        display->display();
-        _txt = text;
+protected:
+    bool init() override {
+        if(!display.begin(SSD1306_SWITCHCAPVCC, _pin)) { Serial.println("OLED Fail"); return false; }
+        display.clearDisplay();
+        display.setTextSize(1); display.setTextColor(SSD1306_WHITE);
+        display.setCursor(0,0); display.println("OmniESP V2");
+        display.println("Industrial"); display.display();
+        if(!_shown && !(_shown = (uint8_t*)bufferPool().alloc(OMNI_OLED_FB))) _shown = new (std::nothrow) uint8_t[OMNI_OLED_FB];
+        if(_shown) memcpy(_shown, display.getBuffer(), OMNI_OLED_FB);
+        return true;
     }
-    void write(String cmd, float val) override { writeText(String(val)); }
-    void read(JsonObject& doc) override { doc["display"] = _txt; }
-    DeviceType getType() override { return DISPLAY_DEV; }
+    void render(const char* text) override {
+        display.clearDisplay();
+        display.setTextSize(1); display.setCursor(0,0); display.println(_name);
+        display.drawLine(0, 10, 128, 10, SSD1306_WHITE);
+        display.setTextSize(2); display.setCursor(0, 20); display.println(text);
+        flush();
+    }
+public:
+    Driver_OLED(const char* id, const char* name, int addr) : Driver_Display(id, name, "OLED", addr), display(OMNI_OLED_W, 64, &Wire, -1) {}
+    ~Driver_OLED() {
+        detachBus();
+        if(bufferPool().owns(_shown)) bufferPool().free(_shown);
+        else delete[] _shown;
+    }
+};
+
+// ==========================================
+// TABLE DES DRIVERS (CONSTEXPR)
+// ==========================================
+// Une ligne par type : capacités, broches autorisées, taille et constructeur.
+// Factory, validation de config, pools et /api/drivers en sont dérivés ;
+// ajouter un driver = ajouter une ligne. Recherche par hash FNV-1a du nom
+// (calculé à la compilation pour la table), confirmé par strcmp.
+
+constexpr uint32_t driverHash(const char* s) {
+    uint32_t h = 2166136261u;
+    while(*s) h = (h ^ (uint8_t)*s++) * 16777619u;
+    return h;
+}
+
+enum DriverCaps : uint8_t {
+    DRV_INPUT  = 1 << 0,    // Capteur (publie des mesures)
+    DRV_OUTPUT = 1 << 1,    // Actionneur (commandes write())
+    DRV_I2C    = 1 << 2,    // "pin" = adresse I2C
+    DRV_ANALOG = 1 << 3,    // Broche ADC
+    DRV_TEXT   = 1 << 4,    // Afficheur (writeText())
+};
+
+// Masques de GPIO (bit n = GPIO n) de l'ESP32-WROOM
+constexpr uint64_t gpioMask(std::initializer_list<uint8_t> pins) {
+    uint64_t m = 0;
+    for(uint8_t p : pins) m |= 1ull << p;
+    return m;
+}
+// Broches existantes hors flash SPI (6..11) et UART0 (1, 3)
+constexpr uint64_t PINS_IN  = gpioMask({0, 2, 4, 5, 12, 13, 14, 15, 16, 17, 18, 19, 21, 22, 23, 25, 26, 27,
+                                        32, 33, 34, 35, 36, 37, 38, 39});
+// 34..39 : entrées seulement
+constexpr uint64_t PINS_OUT = PINS_IN & ~gpioMask({34, 35, 36, 37, 38, 39});
+// ADC1 (32..39) seulement : l'ADC2 est pris par le WiFi, ses lectures échouent
+constexpr uint64_t PINS_ADC  = gpioMask({32, 33, 34, 35, 36, 37, 38, 39});
+constexpr uint64_t PINS_ADC2 = gpioMask({0, 2, 4, 12, 13, 14, 15, 25, 26, 27});
+
+#define OMNI_I2C_ADDR_MIN 0x01
+#define OMNI_I2C_ADDR_MAX 0x77
+
+typedef Device* (*DriverMake)(const char* type, const char* id, const char* name, int pin);
+
+struct DriverDesc {
+    const char* type;
+    uint32_t hash;
+    uint8_t caps;
+    uint64_t pins;          // GPIO autorisées (0 pour l'I2C)
+    uint8_t addr;           // Adresse I2C par défaut (0 pour un GPIO)
+    uint16_t size;          // sizeof du driver
+    DriverMake make;
+    const Channel* channels;    // Canaux déclarés (maximum pour un nombre variable)
+    uint8_t nch;
+
+    constexpr bool has(uint8_t c) const { return caps & c; }
 };
 
+// T::CHANNELS s'il existe, sinon aucun canal
+template<typename T, typename = void> struct ChannelsOf {
+    static constexpr const Channel* list = nullptr;
+    static constexpr uint8_t n = 0;
+};
+template<typename T> struct ChannelsOf<T, std::void_t<decltype(T::CHANNELS)>> {
+    static constexpr const Channel* list = T::CHANNELS;
+    static constexpr uint8_t n = channelCount(T::CHANNELS);
+};
+
+template<typename T> constexpr DriverDesc driverRow(const char* type, uint8_t caps, uint64_t pins, uint8_t addr, DriverMake make,
+                                                    uint8_t nch = ChannelsOf<T>::n) {
+    return { type, driverHash(type), caps, pins, addr, (uint16_t)sizeof(T), make, ChannelsOf<T>::list, nch };
+}
+// Drivers au constructeur (id, nom, broche)
+template<typename T> Device* makeDriver(const char*, const char* id, const char* name, int pin) { return new T(id, name, pin); }
+
+constexpr DriverDesc DRIVERS[] = {
+    // Digital
+    driverRow<Driver_Digital>("RELAY", DRV_OUTPUT, PINS_OUT, 0, [](const char* t, const char* id, const char* n, int p) -> Device* { return new Driver_Digital(id, n, t, p, true, false); }, 1),
+    driverRow<Driver_Digital>("VALVE", DRV_OUTPUT, PINS_OUT, 0, [](const char* t, const char* id, const char* n, int p) -> Device* { return new Driver_Digital(id, n, t, p, true, false); }, 1),
+    driverRow<Driver_Digital>("LOCK", DRV_OUTPUT, PINS_OUT, 0, [](const char* t, const char* id, const char* n, int p) -> Device* { return new Driver_Digital(id, n, t, p, true, false); }, 1),
+    driverRow<Driver_Digital>("BUTTON", DRV_INPUT, PINS_IN, 0, [](const char* t, const char* id, const char* n, int p) -> Device* { return new Driver_Digital(id, n, t, p, false, true); }),
+    driverRow<Driver_Digital>("DOOR", DRV_INPUT, PINS_IN, 0, [](const char* t, const char* id, const char* n, int p) -> Device* { return new Driver_Digital(id, n, t, p, false, true); }),
+    driverRow<Driver_Digital>("PIR", DRV_INPUT, PINS_IN, 0, [](const char* t, const char* id, const char* n, int p) -> Device* { return new Driver_Digital(id, n, t, p, false, false); }),
+    driverRow<Driver_Pulse>("PULSE", DRV_INPUT, PINS_IN, 0, makeDriver<Driver_Pulse>),
+
+    // Analog / Specific (DHT et OneWire : ligne bidirectionnelle)
+    driverRow<Driver_Analog>("LDR", DRV_INPUT | DRV_ANALOG, PINS_ADC, 0, [](const char* t, const char* id, const char* n, int p) -> Device* { return new Driver_Analog(id, n, t, p); }),
+    driverRow<Driver_Analog>("SOIL", DRV_INPUT | DRV_ANALOG, PINS_ADC, 0, [](const char* t, const char* id, const char* n, int p) -> Device* { return new Driver_Analog(id, n, t, p); }),
+    driverRow<Driver_Analog>("MQ2", DRV_INPUT | DRV_ANALOG, PINS_ADC, 0, [](const char* t, const char* id, const char* n, int p) -> Device* { return new Driver_Analog(id, n, t, p); }),
+    driverRow<Driver_DHT>("DHT22", DRV_INPUT, PINS_OUT, 0, [](const char*, const char* id, const char* n, int p) -> Device* { return new Driver_DHT(id, n, p, DHT22); }),
+    driverRow<Driver_DHT>("DHT11", DRV_INPUT, PINS_OUT, 0, [](const char*, const char* id, const char* n, int p) -> Device* { return new Driver_DHT(id, n, p, DHT11); }),
+    driverRow<Driver_Dallas>("DS18B20", DRV_INPUT, PINS_OUT, 0, makeDriver<Driver_Dallas>),
+    driverRow<Driver_Servo>("SERVO", DRV_OUTPUT, PINS_OUT, 0, makeDriver<Driver_Servo>),
+    driverRow<Driver_Neo>("NEOPIXEL", DRV_OUTPUT, PINS_OUT, 0, makeDriver<Driver_Neo>),
+
+    // I2C
+    driverRow<Driver_INA219>("INA219", DRV_INPUT | DRV_I2C, 0, 0x40, makeDriver<Driver_INA219>),
+    driverRow<Driver_BME280>("BME280", DRV_INPUT | DRV_I2C, 0, 0x76, makeDriver<Driver_BME280>),
+    driverRow<Driver_BH1750>("BH1750", DRV_INPUT | DRV_I2C, 0, 0x23, makeDriver<Driver_BH1750>),
+    driverRow<Driver_LCD>("LCD_I2C", DRV_TEXT | DRV_I2C, 0, 0x27, makeDriver<Driver_LCD>),
+    driverRow<Driver_OLED>("OLED", DRV_TEXT | DRV_I2C, 0, 0x3C, makeDriver<Driver_OLED>),
+};
+
+// Cohérence de la table, vérifiée à la compilation
+constexpr bool driverTableOk() {
+    for(const DriverDesc& a : DRIVERS) {
+        size_t len = 0;
+        while(a.type[len]) len++;
+        if(len >= OMNI_DRIVER_LEN) return false;                          // Tronqué dans Device::_driver
+        for(uint8_t c=0; c<a.nch; c++) {
+            size_t k = 0;
+            while(a.channels[c].key[k]) k++;
+            if(k >= OMNI_KEY_LEN) return false;                          // Tronquée dans DeviceSample::key
+        }
+        if(a.has(DRV_I2C) != (a.addr != 0) || a.has(DRV_I2C) == (a.pins != 0)) return false;
+        for(const DriverDesc& b : DRIVERS) if(&a != &b && a.hash == b.hash) return false;
+    }
+    return true;
+}
+static_assert(driverTableOk(), "Table des drivers : nom ou clé de canal trop long, broches/adresse incohérentes ou hash en double");
+
+inline const DriverDesc* findDriver(const char* type) {
+    if(!type) return nullptr;
+    uint32_t h = driverHash(type);
+    for(const DriverDesc& d : DRIVERS) if(d.hash == h && strcmp(d.type, type) == 0) return &d;
+    return nullptr;
+}
+
 // ==========================================
 // FACTORY
 // ==========================================
 class DeviceFactory {
 public:
-    static Device* create(String type, String id, String name, int pin) {
-        // Digital
-        if (type == "RELAY" || type == "VALVE" || type == "LOCK") return new Driver_Digital(id, name, type, pin, true, false);
-        if (type == "BUTTON" || type == "DOOR") return new Driver_Digital(id, name, type, pin, false, true);
-        if (type == "PIR") return new Driver_Digital(id, name, type, pin, false, false);
-        
-        // Analog / Specific
-        if (type == "LDR" || type == "SOIL" || type == "MQ2") return new Driver_Analog(id, name, type, pin);
-        if (type == "DHT22") return new Driver_DHT(id, name, pin, DHT22);
-        if (type == "DHT11") return new Driver_DHT(id, name, pin, DHT11);
-        if (type == "DS18B20") return new Driver_Dallas(id, name, pin);
-        if (type == "SERVO") return new Driver_Servo(id, name, pin);
-        if (type == "NEOPIXEL") return new Driver_Neo(id, name, pin, 16);
-
-        // I2C
-        if (type == "INA219") return new Driver_INA219(id, name, pin);
-        if (type == "BME280") return new Driver_BME280(id, name, pin);
-        if (type == "BH1750") return new Driver_BH1750(id, name, pin);
-        if (type == "LCD_I2C") return new Driver_LCD(id, name, pin);
-        if (type == "OLED") return new Driver_OLED(id, name, pin);
-
-        return nullptr;
+    static Device* create(const char* type, const char* id, const char* name, int pin) {
+        const DriverDesc* d = findDriver(type);
+        return d ? d->make(d->type, id, name, pin) : nullptr;
     }
 };
+
+// ==========================================
+// POOLS (DIMENSIONNÉS AU BOOT)
+// ==========================================
+#ifndef OMNI_POOL_SMALL
+#define OMNI_POOL_SMALL 24      // Blocs "drivers courants" réservés au boot
+#endif
+#ifndef OMNI_POOL_LARGE
+#define OMNI_POOL_LARGE 8       // Blocs "gros drivers" (DHT, DS18B20)
+#endif
+#ifndef OMNI_MAX_DISPLAYS
+#define OMNI_MAX_DISPLAYS 2     // Écrans OLED servis par le pool (framebuffer + image affichée)
+#endif
+#ifndef OMNI_LED_POOL
+#define OMNI_LED_POOL 2         // Rubans servis par le pool (OMNI_LED_BUF(OMNI_LED_MAX) octets chacun)
+#endif
+
+template<typename... T> constexpr size_t maxSizeof() {
+    size_t m = 0;
+    for(size_t s : {sizeof(T)...}) if(s > m) m = s;
+    return m;
+}
+
+// Petits blocs : drivers courants ; grands blocs : le plus gros driver de la table
+constexpr size_t OMNI_DEVICE_SMALL = maxSizeof<Driver_Digital, Driver_Pulse, Driver_Analog, Driver_DHTAdafruit, Driver_Servo,
+                                               Driver_Neo, Driver_INA219, Driver_BME280, Driver_BH1750, Driver_LCD, Driver_OLED>();
+constexpr size_t OMNI_DEVICE_LARGE = []{
+    size_t m = 0;
+    for(const DriverDesc& d : DRIVERS) if(d.size > m) m = d.size;
+    return m;
+}();
+static_assert(OMNI_DEVICE_LARGE >= OMNI_DEVICE_SMALL, "Classe large = plus gros driver");
+
+// A appeler au début de setup(), avant la première configuration ; au-delà : tas
+inline void beginDevicePools() {
+    if(!devicePool().begin(OMNI_DEVICE_SMALL, OMNI_POOL_SMALL, OMNI_DEVICE_LARGE, OMNI_POOL_LARGE)) Serial.println("Pool devices: allocation impossible");
+    if(!bufferPool().begin(OMNI_OLED_FB, 2 * OMNI_MAX_DISPLAYS)) Serial.println("Pool framebuffers: allocation impossible");
+    if(!ledPool().begin(OMNI_LED_BUF(OMNI_LED_MAX), OMNI_LED_POOL)) Serial.println("Pool rubans LED: allocation impossible");
+}
+
+// ==========================================
+// UTILS & SÉCURITÉ
+// ==========================================
+inline bool isKnownDriver(const char* type) { return findDriver(type) != nullptr; }
+
+inline bool isI2CDriver(const char* type) {
+    const DriverDesc* d = findDriver(type);
+    return d && d->has(DRV_I2C);
+}
+
+inline bool isOutputDevice(const char* type) {
+    const DriverDesc* d = findDriver(type);
+    return d && d->has(DRV_OUTPUT);
+}
+
+// I2C : adresse 7 bits ; GPIO : broche dans le masque du driver (existante, hors flash/UART0, sortie si besoin)
+inline bool isPinValid(int pin, const char* type) {
+    const DriverDesc* d = findDriver(type);
+    if(!d) return false;
+    if(d->has(DRV_I2C)) return pin >= OMNI_I2C_ADDR_MIN && pin <= OMNI_I2C_ADDR_MAX;
+    return pin >= 0 && pin < 64 && (d->pins >> pin & 1);
+}
+
+// Broche ADC2 demandée pour un driver analogique (refusée, message dédié)
+inline bool isADC2Pin(int pin, const char* type) {
+    const DriverDesc* d = findDriver(type);
+    return d && d->has(DRV_ANALOG) && pin >= 0 && pin < 64 && (PINS_ADC2 >> pin & 1);
+}
+
+// /api/drivers : capacités, canaux (unités) et contraintes de broches de chaque type
+inline void driversJson(Print& out) {
+    static const char* CAPS[] = { "input", "output", "i2c", "analog", "text" };
+    out.print("{\"drivers\":[");
+    for(const DriverDesc& d : DRIVERS) {
+        out.printf("%s{\"type\":\"%s\",\"caps\":[", &d == DRIVERS ? "" : ",", d.type);
+        bool first = true;
+        for(uint8_t c=0; c<5; c++) if(d.has(1 << c)) { out.printf("%s\"%s\"", first ? "" : ",", CAPS[c]); first = false; }
+        out.print("]");
+        out.print(",\"channels\":[");
+        for(uint8_t c=0; c<d.nch; c++) out.printf("%s{\"key\":\"%s\",\"unit\":\"%s\"}", c ? "," : "", d.channels[c].key, unitName(d.channels[c].unit));
+        out.print("]");
+        if(d.has(DRV_I2C)) out.printf(",\"addr\":{\"default\":%u,\"min\":%u,\"max\":%u}", d.addr, OMNI_I2C_ADDR_MIN, OMNI_I2C_ADDR_MAX);
+        else {
+            out.print(",\"pins\":[");
+            first = true;
+            for(uint8_t p=0; p<64; p++) if(d.pins >> p & 1) { out.printf("%s%u", first ? "" : ",", p); first = false; }
+            out.print("]");
+        }
+        out.printf(",\"size\":%u}", d.size);
+    }
+    out.print("]}");
+}
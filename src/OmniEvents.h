@@ -0,0 +1,146 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+
+// ==========================================
+// ENTRÉES SUR INTERRUPTION (FRONTS HORODATÉS)
+// ==========================================
+// L'ISR filtre les rebonds (verrouillage de `debounce` µs après un front
+// accepté) et dépose chaque changement de niveau horodaté dans un anneau lu
+// sans verrou par la tâche Sampler, qu'elle réveille. En mode comptage, seuls
+// les fronts montants sont comptés, avec la période du dernier intervalle.
+// Un front final perdu pendant le verrouillage est rattrapé par settle().
+
+#ifndef OMNI_DEBOUNCE_MS
+#define OMNI_DEBOUNCE_MS 20     // Anti-rebond par défaut des entrées (commande debounce)
+#endif
+#define OMNI_EDGE_RING 16       // Événements en attente (puissance de 2)
+#define OMNI_EDGE_HOLD 60       // ms d'affichage de chaque niveau rejoué (> intervalle min. de la télémétrie)
+
+struct EdgeEvent { uint32_t us; uint8_t level; };
+
+class EdgeInput {
+public:
+    enum Mode : uint8_t { EDGE_EVENTS, EDGE_COUNT };
+
+private:
+    EdgeEvent _ring[OMNI_EDGE_RING];
+    std::atomic<uint8_t> _head{0}, _tail{0};    // _head : producteurs (sous _lock), _tail : lecteur unique
+    portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+    int _pin = -1;
+    Mode _mode = EDGE_EVENTS;
+    volatile uint32_t _debounceUs = 0, _lastUs = 0, _periodUs = 0;
+    volatile uint8_t _level = 0;
+    std::atomic<uint32_t> _count{0}, _overruns{0};
+
+    static std::atomic<TaskHandle_t>& wakeSlot() {
+        static std::atomic<TaskHandle_t> t{nullptr};
+        return t;
+    }
+
+    // Sous _lock
+    void push(uint32_t us, uint8_t level) {
+        uint8_t h = _head.load(std::memory_order_relaxed);
+        if((uint8_t)(h - _tail.load(std::memory_order_acquire)) >= OMNI_EDGE_RING) { _overruns++; return; }
+        _ring[h % OMNI_EDGE_RING] = {us, level};
+        _head.store(h + 1, std::memory_order_release);
+    }
+
+    static void IRAM_ATTR onEdge(void* arg) { static_cast<EdgeInput*>(arg)->edge(); }
+
+    void IRAM_ATTR edge() {
+        uint32_t now = micros();
+        uint8_t lv = digitalRead(_pin);
+        portENTER_CRITICAL_ISR(&_lock);
+        if(_mode == EDGE_COUNT) {
+            if(lv && now - _lastUs >= _debounceUs) {
+                if(_count++) _periodUs = now - _lastUs;
+                _lastUs = now;
+            }
+            portEXIT_CRITICAL_ISR(&_lock);
+            return;
+        }
+        bool accept = lv != _level && now - _lastUs >= _debounceUs;
+        if(accept) {
+            _level = lv; _lastUs = now;
+            _count++;
+            push(now, lv);
+        }
+        portEXIT_CRITICAL_ISR(&_lock);
+        TaskHandle_t t = wakeSlot().load(std::memory_order_relaxed);
+        if(accept && t) {
+            BaseType_t woken = pdFALSE;
+            vTaskNotifyGiveFromISR(t, &woken);
+            if(woken) portYIELD_FROM_ISR();
+        }
+    }
+
+public:
+    ~EdgeInput() { end(); }
+
+    // Tâche réveillée à chaque événement accepté (Sampler)
+    static void wake(TaskHandle_t t) { wakeSlot() = t; }
+
+    // pinMode() déjà fait par le driver
+    void begin(int pin, Mode mode, uint32_t debounceUs) {
+        end();
+        _pin = pin; _mode = mode; _debounceUs = debounceUs;
+        _level = digitalRead(pin);
+        _lastUs = micros() - debounceUs;
+        attachInterruptArg(digitalPinToInterrupt(pin), onEdge, this, mode == EDGE_COUNT ? RISING : CHANGE);
+    }
+
+    void end() {
+        if(_pin < 0) return;
+        detachInterrupt(digitalPinToInterrupt(_pin));
+        _pin = -1;
+    }
+
+    void setDebounce(uint32_t us) { _debounceUs = us; }
+    uint32_t debounce() const { return _debounceUs; }
+
+    // Niveau stable différent du dernier accepté (front final tombé dans le verrouillage) : événement synthétisé
+    void settle() {
+        if(_pin < 0 || _mode != EDGE_EVENTS) return;
+        uint8_t lv = digitalRead(_pin);
+        uint32_t now = micros();
+        portENTER_CRITICAL(&_lock);
+        if(lv != _level && now - _lastUs >= _debounceUs) {
+            _level = lv; _lastUs = now;
+            _count++;
+            push(now, lv);
+        }
+        portEXIT_CRITICAL(&_lock);
+    }
+
+    // ms restantes avant que settle() puisse trancher (0 = hors verrouillage)
+    uint32_t settleIn() const {
+        uint32_t el = micros() - _lastUs;
+        return el >= _debounceUs ? 0 : (_debounceUs - el) / 1000 + 1;
+    }
+
+    bool pending() const { return _head.load(std::memory_order_acquire) != _tail.load(std::memory_order_relaxed); }
+
+    bool pop(EdgeEvent& e) {
+        uint8_t t = _tail.load(std::memory_order_relaxed);
+        if(t == _head.load(std::memory_order_acquire)) return false;
+        e = _ring[t % OMNI_EDGE_RING];
+        _tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Événements acceptés (EDGE_EVENTS) ou fronts montants comptés (EDGE_COUNT)
+    uint32_t count() const { return _count; }
+    void resetCount() { _count = 0; _periodUs = 0; }
+    uint32_t overruns() const { return _overruns; }
+
+    // Mode comptage : dernier front et période du dernier intervalle (0 = inconnue)
+    void lastPulse(uint32_t& us, uint32_t& periodUs) {
+        portENTER_CRITICAL(&_lock);
+        us = _lastUs; periodUs = _periodUs;
+        portEXIT_CRITICAL(&_lock);
+    }
+
+    // millis() correspondant à un horodatage micros() récent
+    static uint32_t toMillis(uint32_t us) { return millis() - (micros() - us) / 1000; }
+};
@@ -0,0 +1,256 @@
+#pragma once
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <memory>
+#include "OmniSampler.h"
+
+// ==========================================
+// HISTORIQUE (RING BUFFERS MULTI-RÉSOLUTION)
+// ==========================================
+// Par canal : points bruts + agrégats 1 min et 15 min (min/avg/max).
+// Mémoire fixe réservée au boot (PSRAM si présente), découpée en un bloc par
+// canal configuré : la profondeur des anneaux est calculée pour que tous les
+// canaux de la configuration y tiennent. Horodatage = secondes depuis le boot.
+
+#ifndef OMNI_HISTORY_PSRAM_BUDGET
+#define OMNI_HISTORY_PSRAM_BUDGET (1024 * 1024)
+#endif
+#ifndef OMNI_HISTORY_HEAP_BUDGET
+#define OMNI_HISTORY_HEAP_BUDGET (24 * 1024)
+#endif
+#define OMNI_HISTORY_RAW_KEEPALIVE 10   // Un point brut au moins toutes les 10 s même sans changement
+
+enum HistoryRes : uint8_t { RES_RAW, RES_1M, RES_15M };
+
+struct HistPoint { uint32_t t; float min, avg, max; };   // Brut : min = avg = max
+
+class History {
+    struct Ring {
+        HistPoint* buf; uint16_t cap, len; uint32_t total;   // total = nombre de points jamais poussés
+        void push(const HistPoint& p) { buf[total % cap] = p; total++; if(len < cap) len++; }
+        uint32_t oldest() const { return total - len; }
+        const HistPoint& at(uint32_t seq) const { return buf[seq % cap]; }
+    };
+    struct Accum {
+        uint32_t start; float min, max, sum; uint16_t n;
+        void add(float v) { if(!n) { min = max = v; sum = 0; } min = fminf(min, v); max = fmaxf(max, v); sum += v; n++; }
+        HistPoint point() const { return {start, min, sum / n, max}; }
+    };
+    struct Channel { Ring ring[3]; Accum a1, a15; float lastRaw; uint32_t lastRawT; };
+
+    uint8_t* _arena = nullptr;
+    size_t _size = 0, _used = 0;
+    uint16_t _cap[3] = {0};
+    const uint16_t* _maxCap = nullptr;      // Profondeurs visées (anneaux réduits s'il y a beaucoup de canaux)
+    Channel* _ch[OMNI_MAX_DEVICES][OMNI_MAX_CHANNELS];
+    uint32_t _gen = 0;
+    mutable portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+
+    static size_t blockSize(const uint16_t* cap) { return (sizeof(Channel) + (cap[0] + cap[1] + cap[2]) * sizeof(HistPoint) + 3) & ~3; }
+    size_t blockSize() const { return blockSize(_cap); }
+
+    // Profondeurs pour que `n` canaux se partagent l'arène (au moins un quart des profondeurs visées)
+    void plan(size_t n, uint16_t* cap) const {
+        size_t per = _size / max(n, (size_t)1);
+        size_t pts = per > sizeof(Channel) + 3 ? (per - sizeof(Channel) - 3) / sizeof(HistPoint) : 0;
+        size_t full = _maxCap[0] + _maxCap[1] + _maxCap[2];
+        for(int r=0; r<3; r++) cap[r] = pts >= full ? _maxCap[r] : max(_maxCap[r] * pts / full, (size_t)_maxCap[r] / 4);
+    }
+
+    Channel* alloc() {
+        size_t need = blockSize();
+        if(!_arena || _used + need > _size) return nullptr;
+        Channel* c = (Channel*)(_arena + _used);
+        HistPoint* p = (HistPoint*)(c + 1);
+        memset(c, 0, sizeof(Channel));
+        for(int r=0; r<3; r++) { c->ring[r].buf = p; c->ring[r].cap = _cap[r]; p += _cap[r]; }
+        _used += need;
+        return c;
+    }
+
+public:
+    bool psram = false;
+
+    History() { memset(_ch, 0, sizeof(_ch)); }
+
+    // Avant le chargement de la config
+    void begin() {
+        static const uint16_t PSRAM_CAP[3] = { 256, 720, 672 };    // ~4 min+ / 12 h / 7 j
+        static const uint16_t HEAP_CAP[3]  = { 32, 60, 48 };       // ~5 min+ / 1 h / 12 h
+        psram = psramFound();
+        if(psram) { _size = OMNI_HISTORY_PSRAM_BUDGET; _arena = (uint8_t*)ps_malloc(_size); }
+        if(!_arena) { psram = false; _size = OMNI_HISTORY_HEAP_BUDGET; _arena = (uint8_t*)malloc(_size); }
+        _maxCap = psram ? PSRAM_CAP : HEAP_CAP;
+        memcpy(_cap, _maxCap, sizeof(_cap));
+    }
+
+    // Configuration appliquée (sous mutex) : un bloc réservé pour chaque canal des devices.
+    // Si l'arène ne peut plus les loger (canaux ajoutés, blocs des slots retirés jamais
+    // repris), elle est compactée par reset() : profondeurs recalculées, historique perdu.
+    void fit(const DeviceRegistry& reg) {
+        uint8_t want[OMNI_MAX_DEVICES];
+        size_t total = 0;
+        for(size_t slot=0; slot<OMNI_MAX_DEVICES; slot++) {
+            const ::Channel* list;
+            Device* d = reg[slot];
+            want[slot] = d ? min(d->channels(list), (uint8_t)OMNI_MAX_CHANNELS) : 0;
+            total += want[slot];
+        }
+        size_t have = 0, missing = 0;
+        uint16_t cap[3];
+        portENTER_CRITICAL(&_lock);
+        for(size_t slot=0; slot<OMNI_MAX_DEVICES; slot++)
+            for(uint8_t c=0; c<want[slot]; c++) (_ch[slot][c] ? have : missing)++;
+        bool compact = false;
+        if(_arena && missing) {
+            plan(total, cap);
+            size_t fits = have + min(missing, (_size - _used) / blockSize());
+            compact = !_used || fits < min(total, _size / blockSize(cap));
+        }
+        portEXIT_CRITICAL(&_lock);
+        if(compact) reset(total);
+
+        portENTER_CRITICAL(&_lock);
+        for(size_t slot=0; slot<OMNI_MAX_DEVICES; slot++)
+            for(uint8_t c=0; c<want[slot]; c++) if(!_ch[slot][c]) _ch[slot][c] = alloc();
+        portEXIT_CRITICAL(&_lock);
+    }
+
+    // false : le canal n'a pas de bloc et l'arène est pleine (rien n'est enregistré)
+    bool has(size_t slot, uint8_t ch) const {
+        if(slot >= OMNI_MAX_DEVICES || ch >= OMNI_MAX_CHANNELS) return false;
+        portENTER_CRITICAL(&_lock);
+        bool ok = _ch[slot][ch] || (_arena && _used + blockSize() <= _size);
+        portEXIT_CRITICAL(&_lock);
+        return ok;
+    }
+
+    uint16_t depth(HistoryRes res) const { return _cap[res]; }
+
+    // Arène vidée, anneaux dimensionnés pour `channels` canaux
+    void reset(size_t channels) {
+        portENTER_CRITICAL(&_lock);
+        memset(_ch, 0, sizeof(_ch));
+        plan(channels, _cap);
+        _used = 0; _gen++;
+        portEXIT_CRITICAL(&_lock);
+    }
+
+    // Slot remplacé ou retiré : ses canaux repartent vides (mémoire de l'arène conservée)
+    void clear(size_t slot) {
+        if(slot >= OMNI_MAX_DEVICES) return;
+        portENTER_CRITICAL(&_lock);
+        for(Channel* ch : _ch[slot]) {
+            if(!ch) continue;
+            for(Ring& r : ch->ring) r.len = r.total = 0;
+            ch->a1.n = ch->a15.n = 0;
+        }
+        _gen++;
+        portEXIT_CRITICAL(&_lock);
+    }
+
+    // Appelé par la tâche Sampler à chaque échantillon publié
+    void record(size_t slot, const DeviceSample& s) {
+        if(slot >= OMNI_MAX_DEVICES || !s.stamp) return;
+        uint32_t t = s.stamp / 1000;
+        portENTER_CRITICAL(&_lock);
+        for(uint8_t c=0; c<s.nch; c++) {
+            float v = s.val[c];
+            if(isnan(v)) continue;
+            Channel* ch = _ch[slot][c];
+            if(!ch) { ch = _ch[slot][c] = alloc(); if(!ch) continue; }
+
+            if(!ch->ring[RES_RAW].total || v != ch->lastRaw || t - ch->lastRawT >= OMNI_HISTORY_RAW_KEEPALIVE) {
+                ch->ring[RES_RAW].push({t, v, v, v});
+                ch->lastRaw = v; ch->lastRawT = t;
+            }
+
+            uint32_t b1 = t - t % 60;
+            if(ch->a1.n && ch->a1.start != b1) {
+                HistPoint p = ch->a1.point();
+                ch->ring[RES_1M].push(p);
+                ch->a1.n = 0;
+                uint32_t b15 = p.t - p.t % 900;
+                if(ch->a15.n && ch->a15.start != b15) { ch->ring[RES_15M].push(ch->a15.point()); ch->a15.n = 0; }
+                if(!ch->a15.n) ch->a15.start = b15;
+                // L'agrégat 15 min est construit à partir des minutes (min/max exacts, moyenne pondérée à la minute)
+                ch->a15.add(p.avg); ch->a15.min = fminf(ch->a15.min, p.min); ch->a15.max = fmaxf(ch->a15.max, p.max);
+            }
+            if(!ch->a1.n) ch->a1.start = b1;
+            ch->a1.add(v);
+        }
+        portEXIT_CRITICAL(&_lock);
+    }
+
+    static bool parseRes(const String& r, HistoryRes& out) {
+        if(r == "" || r == "raw") { out = RES_RAW; return true; }
+        if(r == "1m") { out = RES_1M; return true; }
+        if(r == "15m") { out = RES_15M; return true; }
+        return false;
+    }
+
+    // Curseur de lecture : copie au plus `max` points à partir de `seq` (lecture courte sous verrou)
+    struct Cursor { uint8_t slot, ch; HistoryRes res; uint32_t seq, gen; bool started; };
+
+    void open(Cursor& cur, uint32_t from) const {
+        portENTER_CRITICAL(&_lock);
+        cur.gen = _gen;
+        cur.seq = 0;
+        const Channel* ch = _ch[cur.slot][cur.ch];
+        if(ch) {
+            const Ring& r = ch->ring[cur.res];
+            uint32_t lo = r.oldest(), hi = r.total;
+            while(lo < hi) { uint32_t mid = lo + (hi - lo) / 2; if(r.at(mid).t < from) lo = mid + 1; else hi = mid; }
+            cur.seq = lo;
+        }
+        portEXIT_CRITICAL(&_lock);
+    }
+
+    size_t next(Cursor& cur, HistPoint* out, size_t max) const {
+        size_t n = 0;
+        portENTER_CRITICAL(&_lock);
+        const Channel* ch = _ch[cur.slot][cur.ch];
+        if(ch && cur.gen == _gen) {
+            const Ring& r = ch->ring[cur.res];
+            if(cur.seq < r.oldest()) cur.seq = r.oldest();   // Points écrasés pendant la lecture
+            while(n < max && cur.seq < r.total) out[n++] = r.at(cur.seq++);
+        }
+        portEXIT_CRITICAL(&_lock);
+        return n;
+    }
+
+    // Réponse chunked : chaque appel du filler ne formate que ce qui tient dans le segment TCP
+    AsyncWebServerResponse* stream(AsyncWebServerRequest* req, const char* id, const char* key,
+                                   uint8_t slot, uint8_t ch, HistoryRes res, uint32_t from) const {
+        struct State { Cursor cur; char pend[96]; size_t len, off; HistPoint pts[8]; size_t n, i; uint8_t phase; };
+        std::shared_ptr<State> st(new State());
+        st->cur = {slot, ch, res, 0, 0, false};
+        open(st->cur, from);
+        static const char* resNames[] = {"raw", "1m", "15m"};
+        st->len = snprintf(st->pend, sizeof(st->pend), "{\"id\":\"%s\",\"ch\":\"%s\",\"res\":\"%s\",\"now\":%u,\"points\":[",
+                           id, key, resNames[res], (unsigned)(millis() / 1000));
+        if(st->len >= sizeof(st->pend)) st->len = sizeof(st->pend) - 1;
+
+        return req->beginChunkedResponse("application/json", [this, st](uint8_t* buf, size_t maxLen, size_t index) -> size_t {
+            size_t w = 0;
+            while(w < maxLen) {
+                if(st->off < st->len) {
+                    size_t k = min(maxLen - w, st->len - st->off);
+                    memcpy(buf + w, st->pend + st->off, k);
+                    w += k; st->off += k;
+                    continue;
+                }
+                if(st->phase == 2) break;
+                if(st->i >= st->n) { st->n = next(st->cur, st->pts, 8); st->i = 0; }
+                st->off = 0;
+                if(st->n == 0) { st->len = snprintf(st->pend, sizeof(st->pend), "]}"); st->phase = 2; continue; }
+                const HistPoint& p = st->pts[st->i++];
+                const char* sep = st->cur.started ? "," : "";
+                st->cur.started = true;
+                if(st->cur.res == RES_RAW) st->len = snprintf(st->pend, sizeof(st->pend), "%s[%u,%g]", sep, (unsigned)p.t, p.avg);
+                else st->len = snprintf(st->pend, sizeof(st->pend), "%s[%u,%g,%g,%g]", sep, (unsigned)p.t, p.min, p.avg, p.max);
+            }
+            return w;
+        });
+    }
+};
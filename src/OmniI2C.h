@@ -0,0 +1,218 @@
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+#include <atomic>
+#include "OmniMetrics.h"
+
+// ==========================================
+// GESTIONNAIRE DU BUS I2C (TÂCHE DÉDIÉE)
+// ==========================================
+// Une seule tâche possède Wire. Les drivers déposent des transactions
+// (écriture du pointeur de registre + lecture en rafale en repeated start) ou
+// des travaux "bibliothèque" dans trois files de priorité ; le résultat revient
+// par callback, exécuté dans la tâche bus. Chaque réveil vide les files,
+// priorité haute d'abord.
+
+#ifndef OMNI_I2C_HZ
+#define OMNI_I2C_HZ 100000      // 100000, 400000 ou 1000000 (modifiable via /api/i2c)
+#endif
+#define OMNI_I2C_QUEUE 16       // Requêtes en attente par priorité
+#define OMNI_I2C_TX 8
+#define OMNI_I2C_RX 32
+
+enum I2CPriority : uint8_t { I2C_HIGH, I2C_NORMAL, I2C_LOW, I2C_PRIOS };
+
+// err : code de Wire.endTransmission() (0 = OK, 2 = NACK adresse...), 5 = lecture incomplète
+typedef void (*I2CDone)(void* ctx, uint8_t err, const uint8_t* rx, uint8_t len);
+typedef void (*I2CJob)(void* ctx);
+
+struct I2CRequest {
+    I2CJob job = nullptr;       // Non nul : code bibliothèque exécuté tel quel dans la tâche bus
+    I2CDone done = nullptr;     // Transaction brute : résultat (peut être nul)
+    void* ctx = nullptr;
+    uint8_t addr = 0, txLen = 0, rxLen = 0;
+    uint8_t tx[OMNI_I2C_TX];
+    uint32_t queued = 0;        // micros() au dépôt
+};
+
+class I2CManager {
+    struct Ring { I2CRequest q[OMNI_I2C_QUEUE]; uint8_t head = 0, count = 0; };
+    struct SyncCall { I2CJob job; void* ctx; SemaphoreHandle_t done; };
+    struct Xfer { uint8_t addr; const uint8_t* tx; uint8_t txLen; uint8_t* rx; uint8_t rxLen; uint8_t err; };
+
+    Ring _rings[I2C_PRIOS];
+    portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+    TaskHandle_t _task = nullptr;
+    SemaphoreHandle_t _syncLock = nullptr, _syncDone = nullptr;
+    void* volatile _running = nullptr;  // ctx de la requête en cours d'exécution
+    std::atomic<uint32_t> _hz{OMNI_I2C_HZ};
+    uint8_t _rx[OMNI_I2C_RX];
+
+    static void taskEntry(void* arg) { static_cast<I2CManager*>(arg)->run(); }
+
+    // Écriture puis lecture sans STOP intermédiaire ; nombre d'octets lus dans `got`
+    static uint8_t perform(uint8_t addr, const uint8_t* tx, uint8_t txLen, uint8_t* rx, uint8_t rxLen, uint8_t& got) {
+        got = 0;
+        if(txLen || !rxLen) {
+            Wire.beginTransmission(addr);
+            if(txLen) Wire.write(tx, txLen);
+            uint8_t err = Wire.endTransmission(rxLen == 0);
+            if(err) return err;
+        }
+        if(!rxLen) return 0;
+        size_t n = Wire.requestFrom((int)addr, (int)rxLen);
+        while(got < n && Wire.available()) rx[got++] = Wire.read();
+        return got < rxLen ? 5 : 0;
+    }
+
+    static void syncJob(void* arg) {
+        SyncCall* c = (SyncCall*)arg;
+        c->job(c->ctx);
+        xSemaphoreGive(c->done);
+    }
+
+    static void xferJob(void* arg) {
+        Xfer* x = (Xfer*)arg;
+        uint8_t got;
+        x->err = perform(x->addr, x->tx, x->txLen, x->rx, x->rxLen, got);
+    }
+
+    bool pop(I2CRequest& r) {
+        portENTER_CRITICAL(&_lock);
+        for(Ring& g : _rings) {
+            if(!g.count) continue;
+            r = g.q[g.head];
+            g.head = (g.head + 1) % OMNI_I2C_QUEUE;
+            g.count--;
+            _running = r.ctx;
+            portEXIT_CRITICAL(&_lock);
+            return true;
+        }
+        _running = nullptr;
+        portEXIT_CRITICAL(&_lock);
+        return false;
+    }
+
+    void execute(I2CRequest& r) {
+        uint32_t t0 = micros();
+        metrics().record(Metrics::H_I2C_WAIT, t0 - r.queued);
+        if(r.job) r.job(r.ctx);
+        else {
+            uint8_t got;
+            uint8_t err = perform(r.addr, r.tx, r.txLen, _rx, min<uint8_t>(r.rxLen, OMNI_I2C_RX), got);
+            transactions++;
+            if(err && (r.txLen || r.rxLen)) errors++;     // Une sonde sans réponse n'est pas une erreur
+            if(r.done) r.done(r.ctx, err, _rx, got);
+        }
+        metrics().record(Metrics::H_I2C_BUSY, micros() - t0);
+    }
+
+    void run() {
+        I2CRequest r;
+        for(;;) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            while(pop(r)) execute(r);
+        }
+    }
+
+public:
+    std::atomic<uint32_t> transactions{0}, errors{0}, dropped{0};
+
+    // A appeler avant le premier begin() de driver : les requêtes antérieures s'exécutent en ligne
+    void begin() {
+        Wire.begin();
+        Wire.setClock(_hz);
+        _syncLock = xSemaphoreCreateMutex();
+        _syncDone = xSemaphoreCreateBinary();
+        xTaskCreatePinnedToCore(taskEntry, "i2c", 4096, this, 2, &_task, 1);
+    }
+
+    uint32_t clock() const { return _hz; }
+
+    // 100 kHz (standard), 400 kHz (fast) ou 1 MHz (fast plus)
+    bool setClock(uint32_t hz) {
+        if(hz != 100000 && hz != 400000 && hz != 1000000) return false;
+        _hz = hz;
+        exec([](void* arg) { Wire.setClock(*(uint32_t*)arg); }, &hz);
+        return true;
+    }
+
+    // false si la file de cette priorité est pleine (requête abandonnée)
+    bool submit(const I2CRequest& r, I2CPriority prio = I2C_NORMAL) {
+        if(!_task) { I2CRequest c = r; c.queued = micros(); execute(c); return true; }
+        Ring& g = _rings[min<uint8_t>(prio, I2C_LOW)];
+        portENTER_CRITICAL(&_lock);
+        bool ok = g.count < OMNI_I2C_QUEUE;
+        if(ok) {
+            I2CRequest& slot = g.q[(g.head + g.count) % OMNI_I2C_QUEUE];
+            slot = r;
+            slot.queued = micros();
+            g.count++;
+        }
+        portEXIT_CRITICAL(&_lock);
+        if(!ok) { dropped++; return false; }
+        xTaskNotifyGive(_task);
+        return true;
+    }
+
+    // Lecture en rafale de `len` registres à partir de `reg`
+    bool readRegs(uint8_t addr, uint8_t reg, uint8_t len, I2CDone done, void* ctx, I2CPriority prio = I2C_NORMAL) {
+        I2CRequest r;
+        r.addr = addr; r.tx[0] = reg; r.txLen = 1; r.rxLen = len;
+        r.done = done; r.ctx = ctx;
+        return submit(r, prio);
+    }
+
+    bool job(I2CJob fn, void* ctx, I2CPriority prio = I2C_NORMAL) {
+        I2CRequest r;
+        r.job = fn; r.ctx = ctx;
+        return submit(r, prio);
+    }
+
+    // Exécute `fn` dans la tâche bus et attend la fin (en ligne si déjà dans la tâche bus)
+    void exec(I2CJob fn, void* ctx) {
+        if(!_task || xTaskGetCurrentTaskHandle() == _task) { fn(ctx); return; }
+        xSemaphoreTake(_syncLock, portMAX_DELAY);
+        SyncCall c = {fn, ctx, _syncDone};
+        while(!job(syncJob, &c, I2C_HIGH)) vTaskDelay(1);
+        xSemaphoreTake(_syncDone, portMAX_DELAY);
+        xSemaphoreGive(_syncLock);
+    }
+
+    // Transaction synchrone (initialisation des drivers) ; code d'erreur Wire
+    uint8_t transfer(uint8_t addr, const uint8_t* tx, uint8_t txLen, uint8_t* rx = nullptr, uint8_t rxLen = 0) {
+        Xfer x = {addr, tx, txLen, rx, rxLen, 0};
+        exec(xferJob, &x);
+        return x.err;
+    }
+
+    // Retire les requêtes de `ctx` et attend celle en cours : plus aucun callback après le retour
+    void cancel(void* ctx) {
+        portENTER_CRITICAL(&_lock);
+        for(Ring& g : _rings) {
+            uint8_t kept = 0;
+            for(uint8_t i=0; i<g.count; i++) {
+                I2CRequest& r = g.q[(g.head + i) % OMNI_I2C_QUEUE];
+                if(r.ctx != ctx) g.q[(g.head + kept++) % OMNI_I2C_QUEUE] = r;
+            }
+            g.count = kept;
+        }
+        portEXIT_CRITICAL(&_lock);
+        if(xTaskGetCurrentTaskHandle() == _task) return;
+        while(_running == ctx) vTaskDelay(1);
+    }
+
+    size_t pending() {
+        portENTER_CRITICAL(&_lock);
+        size_t n = 0;
+        for(Ring& g : _rings) n += g.count;
+        portEXIT_CRITICAL(&_lock);
+        return n;
+    }
+};
+
+// Instance unique (drivers I2C, scanner, API)
+inline I2CManager& i2cBus() {
+    static I2CManager m;
+    return m;
+}
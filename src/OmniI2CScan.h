@@ -0,0 +1,149 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include "OmniI2C.h"
+
+// ==========================================
+// SCAN I2C EN TÂCHE DE FOND
+// ==========================================
+// Une sonde d'adresse (START + adresse + STOP) par requête, en priorité basse :
+// les transactions des drivers passent entre deux sondes. Le dernier résultat
+// complet reste en cache ; la progression est publiée pour le WebSocket.
+
+// Composants connus par plage d'adresses, les parts gérés par OmniESP d'abord
+struct I2CHint { uint8_t lo, hi; const char* part; };
+
+static const I2CHint I2C_HINTS[] = {
+    {0x27, 0x27, "LCD 1602"},   {0x3F, 0x3F, "LCD 1602"},   {0x3C, 0x3D, "OLED SSD1306"},
+    {0x40, 0x4F, "INA219 Power"}, {0x76, 0x77, "BME280"},   {0x23, 0x23, "BH1750"},     {0x5C, 0x5C, "BH1750"},
+    {0x20, 0x27, "PCF8574"},    {0x38, 0x3F, "PCF8574A"},   {0x20, 0x27, "MCP23017"},   {0x3C, 0x3D, "SH1106"},
+    {0x76, 0x77, "BMP280"},     {0x76, 0x77, "BME680"},     {0x77, 0x77, "BMP180"},     {0x76, 0x77, "MS5611"},
+    {0x29, 0x29, "VL53L0X"},    {0x29, 0x29, "TSL2591"},    {0x29, 0x29, "TCS34725"},   {0x39, 0x39, "TSL2561"},
+    {0x39, 0x39, "APDS-9960"},  {0x38, 0x38, "AHT20"},      {0x40, 0x40, "SHT21/HTU21D"}, {0x40, 0x40, "HDC1080"},
+    {0x40, 0x7F, "PCA9685"},    {0x44, 0x45, "SHT3x"},      {0x48, 0x4B, "ADS1115"},    {0x48, 0x4F, "LM75/TMP102"},
+    {0x48, 0x4F, "PCF8591"},    {0x50, 0x57, "EEPROM 24Cxx"}, {0x53, 0x53, "ADXL345"},  {0x57, 0x57, "MAX30102"},
+    {0x5A, 0x5A, "MLX90614"},   {0x5A, 0x5B, "CCS811"},     {0x5C, 0x5C, "AM2320"},     {0x62, 0x62, "SCD4x"},
+    {0x68, 0x68, "DS3231/DS1307"}, {0x68, 0x69, "MPU6050"}, {0x70, 0x77, "TCA9548A"},   {0x70, 0x77, "HT16K33"},
+};
+
+// Appelle fn(part) pour chaque candidat de `addr` ; nombre de candidats
+template<typename Fn>
+inline size_t i2cHints(uint8_t addr, Fn fn) {
+    size_t n = 0;
+    for(const I2CHint& h : I2C_HINTS) if(addr >= h.lo && addr <= h.hi) { fn(h.part); n++; }
+    return n;
+}
+
+#define OMNI_I2C_SCAN_FIRST 0x01
+#define OMNI_I2C_SCAN_LAST 0x7E
+
+class I2CScanJob {
+    uint8_t _found[16] = {0}, _result[16] = {0};   // Bit n = adresse n (scan en cours / dernier complet)
+    uint16_t _job = 0, _resultJob = 0;
+    uint8_t _addr = 0;
+    uint32_t _doneAt = 0;
+    std::atomic<bool> _running{false}, _inflight{false}, _progress{false};
+    portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+
+    // Une seule sonde en vol : loop() (relance) et la tâche bus (chaînage) peuvent se croiser
+    void probe() {
+        if(_inflight.exchange(true)) return;
+        I2CRequest r;
+        r.addr = _addr; r.done = onProbe; r.ctx = this;
+        if(!i2cBus().submit(r, I2C_LOW)) _inflight = false;    // File pleine : poll() relance
+    }
+
+    // Tâche bus : résultat d'une sonde, puis la suivante
+    static void onProbe(void* ctx, uint8_t err, const uint8_t* rx, uint8_t len) {
+        I2CScanJob* self = (I2CScanJob*)ctx;
+        uint8_t a = self->_addr;
+        portENTER_CRITICAL(&self->_lock);
+        if(!err) self->_found[a / 8] |= 1 << (a % 8);
+        bool last = a >= OMNI_I2C_SCAN_LAST;
+        if(last) {
+            memcpy(self->_result, self->_found, sizeof(self->_result));
+            self->_resultJob = self->_job;
+            self->_doneAt = millis();
+        }
+        self->_addr = a + 1;
+        portEXIT_CRITICAL(&self->_lock);
+        if(last || (a & 0x0F) == 0x0F || !err) self->_progress = true;
+        self->_inflight = false;
+        if(last) self->_running = false;
+        else self->probe();
+    }
+
+    static uint8_t percent(uint8_t addr, bool run) {
+        return run ? (addr - OMNI_I2C_SCAN_FIRST) * 100 / (OMNI_I2C_SCAN_LAST - OMNI_I2C_SCAN_FIRST + 1) : 100;
+    }
+
+    static void appendAddrs(String& out, const uint8_t* bits) {
+        bool first = true;
+        for(uint8_t a=OMNI_I2C_SCAN_FIRST; a<=OMNI_I2C_SCAN_LAST; a++) {
+            if(!(bits[a / 8] & (1 << (a % 8)))) continue;
+            char hex[8]; snprintf(hex, sizeof(hex), "%s\"0x%02X\"", first ? "" : ",", a);
+            out += hex;
+            first = false;
+        }
+    }
+
+public:
+    // Lance un scan (ou renvoie celui en cours) ; identifiant du job
+    uint16_t start() {
+        if(_running.exchange(true)) return _job;
+        portENTER_CRITICAL(&_lock);
+        memset(_found, 0, sizeof(_found));
+        _addr = OMNI_I2C_SCAN_FIRST;
+        uint16_t job = ++_job;
+        portEXIT_CRITICAL(&_lock);
+        _progress = true;
+        probe();
+        return job;
+    }
+
+    bool running() const { return _running; }
+    bool hasResult() const { return _resultJob != 0; }
+
+    // loop() : relance une sonde refusée (file pleine) ; message de progression à pousser
+    bool poll(String& out) {
+        if(_running && !_inflight) probe();
+        if(!_progress.exchange(false)) return false;
+        portENTER_CRITICAL(&_lock);
+        uint16_t job = _job; uint8_t addr = _addr, found[16];
+        memcpy(found, _found, sizeof(found));
+        portEXIT_CRITICAL(&_lock);
+        bool run = _running;
+        uint8_t pct = percent(addr, run);
+        out = "{\"scan\":{\"job\":" + String(job) + ",\"state\":\"" + (run ? "running" : "done") + "\",\"progress\":" + String(pct) + ",\"found\":[";
+        appendAddrs(out, found);
+        out += "]}}";
+        return true;
+    }
+
+    // Réponse de /api/scan : état du job courant + dernier résultat complet avec les candidats
+    void json(Print& out) {
+        portENTER_CRITICAL(&_lock);
+        uint16_t job = _job, resultJob = _resultJob; uint8_t addr = _addr, result[16];
+        uint32_t doneAt = _doneAt;
+        memcpy(result, _result, sizeof(result));
+        portEXIT_CRITICAL(&_lock);
+        bool run = _running;
+        uint8_t pct = percent(addr, run);
+        out.printf("{\"job\":%u,\"state\":\"%s\",\"progress\":%u,\"result_job\":%u,\"age\":%ld,\"i2c_devices\":[",
+                   (unsigned)job, run ? "running" : "done", (unsigned)pct, (unsigned)resultJob,
+                   resultJob ? (long)((millis() - doneAt) / 1000) : -1L);
+        bool first = true;
+        for(uint8_t a=OMNI_I2C_SCAN_FIRST; a<=OMNI_I2C_SCAN_LAST; a++) {
+            if(!(result[a / 8] & (1 << (a % 8)))) continue;
+            const char* hint = nullptr;
+            i2cHints(a, [&](const char* p) { if(!hint) hint = p; });
+            if(!hint) hint = "Unknown";
+            out.printf("%s{\"addr_dec\":%u,\"addr_hex\":\"0x%02X\",\"hint\":\"%s\",\"parts\":[", first ? "" : ",", a, a, hint);
+            bool firstPart = true;
+            i2cHints(a, [&](const char* p) { out.printf("%s\"%s\"", firstPart ? "" : ",", p); firstPart = false; });
+            out.print("]}");
+            first = false;
+        }
+        out.print("]}");
+    }
+};
@@ -0,0 +1,292 @@
+#pragma once
+#include <Arduino.h>
+#include <driver/rmt.h>
+#include <Adafruit_NeoPixel.h>
+#include "OmniPool.h"
+
+// ==========================================
+// RUBANS LED (EFFETS + ÉMISSION RMT)
+// ==========================================
+// Chaque ruban garde un tampon RGB par pixel, recalculé par son effet à
+// cadence fixe (tâche "leds", OMNI_LED_FPS images/s), puis encodé dans
+// l'ordre de couleurs du ruban (luminosité, gamma, blanc extrait en RGBW).
+// La trame part sur un canal RMT : l'émission se fait sans le CPU et l'appel
+// rend la main aussitôt ; une image dont le canal émet encore est sautée.
+// write() ne change que les paramètres de l'effet : ni calcul ni émission
+// sous le mutex global.
+
+#ifndef OMNI_LED_FPS
+#define OMNI_LED_FPS 50
+#endif
+#define OMNI_LED_MAX 300        // Pixels par ruban (trame de 9 ms à 800 kHz)
+#define OMNI_LED_BUF(n) ((n) * 7)   // Tampon d'un ruban : RGB + trame RGBW au pire
+#define OMNI_LED_DEFAULT 16
+#ifndef OMNI_LED_STRIPS
+#define OMNI_LED_STRIPS 4       // Canaux RMT réservés aux rubans (0 .. N-1)
+#endif
+
+enum LedEffect : uint8_t { FX_SOLID, FX_GRADIENT, FX_CHASE, FX_FADE, FX_RAINBOW, FX_COUNT };
+
+inline const char* ledEffectName(uint8_t fx) {
+    static const char* NAMES[FX_COUNT] = { "solid", "gradient", "chase", "fade", "rainbow" };
+    return fx < FX_COUNT ? NAMES[fx] : "";
+}
+
+// -1 si inconnu
+inline int8_t ledEffect(const char* name) {
+    for(uint8_t i=0; i<FX_COUNT; i++) if(strcasecmp(name, ledEffectName(i)) == 0) return i;
+    return -1;
+}
+
+// Position de chaque composante dans un pixel sur le fil
+struct LedOrder { const char* name; uint8_t r, g, b, w, bpp; };
+
+constexpr LedOrder LED_ORDERS[] = {
+    { "GRB", 1, 0, 2, 0, 3 }, { "RGB", 0, 1, 2, 0, 3 }, { "BRG", 1, 2, 0, 0, 3 }, { "RBG", 0, 2, 1, 0, 3 },
+    { "GBR", 2, 0, 1, 0, 3 }, { "BGR", 2, 1, 0, 0, 3 }, { "GRBW", 1, 0, 2, 3, 4 }, { "RGBW", 0, 1, 2, 3, 4 },
+};
+
+// nullptr si inconnu
+inline const LedOrder* ledOrder(const char* name) {
+    for(const LedOrder& o : LED_ORDERS) if(strcasecmp(name, o.name) == 0) return &o;
+    return nullptr;
+}
+
+struct LedParams {
+    uint8_t fx = FX_SOLID;
+    uint16_t hue = 0, hue2 = 21845;     // Teintes 0..65535 (hue2 : fin du dégradé)
+    uint8_t sat = 255;
+    uint8_t bright = 128;
+    uint16_t period = 2000;             // Cycle d'un effet animé (ms)
+    bool on = false;
+};
+
+class LedStrip;
+
+class LedEngine {
+    SemaphoreHandle_t _lock = nullptr;
+    TaskHandle_t _task = nullptr;
+    LedStrip* _head = nullptr;
+    uint8_t _channels = 0;              // Canaux RMT attribués (bit = canal)
+
+    static void taskEntry(void* arg) { static_cast<LedEngine*>(arg)->run(); }
+    void run();
+
+public:
+    // Canal RMT libre, ou -1 ; démarre la tâche au premier ruban
+    int8_t claim() {
+        if(!_lock) {
+            _lock = xSemaphoreCreateMutex();
+            xTaskCreatePinnedToCore(taskEntry, "leds", 3072, this, 2, &_task, 1);
+        }
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        int8_t ch = -1;
+        for(uint8_t c=0; c<OMNI_LED_STRIPS && ch < 0; c++) if(!(_channels >> c & 1)) { _channels |= 1 << c; ch = c; }
+        xSemaphoreGive(_lock);
+        return ch;
+    }
+    void release(int8_t ch) {
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        _channels &= ~(1 << ch);
+        xSemaphoreGive(_lock);
+    }
+
+    void add(LedStrip* s);
+    // Au retour, la tâche n'utilise plus le ruban
+    void remove(LedStrip* s);
+};
+
+inline LedEngine& ledEngine() {
+    static LedEngine e;
+    return e;
+}
+
+class LedStrip {
+    friend class LedEngine;
+    // WS2812 à 800 kHz, horloge RMT 40 MHz (25 ns par tick)
+    static constexpr uint8_t CLK_DIV = 2;
+    static constexpr uint16_t T0H = 16, T0L = 34, T1H = 32, T1L = 18;
+
+    int8_t _ch = -1;
+    uint16_t _n = 0;
+    const LedOrder* _order = &LED_ORDERS[0];
+    uint8_t* _px = nullptr;             // RGB par pixel, avant luminosité et gamma
+    uint8_t* _wire = nullptr;           // Trame dans l'ordre du ruban, après _px dans le même bloc (lue par le RMT)
+    LedParams _p;
+    bool _changed = false;              // Paramètres modifiés depuis la dernière image (sous _mux)
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    LedStrip* _next = nullptr;
+
+    // Traducteur du pilote RMT : un item par bit, MSB d'abord
+    static void IRAM_ATTR translate(const void* src, rmt_item32_t* dest, size_t size, size_t wanted,
+                                    size_t* done, size_t* items) {
+        const rmt_item32_t bit0 = {{{ T0H, 1, T0L, 0 }}}, bit1 = {{{ T1H, 1, T1L, 0 }}};
+        const uint8_t* p = (const uint8_t*)src;
+        size_t n = 0, k = 0;
+        while(k < size && n + 8 <= wanted) {
+            for(uint8_t b=0; b<8; b++) dest[n++].val = (p[k] >> (7 - b) & 1) ? bit1.val : bit0.val;
+            k++;
+        }
+        *done = k;
+        *items = n;
+    }
+
+    void setPixel(uint16_t i, uint32_t c) {
+        uint8_t* p = &_px[i * 3];
+        p[0] = c >> 16; p[1] = c >> 8; p[2] = c;
+    }
+
+    static bool animated(const LedParams& p) { return p.on && (p.fx == FX_CHASE || p.fx == FX_FADE || p.fx == FX_RAINBOW); }
+
+    void render(const LedParams& p, uint32_t now) {
+        if(!p.on) { memset(_px, 0, _n * 3); return; }
+        uint32_t phase = (uint32_t)((uint64_t)(now % p.period) * 65536 / p.period);     // 0..65535 sur un cycle
+        switch(p.fx) {
+            case FX_GRADIENT:
+                for(uint16_t i=0; i<_n; i++) {
+                    int32_t h = p.hue + (_n > 1 ? ((int32_t)p.hue2 - p.hue) * i / (_n - 1) : 0);
+                    setPixel(i, Adafruit_NeoPixel::ColorHSV(h, p.sat));
+                }
+                break;
+            case FX_CHASE: {
+                // Tête qui parcourt le ruban, traîne divisée par 4/3 à chaque pixel
+                uint16_t head = (uint32_t)phase * _n >> 16;
+                memset(_px, 0, _n * 3);
+                uint16_t level = 255;
+                for(uint16_t d=0; d<_n && level >= 4; d++, level = level * 3 / 4)
+                    setPixel((head + _n - d) % _n, Adafruit_NeoPixel::ColorHSV(p.hue, p.sat, level));
+                break;
+            }
+            case FX_FADE: {
+                uint8_t level = (1.0f - cosf(phase * (2.0f * PI / 65536.0f))) * 127.5f;
+                uint32_t c = Adafruit_NeoPixel::ColorHSV(p.hue, p.sat, level);
+                for(uint16_t i=0; i<_n; i++) setPixel(i, c);
+                break;
+            }
+            case FX_RAINBOW:
+                for(uint16_t i=0; i<_n; i++) setPixel(i, Adafruit_NeoPixel::ColorHSV(p.hue + phase + i * 65536L / _n, p.sat));
+                break;
+            default: {
+                uint32_t c = Adafruit_NeoPixel::ColorHSV(p.hue, p.sat);
+                for(uint16_t i=0; i<_n; i++) setPixel(i, c);
+            }
+        }
+    }
+
+    void encode(uint8_t bright) {
+        const LedOrder& o = *_order;
+        uint16_t scale = bright + 1;
+        for(uint16_t i=0; i<_n; i++) {
+            const uint8_t* s = &_px[i * 3];
+            uint8_t r = Adafruit_NeoPixel::gamma8(s[0] * scale >> 8);
+            uint8_t g = Adafruit_NeoPixel::gamma8(s[1] * scale >> 8);
+            uint8_t b = Adafruit_NeoPixel::gamma8(s[2] * scale >> 8);
+            uint8_t* d = &_wire[i * o.bpp];
+            if(o.bpp == 4) {
+                uint8_t w = min(r, min(g, b));
+                r -= w; g -= w; b -= w;
+                d[o.w] = w;
+            }
+            d[o.r] = r; d[o.g] = g; d[o.b] = b;
+        }
+    }
+
+    // Tâche "leds" : nouvelle image si l'effet est animé ou les paramètres ont changé
+    void frame(uint32_t now) {
+        if(rmt_wait_tx_done((rmt_channel_t)_ch, 0) != ESP_OK) { skipped++; return; }
+        portENTER_CRITICAL(&_mux);
+        bool changed = _changed;
+        LedParams p = _p;
+        _changed = false;
+        portEXIT_CRITICAL(&_mux);
+        if(!changed && !animated(p)) return;
+        render(p, now);
+        encode(p.bright);
+        if(rmt_write_sample((rmt_channel_t)_ch, _wire, _n * _order->bpp, false) == ESP_OK) frames++;
+    }
+
+    void release() {
+        if(_ch >= 0) { rmt_driver_uninstall((rmt_channel_t)_ch); ledEngine().release(_ch); _ch = -1; }
+        if(ledPool().owns(_px)) ledPool().free(_px);
+        else delete[] _px;
+        _px = _wire = nullptr;
+        _n = 0;
+    }
+
+public:
+    uint32_t frames = 0, skipped = 0;   // Images émises / sautées (canal encore occupé)
+
+    ~LedStrip() { end(); }
+
+    // false : mémoire, canal RMT ou broche indisponible
+    bool begin(int pin, uint16_t count, const LedOrder* order) {
+        end();
+        _n = constrain(count, 1, OMNI_LED_MAX);
+        _order = order ? order : &LED_ORDERS[0];
+        // Un bloc ledPool() (tas si le pool est plein) : pixels puis trame
+        size_t size = _n * (3 + _order->bpp);
+        if(!(_px = (uint8_t*)ledPool().alloc(size)) && !(_px = new (std::nothrow) uint8_t[size])) return false;
+        memset(_px, 0, size);
+        _wire = _px + _n * 3;
+        _ch = ledEngine().claim();
+        if(_ch < 0) { release(); return false; }
+        rmt_config_t cfg = RMT_DEFAULT_CONFIG_TX((gpio_num_t)pin, (rmt_channel_t)_ch);
+        cfg.clk_div = CLK_DIV;
+        if(rmt_config(&cfg) != ESP_OK || rmt_driver_install((rmt_channel_t)_ch, 0, 0) != ESP_OK) { release(); return false; }
+        rmt_translator_init((rmt_channel_t)_ch, translate);
+        _changed = true;    // Première image : ruban éteint
+        ledEngine().add(this);
+        return true;
+    }
+
+    void end() {
+        if(!_px) return;
+        ledEngine().remove(this);
+        if(_ch >= 0) rmt_wait_tx_done((rmt_channel_t)_ch, portMAX_DELAY);
+        release();
+    }
+
+    bool active() const { return _px != nullptr; }
+    uint16_t count() const { return _n; }
+    const LedOrder& order() const { return *_order; }
+
+    LedParams params() {
+        portENTER_CRITICAL(&_mux);
+        LedParams p = _p;
+        portEXIT_CRITICAL(&_mux);
+        return p;
+    }
+    void setParams(const LedParams& p) {
+        portENTER_CRITICAL(&_mux);
+        _p = p;
+        if(!_p.period) _p.period = 1;
+        _changed = true;
+        portEXIT_CRITICAL(&_mux);
+    }
+};
+
+inline void LedEngine::run() {
+    TickType_t last = xTaskGetTickCount();
+    for(;;) {
+        vTaskDelayUntil(&last, pdMS_TO_TICKS(1000 / OMNI_LED_FPS));
+        uint32_t now = millis();
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        for(LedStrip* s = _head; s; s = s->_next) s->frame(now);
+        xSemaphoreGive(_lock);
+    }
+}
+
+inline void LedEngine::add(LedStrip* s) {
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    s->_next = _head;
+    _head = s;
+    xSemaphoreGive(_lock);
+}
+
+inline void LedEngine::remove(LedStrip* s) {
+    if(!_lock) return;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    for(LedStrip** p = &_head; *p; p = &(*p)->_next) if(*p == s) { *p = s->_next; break; }
+    s->_next = nullptr;
+    xSemaphoreGive(_lock);
+}
@@ -0,0 +1,263 @@
+#pragma once
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <atomic>
+#include <memory>
+#include "OmniPool.h"
+
+// ==========================================
+// MÉTRIQUES D'EXÉCUTION (HISTOGRAMMES FIXES)
+// ==========================================
+// Histogrammes à seaux en puissances de 2 (un incrément sous spinlock par
+// mesure) : intervalle de loop(), attente et détention du mutex global,
+// latence read()/write() par driver, profondeur des files WebSocket, attente
+// et occupation du bus I2C.
+// /api/metrics les sert en JSON ou au format texte Prometheus, ligne par
+// ligne, sans construire la réponse en mémoire.
+
+#define OMNI_METRICS_BUCKETS 16         // + un seau de débordement
+#define OMNI_METRICS_MAX_DRIVERS 20
+#define OMNI_METRICS_NAME_LEN 12
+
+struct Histogram {
+    uint32_t bucket[OMNI_METRICS_BUCKETS + 1];  // bucket[k] : valeurs <= bound(k), dernier = au-delà
+    uint32_t count, max;
+    uint64_t sum;
+    uint8_t shift;                              // bound(k) = 2^(shift + k)
+
+    uint32_t bound(uint8_t k) const { return 1u << (shift + k); }
+
+    void add(uint32_t v) {
+        uint32_t k = 0;
+        if(v > bound(0)) k = min<uint32_t>(32 - __builtin_clz(v - 1) - shift, OMNI_METRICS_BUCKETS);
+        bucket[k]++;
+        count++; sum += v;
+        if(v > max) max = v;
+    }
+};
+
+class Metrics {
+public:
+    enum Hist : uint8_t { H_LOOP, H_LOCK_WAIT, H_LOCK_HOLD, H_WS_QUEUE, H_I2C_WAIT, H_I2C_BUSY, H_COUNT };
+
+    std::atomic<uint32_t> loops{0}, wsClients{0};
+
+    Metrics() {
+        memset(_hist, 0, sizeof(_hist));
+        memset(_drivers, 0, sizeof(_drivers));
+        _hist[H_LOOP].shift = 4;        // 16 µs .. 0,5 s
+        _hist[H_LOCK_WAIT].shift = 4;
+        _hist[H_LOCK_HOLD].shift = 4;
+        _hist[H_WS_QUEUE].shift = 0;    // 1 .. 65536 messages
+        _hist[H_I2C_WAIT].shift = 4;
+        _hist[H_I2C_BUSY].shift = 4;
+    }
+
+    void record(Hist h, uint32_t v) {
+        portENTER_CRITICAL(&_lock);
+        _hist[h].add(v);
+        portEXIT_CRITICAL(&_lock);
+    }
+
+    // Début de loop() : l'intervalle entre deux passages mesure la gigue
+    void loopTick() {
+        uint32_t now = micros();
+        if(loops.fetch_add(1)) record(H_LOOP, now - _lastLoop);
+        _lastLoop = now;
+    }
+
+    // --- Mutex global : attente à la prise, durée de détention à la libération ---
+    void take(SemaphoreHandle_t m) {
+        uint32_t t0 = micros();
+        xSemaphoreTake(m, portMAX_DELAY);
+        _heldSince = micros();
+        record(H_LOCK_WAIT, _heldSince - t0);
+    }
+
+    void give(SemaphoreHandle_t m) {
+        uint32_t held = micros() - _heldSince;
+        xSemaphoreGive(m);
+        record(H_LOCK_HOLD, held);
+    }
+
+    // --- Latence par driver ; `slot` est le cache du Device (-1 = pas encore résolu) ---
+    void driverCall(const char* driver, int8_t& slot, bool write, uint32_t us) {
+        if(slot < 0) slot = driverSlot(driver);
+        if(slot >= OMNI_METRICS_MAX_DRIVERS) return;
+        portENTER_CRITICAL(&_lock);
+        (write ? _drivers[slot].write : _drivers[slot].read).add(us);
+        portEXIT_CRITICAL(&_lock);
+    }
+
+    // format Prometheus (text/plain) ou JSON
+    AsyncWebServerResponse* stream(AsyncWebServerRequest* req, bool prom) {
+        std::shared_ptr<RenderState> st(new RenderState());
+        st->prom = prom;
+        uint32_t freeHeap = ESP.getFreeHeap(), maxAlloc = ESP.getMaxAllocHeap();
+        st->gauge[G_UPTIME] = millis() / 1000;
+        st->gauge[G_LOOPS] = loops;
+        st->gauge[G_HEAP_FREE] = freeHeap;
+        st->gauge[G_HEAP_MIN] = ESP.getMinFreeHeap();
+        st->gauge[G_HEAP_MAX_ALLOC] = maxAlloc;
+        st->gauge[G_HEAP_FRAG] = freeHeap ? 100 - (uint32_t)((uint64_t)maxAlloc * 100 / freeHeap) : 0;
+        st->gauge[G_PSRAM_FREE] = ESP.getFreePsram();
+        st->gauge[G_WS_CLIENTS] = wsClients;
+        st->gauge[G_POOL_USED] = devicePool().used();
+        st->gauge[G_POOL_FALLBACKS] = devicePool().fallbacks;
+        portENTER_CRITICAL(&_lock);
+        st->nDrivers = _nDrivers;
+        portEXIT_CRITICAL(&_lock);
+
+        return req->beginChunkedResponse(prom ? "text/plain; version=0.0.4" : "application/json",
+                                         [this, st](uint8_t* buf, size_t maxLen, size_t index) -> size_t {
+            size_t w = 0;
+            while(w < maxLen) {
+                if(st->off < st->len) {
+                    size_t k = min(maxLen - w, st->len - st->off);
+                    memcpy(buf + w, st->pend + st->off, k);
+                    w += k; st->off += k;
+                    continue;
+                }
+                if(!nextRow(*st)) break;
+            }
+            return w;
+        });
+    }
+
+private:
+    enum Gauge : uint8_t { G_UPTIME, G_LOOPS, G_HEAP_FREE, G_HEAP_MIN, G_HEAP_MAX_ALLOC, G_HEAP_FRAG, G_PSRAM_FREE, G_WS_CLIENTS, G_POOL_USED, G_POOL_FALLBACKS, G_COUNT };
+    enum Phase : uint8_t { R_GAUGES, R_HIST, R_END, R_DONE };
+    struct DriverStats { char name[OMNI_METRICS_NAME_LEN]; Histogram read, write; };
+    struct RenderState {
+        char pend[320]; size_t len, off;
+        uint32_t gauge[G_COUNT];
+        Histogram h; uint32_t cum;
+        uint16_t row, hist, emitted; uint8_t step, nDrivers, typed;
+        Phase phase; bool prom;
+    };
+
+    Histogram _hist[H_COUNT];
+    DriverStats _drivers[OMNI_METRICS_MAX_DRIVERS];
+    uint8_t _nDrivers = 0;
+    uint32_t _lastLoop = 0, _heldSince = 0;
+    mutable portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+
+    int8_t driverSlot(const char* driver) {
+        portENTER_CRITICAL(&_lock);
+        int8_t s = 0;
+        while(s < _nDrivers && strcmp(_drivers[s].name, driver) != 0) s++;
+        if(s == _nDrivers && _nDrivers < OMNI_METRICS_MAX_DRIVERS) {
+            strlcpy(_drivers[s].name, driver, OMNI_METRICS_NAME_LEN);
+            _drivers[s].read.shift = _drivers[s].write.shift = 4;
+            _nDrivers++;
+        }
+        portEXIT_CRITICAL(&_lock);
+        return s;   // OMNI_METRICS_MAX_DRIVERS si la table est pleine
+    }
+
+    // Histogramme n° `i` : globaux, puis read() de chaque driver, puis write()
+    const char* histName(uint16_t i, uint8_t nDrivers, const char*& driver) const {
+        static const char* names[H_COUNT] = {"loop_interval_us", "mutex_wait_us", "mutex_hold_us", "ws_queue_depth",
+                                         "i2c_queue_wait_us", "i2c_busy_us"};
+        driver = nullptr;
+        if(i < H_COUNT) return names[i];
+        i -= H_COUNT;
+        driver = _drivers[i % nDrivers].name;
+        return i < nDrivers ? "driver_read_us" : "driver_write_us";
+    }
+
+    // Copie l'histogramme courant ; false s'il est vide (driver jamais appelé)
+    bool load(RenderState& s) const {
+        portENTER_CRITICAL(&_lock);
+        if(s.hist < H_COUNT) s.h = _hist[s.hist];
+        else {
+            uint16_t d = s.hist - H_COUNT;
+            s.h = d < s.nDrivers ? _drivers[d].read : _drivers[d - s.nDrivers].write;
+        }
+        portEXIT_CRITICAL(&_lock);
+        s.cum = 0;
+        return s.hist < H_COUNT || s.h.count;
+    }
+
+    // Produit la ligne suivante dans s.pend ; false quand tout est envoyé
+    bool nextRow(RenderState& s) const {
+        static const char* gaugeNames[G_COUNT] = {"uptime_seconds", "loops_total", "heap_free_bytes", "heap_min_free_bytes",
+                                                  "heap_max_alloc_bytes", "heap_fragmentation_percent", "psram_free_bytes", "ws_clients",
+                                                  "device_pool_used", "device_pool_fallbacks_total"};
+        const size_t cap = sizeof(s.pend);
+        s.off = 0;
+        for(;;) {
+            switch(s.phase) {
+            case R_GAUGES:
+                if(s.row < G_COUNT) {
+                    const char* n = gaugeNames[s.row];
+                    if(s.prom) s.len = snprintf(s.pend, cap, "# TYPE omni_%s %s\nomni_%s %u\n", n, (s.row == G_LOOPS || s.row == G_POOL_FALLBACKS) ? "counter" : "gauge", n, (unsigned)s.gauge[s.row]);
+                    else s.len = snprintf(s.pend, cap, "%s\"%s\":%u", s.row ? "," : "{", n, (unsigned)s.gauge[s.row]);
+                    s.row++;
+                    return true;
+                }
+                s.phase = R_HIST; s.hist = 0; s.step = 0;
+                if(!s.prom) { s.len = snprintf(s.pend, cap, ",\"histograms\":["); return true; }
+                continue;
+
+            case R_HIST: {
+                if(s.hist >= H_COUNT + 2 * s.nDrivers) { s.phase = R_END; continue; }
+                if(s.step == 0 && !load(s)) { s.hist++; continue; }
+                const char* driver;
+                const char* n = histName(s.hist, s.nDrivers, driver);
+                const Histogram& h = s.h;
+                if(!s.prom) {
+                    int len = snprintf(s.pend, cap, "%s{\"name\":\"%s\"", s.emitted++ ? "," : "", n);
+                    if(driver) len += snprintf(s.pend + len, cap - len, ",\"driver\":\"%s\"", driver);
+                    len += snprintf(s.pend + len, cap - len, ",\"first\":%u,\"count\":%u,\"sum\":%llu,\"max\":%u,\"buckets\":[",
+                                    (unsigned)h.bound(0), (unsigned)h.count, (unsigned long long)h.sum, (unsigned)h.max);
+                    for(uint8_t k=0; k<=OMNI_METRICS_BUCKETS; k++) len += snprintf(s.pend + len, cap - len, "%s%u", k ? "," : "", (unsigned)h.bucket[k]);
+                    len += snprintf(s.pend + len, cap - len, "]}");
+                    s.len = min((size_t)len, cap - 1);
+                    s.hist++;
+                    return true;
+                }
+                // Prometheus : une ligne par seau (cumulés), puis _sum et _count
+                char label[OMNI_METRICS_NAME_LEN + 12] = "";
+                if(driver) snprintf(label, sizeof(label), "driver=\"%s\"", driver);
+                int len = 0;
+                if(s.step == 0) {
+                    uint8_t family = s.hist < H_COUNT ? 0 : (s.hist - H_COUNT < s.nDrivers ? 1 : 2);
+                    if(!family || !(s.typed & family)) len = snprintf(s.pend, cap, "# TYPE omni_%s histogram\n", n);
+                    s.typed |= family;
+                }
+                if(s.step <= OMNI_METRICS_BUCKETS) {
+                    s.cum += h.bucket[s.step];
+                    char le[12];
+                    if(s.step < OMNI_METRICS_BUCKETS) snprintf(le, sizeof(le), "%u", (unsigned)h.bound(s.step));
+                    else strcpy(le, "+Inf");
+                    len += snprintf(s.pend + len, cap - len, "omni_%s_bucket{%s%sle=\"%s\"} %u\n", n, label, driver ? "," : "", le, (unsigned)s.cum);
+                    s.step++;
+                } else {
+                    const char* o = driver ? "{" : ""; const char* c = driver ? "}" : "";
+                    len = snprintf(s.pend, cap, "omni_%s_sum%s%s%s %llu\nomni_%s_count%s%s%s %u\n",
+                                   n, o, label, c, (unsigned long long)h.sum, n, o, label, c, (unsigned)h.count);
+                    s.step = 0; s.hist++;
+                }
+                s.len = min((size_t)len, cap - 1);
+                return true;
+            }
+
+            case R_END:
+                s.phase = R_DONE;
+                if(!s.prom) { s.len = snprintf(s.pend, cap, "]}"); return true; }
+                continue;
+
+            default:
+                s.len = 0;
+                return false;
+            }
+        }
+    }
+};
+
+// Instance unique (drivers, Sampler, télémétrie et main.cpp y enregistrent leurs mesures)
+inline Metrics& metrics() {
+    static Metrics m;
+    return m;
+}
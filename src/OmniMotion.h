@@ -0,0 +1,201 @@
+#pragma once
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <ESP32Servo.h>
+
+// ==========================================
+// SERVOS : PROFILS DE MOUVEMENT
+// ==========================================
+// Une consigne d'angle ne saute plus directement à la cible : le mouvement
+// suit un profil (linéaire, trapèze vitesse/accélération, sinus) avancé par un
+// esp_timer périodique à la cadence de la trame servo (20 ms), actif seulement
+// tant qu'un servo bouge. write() calcule la durée du mouvement et rend la main.
+//
+// Mouvements coordonnés : entre hold() et release(), les consignes sont mises
+// en attente ; release() les démarre ensemble, étirées à la durée du plus long
+// (même forme de profil, vitesse réduite) pour qu'elles arrivent en même temps.
+
+#define OMNI_MOTION_TICK_MS 20
+#ifndef OMNI_SERVO_SPEED
+#define OMNI_SERVO_SPEED 180    // °/s par défaut (0 = consigne immédiate)
+#endif
+#ifndef OMNI_SERVO_ACCEL
+#define OMNI_SERVO_ACCEL 720    // °/s² par défaut (0 = vitesse constante)
+#endif
+
+enum MotionProfile : uint8_t { MOTION_LINEAR, MOTION_TRAPEZOID, MOTION_SINE, MOTION_COUNT };
+
+class ServoAxis {
+    friend class MotionPlanner;
+    Servo _servo;
+    int _minUs = 500, _maxUs = 2400;
+    bool _homed = false;            // Position connue (sinon le premier mouvement est immédiat)
+    // Mouvement en cours, sous le verrou du planificateur
+    float _from = 0, _to = 0, _pos = 0;
+    uint32_t _t0 = 0, _dur = 0;     // ms ; _dur = 0 : à l'arrêt
+    float _ramp = 0;                // Trapèze : part de la durée en accélération (et en freinage)
+    uint8_t _shape = MOTION_LINEAR;
+    bool _staged = false;           // En attente de release()
+    ServoAxis* _next = nullptr;
+
+    void output(float deg) {
+        _pos = deg;
+        _servo.writeMicroseconds(lroundf(_minUs + (_maxUs - _minUs) * deg / 180.0f));
+    }
+
+    // Avancement normalisé (0..1) à l'instant normalisé u (0..1)
+    static float shape(uint8_t s, float ramp, float u) {
+        switch(s) {
+            case MOTION_TRAPEZOID: {
+                if(ramp <= 0) return u;
+                float v = 1.0f / (1.0f - ramp);     // Vitesse du palier (aire unité)
+                if(u < ramp) return v * u * u / (2 * ramp);
+                if(u > 1 - ramp) return 1 - v * (1 - u) * (1 - u) / (2 * ramp);
+                return v * (u - ramp / 2);
+            }
+            case MOTION_SINE: return (1 - cosf(PI * u)) / 2;
+            default: return u;
+        }
+    }
+
+    // Durée (ms) et forme du mouvement vers `to` aux réglages actuels
+    void plan(float to) {
+        _from = _pos; _to = to;
+        float d = fabsf(to - _pos);
+        _shape = profile; _ramp = 0;
+        if(!_homed || speed <= 0 || d < 0.01f) { _dur = 0; return; }
+        float t;
+        if(profile == MOTION_SINE) t = PI * d / (2 * speed);            // Vitesse de crête = speed
+        else if(profile == MOTION_TRAPEZOID && accel > 0) {
+            float ta = speed / accel;
+            if(d >= speed * ta) t = d / speed + ta;                     // Palier à speed
+            else { ta = sqrtf(d / accel); t = 2 * ta; }                 // Triangle : speed jamais atteinte
+            _ramp = ta / t;
+        } else { t = d / speed; _shape = MOTION_LINEAR; }
+        _dur = max((uint32_t)(t * 1000), (uint32_t)OMNI_MOTION_TICK_MS);
+    }
+
+    // Tâche esp_timer ; false une fois la cible atteinte
+    bool step(uint32_t now) {
+        uint32_t el = now - _t0;
+        if(el >= _dur) { output(_to); _dur = 0; return false; }
+        output(_from + (_to - _from) * shape(_shape, _ramp, (float)el / _dur));
+        return true;
+    }
+
+public:
+    float speed = OMNI_SERVO_SPEED, accel = OMNI_SERVO_ACCEL;
+    uint8_t profile = MOTION_TRAPEZOID;
+
+    ~ServoAxis() { end(); }
+
+    void begin(int pin, int minUs, int maxUs);
+    void end();
+
+    float position() const { return _pos; }
+    float target() const { return _to; }
+    bool moving() const { return _dur || _staged; }
+};
+
+class MotionPlanner {
+    SemaphoreHandle_t _lock = nullptr;
+    esp_timer_handle_t _timer = nullptr;
+    ServoAxis* _head = nullptr;
+    uint8_t _hold = 0;
+    bool _running = false;
+
+    static void onTick(void* arg) { static_cast<MotionPlanner*>(arg)->tick(); }
+
+    void tick() {
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        uint32_t now = millis();
+        bool any = false;
+        for(ServoAxis* a = _head; a; a = a->_next) if(a->_dur && !a->_staged) any |= a->step(now);
+        if(!any && _running) { esp_timer_stop(_timer); _running = false; }
+        xSemaphoreGive(_lock);
+    }
+
+    // Sous _lock
+    void run() {
+        if(_running) return;
+        esp_timer_start_periodic(_timer, OMNI_MOTION_TICK_MS * 1000);
+        _running = true;
+    }
+
+public:
+    void add(ServoAxis* a) {
+        if(!_lock) {
+            _lock = xSemaphoreCreateMutex();
+            esp_timer_create_args_t args = {};
+            args.callback = onTick;
+            args.arg = this;
+            args.name = "motion";
+            esp_timer_create(&args, &_timer);
+        }
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        a->_next = _head;
+        _head = a;
+        xSemaphoreGive(_lock);
+    }
+
+    // Au retour, le timer n'utilise plus l'axe
+    void remove(ServoAxis* a) {
+        if(!_lock) return;
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        for(ServoAxis** p = &_head; *p; p = &(*p)->_next) if(*p == a) { *p = a->_next; break; }
+        a->_next = nullptr;
+        xSemaphoreGive(_lock);
+    }
+
+    // Nouvelle cible (°) : repart de la position courante, immédiat si speed = 0
+    void move(ServoAxis& a, float to) {
+        if(!_lock) return;
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        // Même cible déjà en cours : le mouvement continue sans repartir de zéro
+        if(a._dur && a._to == to) { xSemaphoreGive(_lock); return; }
+        a.plan(to);
+        if(!a._dur) { a.output(to); a._homed = true; a._staged = false; }
+        else if(_hold) a._staged = true;
+        else { a._t0 = millis(); run(); }
+        xSemaphoreGive(_lock);
+    }
+
+    // Consignes suivantes mises en attente jusqu'au release() correspondant
+    void hold() {
+        if(!_lock) return;
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        _hold++;
+        xSemaphoreGive(_lock);
+    }
+
+    // Démarre ensemble les mouvements en attente, tous à la durée du plus long
+    void release() {
+        if(!_lock) return;
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        if(_hold && --_hold == 0) {
+            uint32_t dur = 0, now = millis();
+            for(ServoAxis* a = _head; a; a = a->_next) if(a->_staged) dur = max(dur, a->_dur);
+            for(ServoAxis* a = _head; a; a = a->_next) if(a->_staged) { a->_dur = dur; a->_t0 = now; a->_staged = false; }
+            if(dur) run();
+        }
+        xSemaphoreGive(_lock);
+    }
+};
+
+inline MotionPlanner& motion() {
+    static MotionPlanner m;
+    return m;
+}
+
+inline void ServoAxis::begin(int pin, int minUs, int maxUs) {
+    _minUs = minUs; _maxUs = maxUs;
+    _servo.setPeriodHertz(50);
+    _servo.attach(pin, minUs, maxUs);
+    motion().add(this);
+}
+
+// Canal LEDC rendu par detach()
+inline void ServoAxis::end() {
+    motion().remove(this);
+    if(_servo.attached()) _servo.detach();
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include <new>
+
+// ==========================================
+// POOLS À BLOCS FIXES (DEVICES, FRAMEBUFFERS, RUBANS LED)
+// ==========================================
+// Une seule allocation au boot, découpée en blocs de taille fixe chaînés dans
+// une liste libre : reconfigurer mille fois ne touche plus au tas et ne peut
+// donc pas le fragmenter. Pool absent, plein ou bloc trop petit : alloc()
+// renvoie nullptr, l'appelant se replie sur le tas.
+
+class SlabPool {
+    uint8_t* _mem = nullptr;
+    void* _head = nullptr;                  // Liste libre : chaque bloc libre pointe sur le suivant
+    size_t _slot = 0;
+    uint16_t _count = 0, _used = 0, _peak = 0;
+    bool _bypass = false;
+    portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+
+public:
+    // A appeler une fois au boot, avant toute allocation à servir par le pool
+    bool begin(size_t slotSize, uint16_t count) {
+        if(_mem) return true;
+        _slot = (max(slotSize, sizeof(void*)) + 7) & ~(size_t)7;
+        _mem = new (std::nothrow) uint8_t[_slot * count];
+        if(!_mem) return false;
+        _count = count;
+        for(uint16_t i=0; i<count; i++) *(void**)(_mem + i * _slot) = i + 1 < count ? _mem + (i + 1) * _slot : nullptr;
+        _head = _mem;
+        return true;
+    }
+
+    // nullptr si le pool ne peut pas servir `size` octets
+    void* alloc(size_t size) {
+        if(size > _slot) return nullptr;
+        portENTER_CRITICAL(&_lock);
+        void* p = _bypass ? nullptr : _head;
+        if(p) {
+            _head = *(void**)p;
+            if(++_used > _peak) _peak = _used;
+        }
+        portEXIT_CRITICAL(&_lock);
+        return p;
+    }
+
+    bool owns(const void* p) const { return _mem && p >= _mem && p < _mem + _slot * _count; }
+
+    void free(void* p) {
+        portENTER_CRITICAL(&_lock);
+        *(void**)p = _head;
+        _head = p;
+        _used--;
+        portEXIT_CRITICAL(&_lock);
+    }
+
+    // Benchmarks : force le repli sur le tas
+    void setBypass(bool on) { _bypass = on; }
+
+    size_t slotSize() const { return _slot; }
+    uint16_t capacity() const { return _count; }
+    uint16_t used() const { return _used; }
+    uint16_t peak() const { return _peak; }
+};
+
+// Deux classes de taille : drivers courants (petits blocs) et gros drivers
+// (tampons de capture, tables de sondes). Chaque allocation prend la plus
+// petite classe qui la contient.
+class DevicePool {
+    SlabPool _small, _large;
+public:
+    std::atomic<uint32_t> fallbacks{0};
+
+    bool begin(size_t smallSize, uint16_t smallCount, size_t largeSize, uint16_t largeCount) {
+        return _small.begin(smallSize, smallCount) && _large.begin(largeSize, largeCount);
+    }
+
+    void* allocOrHeap(size_t size) {
+        void* p = _small.alloc(size);
+        if(!p) p = _large.alloc(size);
+        if(p) return p;
+        if(!_bypass) fallbacks++;
+        return ::operator new(size);
+    }
+    void release(void* p) {
+        if(_small.owns(p)) _small.free(p);
+        else if(_large.owns(p)) _large.free(p);
+        else ::operator delete(p);
+    }
+
+    void setBypass(bool on) { _bypass = on; _small.setBypass(on); _large.setBypass(on); }
+
+    const SlabPool& small() const { return _small; }
+    const SlabPool& large() const { return _large; }
+    uint16_t used() const { return _small.used() + _large.used(); }
+
+private:
+    bool _bypass = false;
+};
+
+// Objets Device (drivers + objets de bibliothèque embarqués)
+inline DevicePool& devicePool() {
+    static DevicePool p;
+    return p;
+}
+
+// Gros tampons de bibliothèque (framebuffer OLED)
+inline SlabPool& bufferPool() {
+    static SlabPool p;
+    return p;
+}
+
+// Tampons des rubans LED (pixels RGB + trame encodée, un bloc par ruban)
+inline SlabPool& ledPool() {
+    static SlabPool p;
+    return p;
+}
@@ -0,0 +1,257 @@
+#pragma once
+#include <Arduino.h>
+#include "OmniDrivers.h"
+
+// ==========================================
+// REGISTRE DES DEVICES (SLOTS + INDEX HASH)
+// ==========================================
+// Slot = index numérique stable d'un device (snapshot, règles, protocole binaire).
+// Un device retiré laisse un trou (nullptr) repris par le prochain ajout : les
+// autres gardent leur slot. L'index id -> slot est une table de hachage à
+// adressage ouvert : find() en O(1) sans allocation ni construction de String.
+
+#ifndef OMNI_MAX_DEVICES
+#define OMNI_MAX_DEVICES 128
+#endif
+
+template<size_t N>
+class DeviceRegistryT {
+    // Taille de table = puissance de 2 >= 2N (facteur de charge <= 0.5)
+    static constexpr size_t pow2(size_t v) { return v <= 1 ? 1 : 2 * pow2((v + 1) / 2); }
+    static constexpr size_t BUCKETS = pow2(2 * N);
+
+    Device* _slots[N] = {nullptr};
+    uint16_t _index[BUCKETS] = {0};   // slot + 1, 0 = vide
+    size_t _end = 0;                  // Dernier slot occupé + 1
+    size_t _live = 0;
+
+    static uint32_t hash(const char* s) {
+        uint32_t h = 2166136261u;
+        while(*s) { h ^= (uint8_t)*s++; h *= 16777619u; }
+        return h;
+    }
+
+    size_t bucketOf(size_t slot) const {
+        size_t b = hash(_slots[slot]->getId()) & (BUCKETS - 1);
+        while(_index[b] != slot + 1) b = (b + 1) & (BUCKETS - 1);
+        return b;
+    }
+
+    // Suppression en sondage linéaire : recule les entrées suivantes de la grappe
+    void unindex(size_t b) {
+        _index[b] = 0;
+        for(size_t j = (b + 1) & (BUCKETS - 1); _index[j]; j = (j + 1) & (BUCKETS - 1)) {
+            size_t home = hash(_slots[_index[j] - 1]->getId()) & (BUCKETS - 1);
+            // L'entrée j reste atteignable seulement si sa place d'origine est dans ]b, j]
+            bool reachable = b <= j ? (home > b && home <= j) : (home > b || home <= j);
+            if(reachable) continue;
+            _index[b] = _index[j];
+            _index[j] = 0;
+            b = j;
+        }
+    }
+
+public:
+    static const size_t CAPACITY = N;
+
+    // Borne des slots (trous compris) : itérer sur [0, size()) et ignorer les nullptr
+    size_t size() const { return _end; }
+    size_t live() const { return _live; }
+    Device* operator[](size_t slot) const { return slot < _end ? _slots[slot] : nullptr; }
+    Device* const* begin() const { return _slots; }
+    Device* const* end() const { return _slots + _end; }
+
+    // Slot du device `id`, -1 si absent
+    int find(const char* id) const {
+        for(size_t b = hash(id) & (BUCKETS - 1); _index[b]; b = (b + 1) & (BUCKETS - 1)) {
+            uint16_t slot = _index[b] - 1;
+            if(strcmp(_slots[slot]->getId(), id) == 0) return slot;
+        }
+        return -1;
+    }
+    Device* get(const char* id) const { int s = find(id); return s < 0 ? nullptr : _slots[s]; }
+
+    // Place un device dans `slot` (libre) ; false si occupé, hors bornes ou id déjà présent
+    bool insertAt(size_t slot, Device* d) {
+        if(slot >= N || _slots[slot] || find(d->getId()) >= 0) return false;
+        size_t b = hash(d->getId()) & (BUCKETS - 1);
+        while(_index[b]) b = (b + 1) & (BUCKETS - 1);
+        _slots[slot] = d;
+        _index[b] = slot + 1;
+        if(slot >= _end) _end = slot + 1;
+        _live++;
+        return true;
+    }
+
+    // Premier slot libre ; -1 si plein ou id déjà présent
+    int insert(Device* d) {
+        size_t slot = 0;
+        while(slot < _end && _slots[slot]) slot++;
+        return insertAt(slot, d) ? (int)slot : -1;
+    }
+    bool push_back(Device* d) { return insert(d) >= 0; }
+
+    // Retire le device du slot sans le détruire (le slot devient un trou)
+    Device* remove(size_t slot) {
+        if(slot >= _end || !_slots[slot]) return nullptr;
+        unindex(bucketOf(slot));
+        Device* d = _slots[slot];
+        _slots[slot] = nullptr;
+        _live--;
+        while(_end && !_slots[_end - 1]) _end--;
+        return d;
+    }
+
+    // Détruit tous les devices
+    void clear() {
+        for(size_t i=0; i<_end; i++) delete _slots[i];
+        memset(_slots, 0, sizeof(_slots));
+        memset(_index, 0, sizeof(_index));
+        _end = _live = 0;
+    }
+};
+
+using DeviceRegistry = DeviceRegistryT<OMNI_MAX_DEVICES>;
+
+#ifdef OMNI_BENCH
+// Recherche par id et sérialisation de statut : ancien chemin (scan linéaire,
+// accesseurs String par valeur) contre registre + accesseurs const char*.
+class NullPrint : public Print {
+public:
+    size_t n = 0;
+    size_t write(uint8_t) override { n++; return 1; }
+    size_t write(const uint8_t*, size_t len) override { n += len; return len; }
+};
+
+inline void benchRegistry(Print& out) {
+    devicePool().setBypass(true);       // 200 devices : au-delà du pool
+    out.println("[BENCH] devices  lookup_legacy_us  lookup_registry_us  status_legacy_us  status_registry_us");
+    for(size_t nDev : {10, 50, 200}) {
+        auto* reg = new DeviceRegistryT<256>();
+        char id[OMNI_ID_LEN];
+        for(size_t i=0; i<nDev; i++) {
+            snprintf(id, sizeof(id), "relay_%u", (unsigned)i);
+            reg->push_back(new Driver_Digital(id, "Bench", "RELAY", 0, true, false));   // begin() non appelé : aucun accès GPIO
+        }
+        volatile int sink = 0;
+
+        // Recherche de chaque id (pire cas moyen du scan : n/2 comparaisons)
+        uint32_t t0 = micros();
+        for(size_t i=0; i<nDev; i++) {
+            String want = String("relay_") + i;
+            for(auto d : *reg) if(String(d->getId()) == want) { sink++; break; }
+        }
+        uint32_t legacyLookup = micros() - t0;
+        t0 = micros();
+        for(size_t i=0; i<nDev; i++) {
+            snprintf(id, sizeof(id), "relay_%u", (unsigned)i);
+            sink += reg->find(id);
+        }
+        uint32_t regLookup = micros() - t0;
+
+        NullPrint np;
+        t0 = micros();
+        for(auto d : *reg) {
+            String i = d->getId(), n = d->getName(), dr = d->getDriver();
+            np.printf("{\"id\":\"%s\",\"name\":\"%s\",\"driver\":\"%s\",\"pin\":%d}", i.c_str(), n.c_str(), dr.c_str(), d->getPin());
+        }
+        uint32_t legacyStatus = micros() - t0;
+        t0 = micros();
+        for(auto d : *reg) {
+            np.printf("{\"id\":\"%s\",\"name\":\"%s\",\"driver\":\"%s\",\"pin\":%d}", d->getId(), d->getName(), d->getDriver(), d->getPin());
+        }
+        uint32_t regStatus = micros() - t0;
+
+        out.printf("[BENCH] %7u  %16u  %18u  %16u  %18u\n", (unsigned)nDev, legacyLookup, regLookup, legacyStatus, regStatus);
+        reg->clear();
+        delete reg;
+    }
+    devicePool().setBypass(false);
+}
+
+// Cycles de reconfiguration (destruction + recréation d'une config mixte, comme
+// applyConfig) entrecoupés de réponses JSON éphémères et de chaînes qui
+// survivent à plusieurs reconfigurations, dans une fenêtre de tas réduite
+// (OMNI_BENCH_HEAP octets contigus, le reste étant occupé comme sur la carte
+// par WiFi, serveur et LittleFS) : tas libre, plus gros bloc et fragmentation,
+// sans puis avec pool.
+#define OMNI_BENCH_RECONFIG 2000
+#define OMNI_BENCH_HEAP 24576
+
+inline unsigned fragPct(uint32_t freeHeap, uint32_t maxAlloc) {
+    return freeHeap ? 100 - (unsigned)((uint64_t)maxAlloc * 100 / freeHeap) : 0;
+}
+
+// taken : octets de tas pris par les devices d'une config (moyenne) ; drift : tas
+// non rendu en fin de charge ; frag* : fragmentation avant et après (chaînes en vie)
+struct PoolBenchResult { uint32_t taken, fallbacks; int drift; unsigned fragBefore, fragAfter; };
+
+// begin : chaque device est démarré (tampons LED, image OLED...) ; seulement sur le
+// HAL simulé, périphériques branchés aux broches et adresses de la table
+inline PoolBenchResult runPoolBench(bool pooled, uint32_t cycles, bool begin = false) {
+    static const struct { const char* type; int pin; } types[] = {
+        {"RELAY", 26}, {"BUTTON", 27}, {"PIR", 14}, {"PULSE", 13}, {"LDR", 34}, {"DHT22", 4}, {"DS18B20", 5},
+        {"SERVO", 18}, {"NEOPIXEL", 16}, {"INA219", 0x40}, {"BME280", 0x76}, {"BH1750", 0x23}, {"LCD_I2C", 0x27}, {"OLED", 0x3C} };
+    const size_t nTypes = sizeof(types) / sizeof(types[0]);
+    auto create = [&](size_t t, const char* id) {
+        Device* d = DeviceFactory::create(types[t].type, id, "Bench", types[t].pin);
+        if(begin) d->begin();
+        return d;
+    };
+    devicePool().setBypass(!pooled);
+    bufferPool().setBypass(!pooled);
+    ledPool().setBypass(!pooled);
+    auto* reg = new DeviceRegistryT<32>();
+    uint32_t fb0 = devicePool().fallbacks;
+    char id[OMNI_ID_LEN];
+    // Première config hors mesure : objets statiques et tampons des bibliothèques déjà en place
+    for(size_t i=0; i<nTypes; i++) { snprintf(id, sizeof(id), "d%u", (unsigned)i); reg->push_back(create(i, id)); }
+    reg->clear();
+    uint32_t window = ESP.getMaxAllocHeap();
+    uint8_t* ballast = window > OMNI_BENCH_HEAP ? new (std::nothrow) uint8_t[window - OMNI_BENCH_HEAP] : nullptr;
+    uint32_t free0 = ESP.getFreeHeap(), max0 = ESP.getMaxAllocHeap();
+    uint32_t freeHeap, maxAlloc;
+    uint64_t taken = 0;
+    {
+        String keep[8];                                 // Survivent à plusieurs reconfigurations
+        for(uint32_t c=0; c<cycles; c++) {
+            reg->clear();
+            size_t n = 4 + c % 12;                      // Taille de config variable
+            for(size_t i=0; i<n; i++) {
+                snprintf(id, sizeof(id), "d%u", (unsigned)i);
+                uint32_t before = ESP.getFreeHeap();
+                reg->push_back(create((c + i * 3) % nTypes, id));
+                taken += before - ESP.getFreeHeap();
+                String reply;                           // Réponse JSON, libérée aussitôt
+                reply.reserve(64 + (c * 7 + i * 53) % 700);
+                if(i % 4 == 0) {
+                    String& k = keep[(c + i) % 8];
+                    k = String();
+                    k.reserve(24 + (c * 37 + i * 91) % 400);
+                }
+            }
+        }
+        reg->clear();
+        freeHeap = ESP.getFreeHeap(); maxAlloc = ESP.getMaxAllocHeap();    // Chaînes encore en vie
+    }
+    int drift = (int)(free0 - ESP.getFreeHeap());
+    delete[] ballast;
+    delete reg;
+    devicePool().setBypass(false);
+    bufferPool().setBypass(false);
+    ledPool().setBypass(false);
+    return { (uint32_t)(taken / cycles), devicePool().fallbacks - fb0, drift, fragPct(free0, max0), fragPct(freeHeap, maxAlloc) };
+}
+
+inline void benchDevicePool(Print& out) {
+    const DevicePool& pool = devicePool();
+    out.printf("[BENCH] pool: %u x %u B + %u x %u B, %u cycles, %u B heap window\n", pool.small().capacity(), (unsigned)pool.small().slotSize(),
+               pool.large().capacity(), (unsigned)pool.large().slotSize(), OMNI_BENCH_RECONFIG, OMNI_BENCH_HEAP);
+    out.println("[BENCH] alloc  heap_B_per_config  heap_drift_B  frag_pct_before  frag_pct_after  fallbacks");
+    for(bool pooled : {false, true}) {
+        PoolBenchResult r = runPoolBench(pooled, OMNI_BENCH_RECONFIG);
+        out.printf("[BENCH] %5s  %17u  %12d  %15u  %14u  %9u\n", pooled ? "pool" : "heap", (unsigned)r.taken, r.drift,
+                   r.fragBefore, r.fragAfter, (unsigned)r.fallbacks);
+    }
+}
+#endif
@@ -0,0 +1,341 @@
+#pragma once
+#include <Arduino.h>
+#include <algorithm>
+#include <atomic>
+#include <math.h>
+#include <vector>
+#include "OmniDrivers.h"
+#include "OmniSampler.h"
+
+// ==========================================
+// MOTEUR D'AUTOMATISATION (RÈGLES COMPILÉES)
+// ==========================================
+// Chaque règle garde l'état de sa condition : l'hystérésis le fait retomber
+// au-delà du seuil -/+ `hyst`, et il ne change pas avant `minOn` / `minOff` ms.
+// Déclenchement :
+//   level : la cible suit la condition (act si vraie, else si fausse)
+//   rise  : act au passage à vrai, else au passage à faux
+//   fall  : act au passage à faux, else au passage à vrai
+// Une action n'est émise que si elle change l'état de la cible (canal booléen
+// du snapshot, sinon dernière valeur écrite par une règle), et pas moins de
+// `cooldown` ms après la précédente de la même règle. Une action retenue par
+// une durée est réévaluée à son échéance, sans attendre la source.
+// Écrans : tant que la condition est vraie, chaque nouvelle valeur est affichée
+// (le driver ignore un texte identique), au rythme du cooldown.
+
+// Structure pour les règles d'automatisation (forme JSON / persistance)
+struct Rule {
+    String srcId; String param; String op; float threshold; String tgtId; float actionVal;
+    String trig = "level";                          // level | rise | fall
+    float hyst = 0;                                 // Bande d'hystérésis (unité du canal)
+    uint32_t minOn = 0, minOff = 0, cooldown = 0;   // ms
+    float elseVal = NAN;                            // Action quand la condition est fausse (NAN = aucune)
+};
+
+enum RuleOp : uint8_t { OP_GT, OP_LT, OP_GE, OP_LE, OP_EQ, OP_NE, OP_INVALID };
+enum RuleTrig : uint8_t { TRIG_LEVEL, TRIG_RISE, TRIG_FALL, TRIG_INVALID };
+
+// Forme compilée : tout est résolu en index, plus aucune comparaison de String
+struct CompiledRule {
+    uint16_t src, tgt;      // Slots device (registre / snapshot)
+    uint16_t rule;          // Index de la règle source (pour résoudre `param`)
+    int8_t ch;              // Canal du snapshot (-1 = pas encore résolu)
+    RuleOp op;
+    float threshold, actionVal;
+    RuleTrig trig = TRIG_LEVEL;
+    bool text = false;          // Cible écran : valeur affichée tant que la condition est vraie
+    float hyst = 0, elseVal = NAN;
+    uint32_t minOn = 0, minOff = 0, cooldown = 0;
+    uint32_t def = 0;           // Empreinte de la règle source (RuleEngine::fingerprint)
+    // État (repris par compile() si la règle et ses devices n'ont pas changé)
+    int8_t state = -1;          // Condition : -1 inconnue (première mesure : pas de front)
+    uint32_t since = 0;         // millis() du dernier changement de state
+    uint32_t fired = 0;         // millis() de la dernière action émise (0 = jamais)
+    float pending = NAN;        // Action voulue, pas encore émise
+    uint32_t retry = 0;         // Réévaluation à cette échéance (0 = aucune)
+};
+
+class RuleEngine {
+    std::vector<CompiledRule> _compiled;            // Trié par slot source
+    uint16_t _first[OMNI_MAX_DEVICES + 1] = {0};    // _compiled[_first[s] .. _first[s+1]) = règles de s
+    std::atomic<uint32_t> _changed[(OMNI_MAX_DEVICES + 31) / 32];
+    const std::vector<Rule>* _rules = nullptr;
+    // Dernière action écrite par une règle sur chaque cible (NAN = aucune) et son instant
+    float _written[OMNI_MAX_DEVICES];
+    uint32_t _writtenAt[OMNI_MAX_DEVICES];
+    uint32_t _wake = 0;         // Plus proche échéance de CompiledRule::retry (0 = aucune)
+
+    // Condition avec hystérésis : une fois vraie, elle le reste jusqu'à seuil -/+ hyst
+    static bool hold(const CompiledRule& c, float v) {
+        if(c.state != 1 || c.hyst <= 0) return test(c.op, v, c.threshold);
+        switch(c.op) {
+            case OP_GT: return v > c.threshold - c.hyst;
+            case OP_GE: return v >= c.threshold - c.hyst;
+            case OP_LT: return v < c.threshold + c.hyst;
+            case OP_LE: return v <= c.threshold + c.hyst;
+            default: return test(c.op, v, c.threshold);
+        }
+    }
+
+    // État courant de la cible : canal booléen du snapshot s'il est plus récent
+    // que la dernière écriture d'une règle, sinon cette écriture
+    float targetState(const DeviceSnapshot& snap, uint16_t tgt) const {
+        DeviceSample t;
+        if(snap.read(tgt, t) && t.nch && t.unit[0] == UNIT_BOOL && (t.valid & 1) &&
+           (isnan(_written[tgt]) || (int32_t)(t.stamp - _writtenAt[tgt]) > 0)) return t.val[0];
+        return _written[tgt];
+    }
+
+    // FNV-1a des champs de la règle : règle modifiée = état repart de zéro
+    static uint32_t fingerprint(const Rule& r) {
+        uint32_t h = 2166136261u;
+        auto mix = [&h](const void* p, size_t n) { for(size_t i=0; i<n; i++) { h ^= ((const uint8_t*)p)[i]; h *= 16777619u; } };
+        for(const String* f : {&r.srcId, &r.param, &r.op, &r.tgtId, &r.trig}) mix(f->c_str(), f->length() + 1);
+        float num[] = {r.threshold, r.actionVal, r.hyst, r.elseVal};
+        uint32_t ms[] = {r.minOn, r.minOff, r.cooldown};
+        mix(num, sizeof(num)); mix(ms, sizeof(ms));
+        return h;
+    }
+
+    static bool before(const CompiledRule& a, const CompiledRule& b) { return a.src < b.src || (a.src == b.src && a.rule < b.rule); }
+
+    void wakeAt(CompiledRule& c, uint32_t at) {
+        c.retry = at ? at : 1;
+        if(!_wake || (int32_t)(c.retry - _wake) < 0) _wake = c.retry;
+    }
+
+    // Nouvel état de la condition (durées minimales) et action voulue
+    void step(CompiledRule& c, float v, uint32_t now) {
+        bool on = hold(c, v);
+        int8_t old = c.state;
+        if(old < 0) { c.state = on; c.since = now; }
+        else if(on != (bool)old) {
+            uint32_t need = old ? c.minOn : c.minOff;
+            if(now - c.since < need) { wakeAt(c, c.since + need); on = old; }
+            else { c.state = on; c.since = now; }
+        }
+        bool edge = old >= 0 && c.state != old;
+        if(c.trig == TRIG_LEVEL) c.pending = c.state ? c.actionVal : c.elseVal;
+        else if(edge) c.pending = (c.state == (c.trig == TRIG_RISE)) ? c.actionVal : c.elseVal;
+        if(c.text && !c.state) c.pending = NAN;
+    }
+
+public:
+    RuleEngine() {
+        for(auto& c : _changed) c.store(0);
+        for(size_t t=0; t<OMNI_MAX_DEVICES; t++) { _written[t] = NAN; _writtenAt[t] = 0; }
+    }
+
+    static RuleOp parseOp(const String& op) {
+        if(op == ">") return OP_GT;
+        if(op == "<") return OP_LT;
+        if(op == ">=") return OP_GE;
+        if(op == "<=") return OP_LE;
+        if(op == "==") return OP_EQ;
+        if(op == "!=") return OP_NE;
+        return OP_INVALID;
+    }
+
+    static RuleTrig parseTrig(const String& trig) {
+        if(!trig.length() || trig == "level") return TRIG_LEVEL;
+        if(trig == "rise") return TRIG_RISE;
+        if(trig == "fall") return TRIG_FALL;
+        return TRIG_INVALID;
+    }
+
+    static bool test(RuleOp op, float v, float t) {
+        switch(op) {
+            case OP_GT: return v > t;
+            case OP_LT: return v < t;
+            case OP_GE: return v >= t;
+            case OP_LE: return v <= t;
+            case OP_EQ: return v == t;
+            case OP_NE: return v != t;
+            default: return false;
+        }
+    }
+
+    // A appeler sous mutex, après chargement des devices ou des règles.
+    // Les règles dont la source, la cible, l'opérateur ou le déclenchement sont inconnus sont ignorées.
+    // `reset` : slots dont le device a été recréé ou retiré. Une règle inchangée (même index, mêmes
+    // champs, mêmes slots) dont ni la source ni la cible n'est dans `reset` garde son état : fronts,
+    // cooldown et durées minimales ne sont pas réarmés par l'édition d'un autre device.
+    void compile(const std::vector<Rule>& rules, const DeviceRegistry& devices, const std::vector<uint16_t>& reset = {}) {
+        std::vector<CompiledRule> old;
+        old.swap(_compiled);
+        _rules = &rules;
+        _wake = 0;
+        bool fresh[OMNI_MAX_DEVICES] = {false};
+        for(uint16_t s : reset) if(s < OMNI_MAX_DEVICES) { fresh[s] = true; _written[s] = NAN; _writtenAt[s] = 0; }
+        uint16_t count[OMNI_MAX_DEVICES] = {0};
+        size_t n = devices.size();
+
+        for(size_t r=0; r<rules.size(); r++) {
+            const Rule& rl = rules[r];
+            int src = devices.find(rl.srcId.c_str());
+            int tgt = devices.find(rl.tgtId.c_str());
+            RuleOp op = parseOp(rl.op);
+            RuleTrig trig = parseTrig(rl.trig);
+            if(src < 0 || tgt < 0 || op == OP_INVALID || trig == TRIG_INVALID) continue;
+            CompiledRule c = {(uint16_t)src, (uint16_t)tgt, (uint16_t)r, -1, op, rl.threshold, rl.actionVal};
+            c.trig = trig;
+            c.text = devices[tgt]->getType() == DISPLAY_DEV;
+            c.hyst = fabsf(rl.hyst); c.elseVal = rl.elseVal;
+            c.minOn = rl.minOn; c.minOff = rl.minOff; c.cooldown = rl.cooldown;
+            c.def = fingerprint(rl);
+            if(!fresh[src] && !fresh[tgt]) {
+                auto o = std::lower_bound(old.begin(), old.end(), c, before);
+                if(o != old.end() && o->src == c.src && o->rule == c.rule && o->tgt == c.tgt && o->def == c.def) {
+                    c.ch = o->ch; c.state = o->state; c.since = o->since;
+                    c.fired = o->fired; c.pending = o->pending;
+                    if(o->retry) wakeAt(c, o->retry);
+                }
+            }
+            _compiled.push_back(c);
+            count[src]++;
+        }
+
+        std::sort(_compiled.begin(), _compiled.end(), before);
+        _first[0] = 0;
+        for(size_t s=0; s<OMNI_MAX_DEVICES; s++) _first[s + 1] = _first[s] + count[s];
+
+        // Première évaluation : toutes les sources sont considérées comme modifiées
+        for(size_t s=0; s<n; s++) if(count[s]) notify(s);
+    }
+
+    // Appelé (depuis la tâche Sampler) quand les canaux d'un slot ont changé
+    void notify(size_t slot) {
+        if(slot < OMNI_MAX_DEVICES) _changed[slot / 32].fetch_or(1u << (slot % 32));
+    }
+
+    size_t size() const { return _compiled.size(); }
+
+    bool pending() const {
+        for(auto& c : _changed) if(c.load(std::memory_order_relaxed)) return true;
+        return _wake && (int32_t)(millis() - _wake) >= 0;
+    }
+
+    // Évalue uniquement les règles dont la source a changé ou dont une échéance est
+    // passée (sous mutex, comme compile()). fire(rule, sourceSample, value, action)
+    // est appelé pour chaque action émise ; renvoie leur nombre.
+    template<typename Fn>
+    size_t evaluate(const DeviceSnapshot& snap, Fn&& fire) {
+        size_t fired = 0;
+        uint32_t now = millis();
+        if(_wake && (int32_t)(now - _wake) >= 0) {
+            _wake = 0;
+            for(CompiledRule& c : _compiled) {
+                if(!c.retry) continue;
+                if((int32_t)(now - c.retry) >= 0) { c.retry = 0; notify(c.src); }
+                else wakeAt(c, c.retry);
+            }
+        }
+        DeviceSample s;
+        for(size_t w=0; w<(OMNI_MAX_DEVICES + 31) / 32; w++) {
+            uint32_t bits = _changed[w].exchange(0);
+            while(bits) {
+                size_t slot = w * 32 + __builtin_ctz(bits); bits &= bits - 1;
+                if(_first[slot] == _first[slot + 1]) continue;
+                if(!snap.read(slot, s) || s.stamp == 0) continue;
+                for(uint16_t k=_first[slot]; k<_first[slot + 1]; k++) {
+                    CompiledRule& c = _compiled[k];
+                    if(c.ch < 0) {
+                        // Résolution paresseuse : l'ordre des canaux est fixe par driver
+                        c.ch = s.channel((*_rules)[c.rule].param.c_str());
+                        if(c.ch < 0) continue;
+                    }
+                    if(c.ch >= s.nch || !(s.valid & (1 << c.ch))) continue;
+                    float v = s.val[c.ch];
+                    step(c, v, now);
+                    if(isnan(c.pending)) continue;
+                    if(c.fired && now - c.fired < c.cooldown) { wakeAt(c, c.fired + c.cooldown); continue; }
+                    float act = c.pending;
+                    c.pending = NAN;
+                    if(!c.text && targetState(snap, c.tgt) == act) continue;
+                    fire(c, s, v, act);
+                    c.fired = now ? now : 1;
+                    _written[c.tgt] = act; _writtenAt[c.tgt] = now;
+                    fired++;
+                }
+            }
+        }
+        return fired;
+    }
+
+#ifdef OMNI_BENCH
+    // Coût d'une passe complète (µs) selon le nombre de règles. Ancien checkRules() :
+    // scan des devices par id, Device::read() dans un StaticJsonDocument<512>, puis
+    // containsKey() et lecture de la clé. Nouveau : compile() puis evaluate() sur le
+    // snapshot. Les actions sont seulement comptées des deux côtés.
+    static void bench(Print& out) {
+        const size_t nDev = 40;
+        devicePool().setBypass(true);       // 40 devices : au-delà du pool
+        DeviceRegistry* reg = new DeviceRegistry();
+        DeviceSnapshot* snap = new DeviceSnapshot();
+        DeviceSample s;
+        for(size_t i=0; i<nDev; i++) {
+            memset(&s, 0, sizeof(s));
+            snprintf(s.id, sizeof(s.id), "relay_%u", (unsigned)i);
+            Device* d = DeviceFactory::create("RELAY", s.id, "Bench", 0);     // begin() non appelé : aucun accès GPIO
+            reg->push_back(d);
+            // Échantillon tel que le publie la tâche Sampler
+            Reading r;
+            d->sample(r);
+            const Channel* ch;
+            s.nch = d->channels(ch);
+            s.valid = r.valid;
+            for(uint8_t c=0; c<s.nch; c++) { strlcpy(s.key[c], ch[c].key, sizeof(s.key[0])); s.unit[c] = ch[c].unit; s.val[c] = r.val[c]; }
+            s.stamp = 1;
+            snap->publish(i, s);
+        }
+        snap->setCount(nDev);
+
+        out.println("[BENCH] rules  legacy_us  compile_us  evaluate_us");
+        for(size_t nRules : {10, 50, 100, 200, 400}) {
+            std::vector<Rule> rules;
+            for(size_t r=0; r<nRules; r++) {
+                rules.push_back({String("relay_") + (r % nDev), "val", (r & 1) ? ">" : "<", 0.5f,
+                                 String("relay_") + ((r + 1) % nDev), 1.0f});
+            }
+
+            volatile size_t sink = 0;
+            uint32_t t0 = micros();
+            StaticJsonDocument<512> doc;
+            for(auto& r : rules) {
+                Device* src = nullptr; Device* tgt = nullptr;
+                for(Device* d : *reg) {
+                    if(String(d->getId()) == r.srcId) src = d;     // getId() renvoyait une String
+                    if(String(d->getId()) == r.tgtId) tgt = d;
+                }
+                if(!src || !tgt) continue;
+                doc.clear();
+                JsonObject obj = doc.to<JsonObject>();
+                src->read(obj);
+                if(obj.containsKey(r.param)) {
+                    float val = obj[r.param];
+                    if((r.op == ">" && val > r.threshold) || (r.op == "<" && val < r.threshold)) sink++;
+                }
+            }
+            uint32_t legacy = micros() - t0;
+
+            RuleEngine* eng = new RuleEngine();
+            t0 = micros();
+            eng->compile(rules, *reg);
+            uint32_t compiled = micros() - t0;
+            auto fire = [&](const CompiledRule&, const DeviceSample&, float, float) { sink++; };
+            eng->evaluate(*snap, fire);     // Première passe : canaux résolus (une fois par règle)
+            for(size_t i=0; i<nDev; i++) eng->notify(i);
+            t0 = micros();
+            eng->evaluate(*snap, fire);
+            uint32_t evaluated = micros() - t0;
+            delete eng;
+
+            out.printf("[BENCH] %5u  %9u  %10u  %11u\n", (unsigned)nRules, legacy, compiled, evaluated);
+        }
+        reg->clear();
+        delete reg;
+        delete snap;
+        devicePool().setBypass(false);
+    }
+#endif
+};
@@ -0,0 +1,214 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <atomic>
+#include "OmniDrivers.h"
+#include "OmniRegistry.h"
+
+// ==========================================
+// ECHANTILLONNAGE (TÂCHE FREERTOS + SNAPSHOT)
+// ==========================================
+// Une seule tâche touche au matériel. Les consommateurs (API, WebSocket, règles)
+// lisent le snapshot sans prendre le mutex global.
+
+#ifndef OMNI_SAMPLE_JSON
+#define OMNI_SAMPLE_JSON 160
+#endif
+
+struct DeviceSample {
+    char id[OMNI_ID_LEN];
+    char name[OMNI_NAME_LEN];
+    char driver[OMNI_DRIVER_LEN];
+    int pin;
+    uint8_t nch;                        // Canaux déclarés par le driver (Device::channels())
+    uint8_t valid;                      // Bit c : val[c] mesuré (sinon NAN)
+    char key[OMNI_MAX_CHANNELS][OMNI_KEY_LEN];
+    uint8_t unit[OMNI_MAX_CHANNELS];    // ChannelUnit
+    float val[OMNI_MAX_CHANNELS];
+    char json[OMNI_SAMPLE_JSON];        // Sortie JSON du driver (Device::toJson()), déjà sérialisée
+    uint32_t stamp;                     // millis() du dernier échantillon (0 = jamais)
+
+    int channel(const char* k) const {
+        for(uint8_t i=0; i<nch; i++) if(strcmp(key[i], k) == 0) return i;
+        return -1;
+    }
+};
+
+// Seqlock : un seul écrivain (la tâche), lecteurs sans verrou qui réessaient
+// si une publication a eu lieu pendant la copie.
+class DeviceSnapshot {
+    struct Slot { std::atomic<uint32_t> seq{0}; DeviceSample data; };
+    Slot _slots[OMNI_MAX_DEVICES];
+    std::atomic<uint32_t> _count{0};
+public:
+    size_t count() const { return _count.load(std::memory_order_acquire); }
+    void setCount(size_t n) { _count.store(n, std::memory_order_release); }
+
+    void publish(size_t i, const DeviceSample& s) {
+        Slot& sl = _slots[i];
+        sl.seq.fetch_add(1, std::memory_order_acq_rel);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&sl.data, &s, sizeof(DeviceSample));
+        std::atomic_thread_fence(std::memory_order_release);
+        sl.seq.fetch_add(1, std::memory_order_release);
+    }
+
+    // Accès direct réservé à l'écrivain (tâche Sampler)
+    const DeviceSample& peek(size_t i) const { return _slots[i].data; }
+
+    // false aussi pour un slot libre (device retiré, id vide)
+    bool read(size_t i, DeviceSample& out) const {
+        if(i >= count()) return false;
+        const Slot& sl = _slots[i];
+        for(int tries=0; tries<16; tries++) {
+            uint32_t s1 = sl.seq.load(std::memory_order_acquire);
+            if(s1 & 1) { taskYIELD(); continue; }
+            memcpy(&out, &sl.data, sizeof(DeviceSample));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if(sl.seq.load(std::memory_order_relaxed) == s1) return out.id[0] != 0;
+        }
+        return false;
+    }
+};
+
+// Notifié depuis la tâche Sampler quand les valeurs d'un slot changent
+typedef void (*SampleHook)(size_t slot);
+// Reçoit chaque échantillon publié, changé ou non (historique, agrégats)
+typedef void (*SampleSink)(size_t slot, const DeviceSample& s);
+
+class Sampler {
+    static const size_t MAX_HOOKS = 4;
+    SampleHook _hooks[MAX_HOOKS] = {nullptr};
+    SampleSink _sinks[MAX_HOOKS] = {nullptr};
+    DeviceRegistry* _devices = nullptr;
+    SemaphoreHandle_t _mutex = nullptr;
+    TaskHandle_t _task = nullptr;
+    uint32_t _due[OMNI_MAX_DEVICES] = {0};
+    std::atomic<uint32_t> _kicked[(OMNI_MAX_DEVICES + 31) / 32];
+    DeviceSample _work;
+
+    static void taskEntry(void* arg) { static_cast<Sampler*>(arg)->run(); }
+
+    static void fillMeta(Device* d, DeviceSample& s) {
+        strlcpy(s.id, d->getId(), sizeof(s.id));
+        strlcpy(s.name, d->getName(), sizeof(s.name));
+        strlcpy(s.driver, d->getDriver(), sizeof(s.driver));
+        s.pin = d->getPin();
+    }
+
+    static bool changed(const DeviceSample& a, const DeviceSample& b) {
+        if(a.nch != b.nch || a.valid != b.valid || a.stamp == 0) return true;
+        for(uint8_t c=0; c<a.nch; c++) if((a.valid & (1 << c)) && a.val[c] != b.val[c]) return true;
+        return strcmp(a.json, b.json) != 0;
+    }
+
+    // Valeurs typées, puis JSON dérivé de la même mesure (un seul sample())
+    void sample(Device* d, DeviceSample& s) {
+        Reading r;
+        d->timedSample(r);
+        fillMeta(d, s);
+        const Channel* ch;
+        s.nch = min<uint8_t>(d->channels(ch), OMNI_MAX_CHANNELS);
+        s.valid = r.valid & (uint8_t)((1u << s.nch) - 1);
+        for(uint8_t c=0; c<s.nch; c++) {
+            strlcpy(s.key[c], ch[c].key, sizeof(s.key[0]));
+            s.unit[c] = ch[c].unit;
+            s.val[c] = (s.valid & (1 << c)) ? r.val[c] : NAN;
+        }
+        StaticJsonDocument<256> doc;
+        JsonObject obj = doc.to<JsonObject>();
+        d->toJson(r, obj);
+        if(serializeJson(obj, s.json, sizeof(s.json)) >= sizeof(s.json) - 1) strcpy(s.json, "{}");
+        s.stamp = millis();
+        if(s.stamp == 0) s.stamp = 1;
+    }
+
+    void run() {
+        for(;;) {
+            for(size_t w=0; w<(OMNI_MAX_DEVICES + 31) / 32; w++) {
+                uint32_t bits = _kicked[w].exchange(0);
+                while(bits) {
+                    int b = __builtin_ctz(bits); bits &= bits - 1;
+                    _due[w * 32 + b] = 0;
+                }
+            }
+
+            uint32_t wait = 1000;
+            for(size_t i=0; ; i++) {
+                metrics().take(_mutex);
+                if(i >= _devices->size() || i >= OMNI_MAX_DEVICES) { metrics().give(_mutex); break; }
+                Device* d = (*_devices)[i];
+                if(!d) { metrics().give(_mutex); continue; }
+                uint32_t now = millis();
+                // Événement matériel (réveil par ISR) : échéance avancée à celle que le driver demande
+                if(_due[i] && d->eventPending()) {
+                    uint32_t ev = now + d->samplePeriod();
+                    if((int32_t)(ev - _due[i]) < 0) _due[i] = ev;
+                }
+                bool due = (_due[i] == 0) || ((int32_t)(now - _due[i]) >= 0);
+                if(due) {
+                    sample(d, _work);
+                    _due[i] = millis() + d->samplePeriod();
+                    if(_due[i] == 0) _due[i] = 1;
+                    bool diff = changed(snapshot.peek(i), _work);
+                    snapshot.publish(i, _work);
+                    for(auto k : _sinks) if(k) k(i, _work);
+                    if(diff) for(auto h : _hooks) if(h) h(i);
+                }
+                uint32_t left = _due[i] - millis();
+                if((int32_t)left > 0 && left < wait) wait = left;
+                metrics().give(_mutex);
+            }
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait ? wait : 1));
+        }
+    }
+
+public:
+    DeviceSnapshot snapshot;
+
+    Sampler() { for(auto& k : _kicked) k.store(0); }
+
+    void begin(DeviceRegistry& devices, SemaphoreHandle_t mutex) {
+        _devices = &devices; _mutex = mutex;
+        reset();
+        xTaskCreatePinnedToCore(taskEntry, "sampler", 4096, this, 1, &_task, 1);
+        EdgeInput::wake(_task);     // Fronts des entrées sur interruption
+    }
+
+    // A appeler sous mutex après toute modification de la liste des devices
+    void reset() {
+        if(!_devices) return;
+        size_t n = min(_devices->size(), (size_t)OMNI_MAX_DEVICES);
+        for(size_t i=0; i<n; i++) resetSlot(i);
+    }
+
+    // Un seul slot ajouté, remplacé ou retiré (sous mutex) : les autres gardent leur échantillon
+    void resetSlot(size_t i) {
+        if(!_devices || i >= OMNI_MAX_DEVICES) return;
+        DeviceSample s;
+        memset(&s, 0, sizeof(s));
+        strcpy(s.json, "{}");
+        if(Device* d = (*_devices)[i]) fillMeta(d, s);
+        snapshot.publish(i, s);
+        _due[i] = 0;
+        snapshot.setCount(min(_devices->size(), (size_t)OMNI_MAX_DEVICES));
+        if(_task) xTaskNotifyGive(_task);
+    }
+
+    bool onChange(SampleHook hook) {
+        for(auto& h : _hooks) if(!h) { h = hook; return true; }
+        return false;
+    }
+
+    bool onSample(SampleSink sink) {
+        for(auto& k : _sinks) if(!k) { k = sink; return true; }
+        return false;
+    }
+
+    // Force un échantillonnage immédiat (ex: après un write())
+    void kick(size_t i) {
+        if(i >= OMNI_MAX_DEVICES) return;
+        _kicked[i / 32].fetch_or(1u << (i % 32));
+        if(_task) xTaskNotifyGive(_task);
+    }
+};
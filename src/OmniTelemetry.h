@@ -0,0 +1,327 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <ESPAsyncWebServer.h>
+#include <atomic>
+#include <vector>
+#include "OmniSampler.h"
+#include "OmniBinary.h"
+
+// ==========================================
+// TÉLÉMÉTRIE WEBSOCKET (DELTAS + KEYFRAMES)
+// ==========================================
+// Garde la dernière valeur envoyée par canal et ne pousse que ce qui a bougé
+// au-delà de la bande morte. Un keyframe complet part périodiquement et à
+// chaque nouvelle connexion pour resynchroniser les clients.
+//
+//   Keyframe : {"devices":[{"id":"dht_4","val":{"temp":24.5,"hum":60}}, ...]}
+//   Delta    : {"delta":1,"devices":[{"id":"dht_4","val":{"temp":24.7}}]}
+//
+// Les clients ayant négocié le protocole binaire (OmniBinary.h) reçoivent les
+// mêmes deltas/keyframes en trames TLV.
+
+class TelemetryPublisher {
+    static const size_t MAX_DEADBANDS = 8;
+    static const size_t MAX_CLIENTS = 8;
+    struct Sent { float val[OMNI_MAX_CHANNELS]; uint8_t nch; uint32_t textHash; bool valid; };
+    struct Deadband { char key[8]; float db; };
+    struct Client { uint32_t id; bool binary; };
+
+    AsyncWebSocket* _ws = nullptr;
+    const DeviceSnapshot* _snap = nullptr;
+    Sent _sent[OMNI_MAX_DEVICES];
+    uint8_t _schemaNch[OMNI_MAX_DEVICES];
+    std::atomic<uint32_t> _dirty[(OMNI_MAX_DEVICES + 31) / 32];
+    std::atomic<bool> _keyframeReq{true}, _schemaReq{true};
+    Deadband _deadbands[MAX_DEADBANDS];
+    size_t _nDeadbands = 0;
+    float _defaultDb = 0;
+    uint32_t _keyframeMs = 30000, _minIntervalMs = 50;
+    uint32_t _lastKeyframe = 0, _lastSend = 0;
+    Client _clients[MAX_CLIENTS];
+    size_t _nClients = 0;
+    portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+    std::vector<char> _txt;             // Trame JSON, capacité réutilisée d'un envoi à l'autre
+    std::vector<uint8_t> _bin;
+
+    // Écriture bornée dans _txt (comme OmniBin::Writer) : trame refusée si elle déborde
+    struct Text {
+        char* buf; size_t cap, len = 0; bool over = false;
+        Text(std::vector<char>& v) : buf(v.data()), cap(v.size()) {}
+        void add(const char* p, size_t n) {
+            if(over || len + n > cap) { over = true; return; }
+            memcpy(buf + len, p, n); len += n;
+        }
+        void add(const char* p) { add(p, strlen(p)); }
+        void num(float v) {
+            char tmp[16];
+            if(!isfinite(v)) { add("null", 4); return; }
+            add(tmp, snprintf(tmp, sizeof(tmp), "%.7g", v));
+        }
+        bool ok() const { return !over; }
+    };
+
+    // Borne d'une trame (keyframe ou delta) pour `n` devices
+    static size_t frameCap(size_t n) { return 32 + n * (OMNI_ID_LEN + OMNI_SAMPLE_JSON + OMNI_MAX_CHANNELS * (OMNI_KEY_LEN + 20)); }
+
+    float deadband(const char* key) const {
+        for(size_t i=0; i<_nDeadbands; i++) if(strcmp(_deadbands[i].key, key) == 0) return _deadbands[i].db;
+        return _defaultDb;
+    }
+
+    // Paire suivante de premier niveau du JSON d'un échantillon (objet plat sérialisé par
+    // le driver) : clé et valeur brute, sans décodage. nullptr en fin d'objet.
+    static const char* nextPair(const char* p, const char*& key, size_t& keyLen, const char*& val, size_t& valLen) {
+        while(*p == '{' || *p == ',' || *p == ' ') p++;
+        if(*p != '"') return nullptr;
+        key = ++p;
+        while(*p && *p != '"') p += (*p == '\\' && p[1]) ? 2 : 1;
+        keyLen = p - key;
+        if(*p++ != '"' || *p++ != ':') return nullptr;
+        val = p;
+        int depth = 0;
+        for(bool str = false; *p; p++) {
+            if(str) { if(*p == '\\' && p[1]) p++; else if(*p == '"') str = false; continue; }
+            if(*p == '"') str = true;
+            else if(*p == '{' || *p == '[') depth++;
+            else if((*p == '}' || *p == ']') && depth) depth--;
+            else if((*p == ',' || *p == '}') && !depth) break;
+        }
+        valLen = p - val;
+        return p;
+    }
+
+    static int channelOf(const DeviceSample& s, const char* key, size_t len) {
+        for(uint8_t c=0; c<s.nch; c++) if(len < OMNI_KEY_LEN && strncmp(s.key[c], key, len) == 0 && !s.key[c][len]) return c;
+        return -1;
+    }
+
+    static uint32_t fnv1a(const char* s, size_t n, uint32_t h = 2166136261u) {
+        while(n--) { h ^= (uint8_t)*s++; h *= 16777619u; }
+        return h;
+    }
+
+    // Ajoute les canaux d'un slot qui ont bougé (JSON si `t`, TLV si `w`) ; false si rien à envoyer.
+    // Canaux pris dans s.val[] ; du JSON du driver, seuls les champs hors canaux (texte,
+    // horodatages) sont parcourus, hachés et recopiés tels quels.
+    bool appendDelta(size_t i, const DeviceSample& s, Text* t, bool& first, OmniBin::Writer* w, uint8_t& nBin) {
+        Sent& p = _sent[i];
+        uint8_t mask = 0;
+        for(uint8_t c=0; c<s.nch; c++) {
+            if(!(s.valid & (1 << c))) continue;
+            bool moved = !p.valid || c >= p.nch || isnan(p.val[c]) ||
+                         fabsf(s.val[c] - p.val[c]) > deadband(s.key[c]);
+            if(moved) mask |= 1 << c;
+        }
+
+        uint32_t textHash = 2166136261u;
+        const char *key, *val; size_t keyLen, valLen;
+        for(const char* q = s.json; (q = nextPair(q, key, keyLen, val, valLen)); ) {
+            if(channelOf(s, key, keyLen) < 0) textHash = fnv1a(val, valLen, fnv1a(key, keyLen + 1, textHash));
+        }
+        bool textChanged = !p.valid || textHash != p.textHash;
+        if(!mask && !textChanged) return false;
+
+        if(t) {
+            size_t mark = t->len;
+            t->add(first ? "" : ",");
+            t->add("{\"id\":\""); t->add(s.id); t->add("\",\"val\":{");
+            bool any = false;
+            for(uint8_t c=0; c<s.nch; c++) {
+                if(!(mask & (1 << c))) continue;
+                t->add(any ? ",\"" : "\""); t->add(s.key[c]); t->add("\":");
+                t->num(s.val[c]);
+                any = true;
+            }
+            if(textChanged) {
+                for(const char* q = s.json; (q = nextPair(q, key, keyLen, val, valLen)); ) {
+                    if(channelOf(s, key, keyLen) >= 0) continue;
+                    t->add(any ? ",\"" : "\""); t->add(key, keyLen); t->add("\":"); t->add(val, valLen);
+                    any = true;
+                }
+            }
+            if(any) { t->add("}}"); first = false; }
+            else t->len = mark;
+        }
+        if(w && mask) { OmniBin::appendSample(*w, i, s, mask); nBin++; }
+
+        for(uint8_t c=0; c<s.nch; c++) {
+            if(mask & (1 << c)) p.val[c] = s.val[c];
+            else if(!(s.valid & (1 << c))) p.val[c] = NAN;     // Envoyé dès sa première mesure
+        }
+        p.nch = s.nch; p.textHash = textHash; p.valid = true;
+        return true;
+    }
+
+    // Copie de la table des clients (modifiée depuis la tâche async_tcp)
+    size_t clients(Client* out, size_t& nJson, size_t& nBin) {
+        portENTER_CRITICAL(&_lock);
+        size_t n = _nClients;
+        memcpy(out, _clients, n * sizeof(Client));
+        portEXIT_CRITICAL(&_lock);
+        nJson = nBin = 0;
+        for(size_t i=0; i<n; i++) (out[i].binary ? nBin : nJson)++;
+        return n;
+    }
+
+    void send(const Client* cl, size_t n, size_t nJson, size_t nBin, size_t txtLen, size_t binLen) {
+        if(txtLen && nJson) {
+            if(!nBin) _ws->textAll(_txt.data(), txtLen);
+            else for(size_t i=0; i<n; i++) if(!cl[i].binary) _ws->text(cl[i].id, _txt.data(), txtLen);
+        }
+        if(binLen && nBin) {
+            if(!nJson) _ws->binaryAll((const char*)_bin.data(), binLen);
+            else for(size_t i=0; i<n; i++) if(cl[i].binary) _ws->binary(cl[i].id, (const char*)_bin.data(), binLen);
+        }
+        // Profondeur des files d'envoi après publication (clients lents)
+        for(size_t i=0; i<n; i++) {
+            AsyncWebSocketClient* c = _ws->client(cl[i].id);
+            if(c) metrics().record(Metrics::H_WS_QUEUE, c->queueLen());
+        }
+    }
+
+    void sendSchema(const Client* cl, size_t n, size_t nJson, size_t nBin) {
+        _bin.resize(2 + _snap->count() * (4 + OMNI_ID_LEN + OMNI_DRIVER_LEN + OMNI_MAX_CHANNELS * 8));
+        OmniBin::Writer w(_bin.data(), _bin.size());
+        OmniBin::encodeSchema(w, *_snap, _schemaNch);
+        if(w.ok()) send(cl, n, nJson, nBin, 0, w.length());
+    }
+
+    void sendKeyframe(const Client* cl, size_t n, size_t nJson, size_t nBin) {
+        _txt.resize(nJson ? frameCap(_snap->count()) : 0);
+        Text t(_txt);
+        t.add("{\"devices\":[");
+        _bin.resize(2 + _snap->count() * (2 + OMNI_MAX_CHANNELS * 5));
+        OmniBin::Writer w(_bin.data(), _bin.size());
+        size_t pos = OmniBin::beginSamples(w, OmniBin::MSG_KEYFRAME);
+        uint8_t nBinDev = 0;
+
+        DeviceSample s; bool first = true;
+        for(size_t i=0; i<_snap->count(); i++) {
+            if(!_snap->read(i, s)) continue;
+            t.add(first ? "{\"id\":\"" : ",{\"id\":\""); t.add(s.id); t.add("\",\"val\":"); t.add(s.json); t.add("}");
+            first = false;
+            _sent[i].valid = false;
+            if(s.stamp) {
+                // Recalcule l'état "envoyé" pour que les deltas suivants partent de ce keyframe
+                bool dummy = true;
+                appendDelta(i, s, nullptr, dummy, nBin ? &w : nullptr, nBinDev);
+            }
+        }
+        t.add("]}");
+        w.patch(pos, nBinDev);
+        for(auto& d : _dirty) d.store(0);
+        send(cl, n, nJson, nBin, t.ok() ? t.len : 0, w.ok() ? w.length() : 0);
+        _lastKeyframe = _lastSend = millis();
+    }
+
+public:
+    TelemetryPublisher() {
+        for(auto& d : _dirty) d.store(0);
+        memset(_sent, 0, sizeof(_sent));
+        memset(_schemaNch, 0, sizeof(_schemaNch));
+    }
+
+    void begin(AsyncWebSocket& ws, const DeviceSnapshot& snap) { _ws = &ws; _snap = &snap; }
+
+    // {"deadband":0.1,"keyframe":30000,"channels":{"temp":0.2,"lux":5}}
+    void configure(JsonObjectConst cfg) {
+        if(cfg.isNull()) return;
+        _defaultDb = cfg["deadband"] | 0.0f;
+        _keyframeMs = max<uint32_t>(1000, cfg["keyframe"] | 30000);
+        _nDeadbands = 0;
+        for(JsonPairConst kv : cfg["channels"].as<JsonObjectConst>()) {
+            if(_nDeadbands >= MAX_DEADBANDS) break;
+            strlcpy(_deadbands[_nDeadbands].key, kv.key().c_str(), sizeof(_deadbands[0].key));
+            _deadbands[_nDeadbands++].db = kv.value() | 0.0f;
+        }
+    }
+
+    void save(JsonObject cfg) const {
+        cfg["deadband"] = _defaultDb;
+        cfg["keyframe"] = _keyframeMs;
+        JsonObject ch = cfg.createNestedObject("channels");
+        for(size_t i=0; i<_nDeadbands; i++) ch[_deadbands[i].key] = _deadbands[i].db;
+    }
+
+    // Hook Sampler (tâche d'échantillonnage)
+    void notify(size_t slot) {
+        if(slot < OMNI_MAX_DEVICES) _dirty[slot / 32].fetch_or(1u << (slot % 32));
+    }
+
+    // Nouvelle connexion ou liste de devices modifiée (schema = la liste a changé)
+    void requestKeyframe(bool schema = false) {
+        if(schema) _schemaReq = true;
+        _keyframeReq = true;
+    }
+
+    // --- Suivi des clients (événements WebSocket, tâche async_tcp) ---
+    void onConnect(uint32_t id) {
+        portENTER_CRITICAL(&_lock);
+        if(_nClients < MAX_CLIENTS) _clients[_nClients++] = {id, false};
+        portEXIT_CRITICAL(&_lock);
+        requestKeyframe();
+    }
+
+    void onDisconnect(uint32_t id) {
+        portENTER_CRITICAL(&_lock);
+        for(size_t i=0; i<_nClients; i++) if(_clients[i].id == id) { _clients[i] = _clients[--_nClients]; break; }
+        portEXIT_CRITICAL(&_lock);
+    }
+
+    // Trame HELLO reçue : ce client passe en binaire
+    void setBinary(uint32_t id) {
+        portENTER_CRITICAL(&_lock);
+        for(size_t i=0; i<_nClients; i++) if(_clients[i].id == id) _clients[i].binary = true;
+        portEXIT_CRITICAL(&_lock);
+        requestKeyframe(true);
+    }
+
+    // Message JSON hors télémétrie (ex: progression du scan I2C) : clients texte uniquement
+    void pushText(const String& msg) {
+        if(!_ws) return;
+        Client cl[MAX_CLIENTS]; size_t nJson, nBin;
+        size_t n = clients(cl, nJson, nBin);
+        if(!nJson) return;
+        if(!nBin) _ws->textAll(msg);
+        else for(size_t i=0; i<n; i++) if(!cl[i].binary) _ws->text(cl[i].id, msg);
+    }
+
+    // A appeler depuis loop() : envoie immédiatement les changements (regroupés sur _minIntervalMs)
+    void loop() {
+        if(!_ws) return;
+        Client cl[MAX_CLIENTS]; size_t nJson, nBin;
+        size_t n = clients(cl, nJson, nBin);
+        metrics().wsClients = n;
+        if(n == 0) { _keyframeReq = true; return; }
+
+        uint32_t now = millis();
+        if(nBin && _schemaReq.exchange(false)) sendSchema(cl, n, nJson, nBin);
+        if(_keyframeReq.exchange(false) || now - _lastKeyframe >= _keyframeMs) { sendKeyframe(cl, n, nJson, nBin); return; }
+        if(now - _lastSend < _minIntervalMs) return;
+
+        _txt.resize(nJson ? frameCap(_snap->count()) : 0);
+        Text t(_txt);
+        t.add("{\"delta\":1,\"devices\":[");
+        _bin.resize(2 + _snap->count() * (2 + OMNI_MAX_CHANNELS * 5));
+        OmniBin::Writer w(_bin.data(), _bin.size());
+        size_t pos = OmniBin::beginSamples(w, OmniBin::MSG_DELTA);
+        bool first = true; uint8_t nBinDev = 0;
+        DeviceSample s;
+        for(size_t wd=0; wd<(OMNI_MAX_DEVICES + 31) / 32; wd++) {
+            uint32_t bits = _dirty[wd].exchange(0);
+            while(bits) {
+                size_t i = wd * 32 + __builtin_ctz(bits); bits &= bits - 1;
+                if(!_snap->read(i, s) || !s.stamp) continue;
+                if(nBin && s.nch != _schemaNch[i]) _schemaReq = true;   // Canaux découverts après le schéma
+                appendDelta(i, s, nJson ? &t : nullptr, first, nBin ? &w : nullptr, nBinDev);
+            }
+        }
+        w.patch(pos, nBinDev);
+        if(first && !nBinDev) return;
+        t.add("]}");
+        if(!t.ok() || !w.ok()) requestKeyframe();     // Trame tronquée : resynchronisation
+        send(cl, n, nJson, nBin, (!first && t.ok()) ? t.len : 0, (nBinDev && w.ok()) ? w.length() : 0);
+        _lastSend = now;
+    }
+};
@@ -4,184 +4,195 @@
 #include <LittleFS.h>
 #include <ArduinoJson.h>
 #include <WiFiManager.h>
-#include <Wire.h>
 #include "OmniDrivers.h"
+#include "OmniI2C.h"
+#include "OmniI2CScan.h"
+#include "OmniRegistry.h"
+#include "OmniSampler.h"
+#include "OmniRules.h"
+#include "OmniTelemetry.h"
+#include "OmniBinary.h"
+#include "OmniHistory.h"
+#include "OmniConfig.h"
+#include "OmniControl.h"
+#include "OmniMetrics.h"
+#include "OmniAssets.h"
 
 // --- GLOBALES ---
-std::vector<Device*> devices;
+DeviceRegistry devices;
 AsyncWebServer server(80);
 AsyncWebSocket ws("/ws");
 SemaphoreHandle_t mutex;
+Sampler sampler;
 
-// Structure pour les règles d'automatisation
-struct Rule { String srcId; String param; String op; float threshold; String tgtId; float actionVal; };
 std::vector<Rule> rules;
-
-// --- UTILS & SÉCURITÉ ---
-bool isI2CDriver(String type) {
-    return (type == "INA219" || type == "BME280" || type == "BH1750" || type == "LCD_I2C" || type == "OLED");
-}
-
-bool isOutputDevice(String type) {
-    return (type == "RELAY" || type == "VALVE" || type == "LOCK" || type == "SERVO" || type == "NEOPIXEL");
-}
-
-bool isPinValid(int pin, String type) {
-    // 1. Validation I2C (Adresses)
-    if(isI2CDriver(type)) return (pin >= 0x01 && pin <= 0x77);
-    
-    // 2. Validation GPIO Hardware
-    if (pin < 0 || pin > 39) return false;
-    // Pins interdits (Flash SPI, UART0)
-    if (pin == 1 || pin == 3 || (pin >= 6 && pin <= 11)) return false; 
-    
-    // 3. Protection INPUT ONLY (34, 35, 36, 39 ne peuvent pas être des sorties)
-    if (isOutputDevice(type)) {
-        if (pin == 34 || pin == 35 || pin == 36 || pin == 39) return false;
-    }
-    
-    return true;
-}
-
-void clearDevices() {
-    for(auto d : devices) delete d;
-    devices.clear();
-}
+RuleEngine ruleEngine;
+TelemetryPublisher telemetry;
+History history;
 
 // --- SCANNER I2C ---
-String scanI2C() {
-    DynamicJsonDocument* doc = new DynamicJsonDocument(2048);
-    JsonArray arr = doc->createNestedArray("i2c_devices");
-    
-    for(byte address = 1; address < 127; address++) {
-        Wire.beginTransmission(address);
-        if (Wire.endTransmission() == 0) {
-            JsonObject obj = arr.createNestedObject();
-            obj["addr_dec"] = address;
-            char hexStr[5]; sprintf(hexStr, "0x%02X", address);
-            obj["addr_hex"] = String(hexStr);
-            
-            if(address == 0x27) obj["hint"] = "LCD 1602";
-            else if(address == 0x3C) obj["hint"] = "OLED SSD1306";
-            else if(address == 0x40) obj["hint"] = "INA219 Power";
-            else if(address == 0x76) obj["hint"] = "BME280";
-            else if(address == 0x23) obj["hint"] = "BH1750";
-            else obj["hint"] = "Unknown";
-        }
-    }
-    String output; serializeJson(*doc, output);
-    delete doc;
-    return output;
-}
+I2CScanJob i2cScan;
 
 // --- CONFIGURATION (Load/Save) ---
+// Écriture en flux : un petit document par élément, jamais la config entière en RAM
 void saveConfig() {
     File f = LittleFS.open("/config.json", "w");
     if(!f) return;
     
-    DynamicJsonDocument* doc = new DynamicJsonDocument(8192);
-    JsonArray devArr = doc->createNestedArray("devices");
-    
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    for(auto d : devices) {
-        JsonObject obj = devArr.createNestedObject();
-        obj["id"] = d->getId(); obj["driver"] = d->getDriver(); 
-        obj["name"] = d->getName(); obj["pin"] = d->getPin();
+    StaticJsonDocument<384> doc;
+    f.print("{\"devices\":[");
+    metrics().take(mutex);
+    bool first = true;
+    for(Device* d : devices) {
+        if(!d) continue;
+        doc.clear();
+        doc["id"] = d->getId(); doc["driver"] = d->getDriver(); 
+        doc["name"] = d->getName(); doc["pin"] = d->getPin();
+        if(!d->getOptions(doc.createNestedObject("opts"))) doc.remove("opts");
+        if(!first) f.print(",");
+        first = false;
+        serializeJson(doc, f);
     }
-    xSemaphoreGive(mutex);
 
     // Sauvegarde des règles (si implémenté côté HTML futur)
-    JsonArray ruleArr = doc->createNestedArray("rules");
-    for(auto r : rules) {
-        JsonObject obj = ruleArr.createNestedObject();
-        obj["src"] = r.srcId; obj["prm"] = r.param; 
-        obj["op"] = r.op; obj["val"] = r.threshold;
-        obj["tgt"] = r.tgtId; obj["act"] = r.actionVal;
+    f.print("],\"rules\":[");
+    for(size_t i=0; i<rules.size(); i++) {
+        const Rule& r = rules[i];
+        doc.clear();
+        doc["src"] = r.srcId; doc["prm"] = r.param; 
+        doc["op"] = r.op; doc["val"] = r.threshold;
+        doc["tgt"] = r.tgtId; doc["act"] = r.actionVal;
+        // Champs optionnels : seulement s'ils diffèrent du défaut
+        if(r.trig != "level") doc["trig"] = r.trig;
+        if(r.hyst) doc["hyst"] = r.hyst;
+        if(r.minOn) doc["on_ms"] = r.minOn;
+        if(r.minOff) doc["off_ms"] = r.minOff;
+        if(r.cooldown) doc["cool_ms"] = r.cooldown;
+        if(!isnan(r.elseVal)) doc["else"] = r.elseVal;
+        if(i) f.print(",");
+        serializeJson(doc, f);
     }
+    metrics().give(mutex);
 
-    serializeJson(*doc, f);
-    delete doc;
+    f.print("],\"telemetry\":");
+    doc.clear();
+    telemetry.save(doc.to<JsonObject>());
+    serializeJson(doc, f);
+    f.print("}");
     f.close();
 }
 
+// Slots touchés par un diff (sous mutex) : règles recompilées (état gardé hors slots recréés),
+// échantillon et historique repartent de zéro
+void commitDiff(const DeviceDiff& diff) {
+    ruleEngine.compile(rules, devices, diff.reset);
+    for(uint16_t slot : diff.reset) { history.clear(slot); sampler.resetSlot(slot); }
+    history.fit(devices);
+    for(uint16_t slot : diff.touched) sampler.kick(slot);
+}
+
+// Applique la configuration validée : seuls les devices modifiés sont recréés
+void applyConfig(ConfigIngest& cfg) {
+    metrics().take(mutex);
+    DeviceDiff diff;
+    diff.apply(devices, cfg.devices);
+    if(cfg.hasRules) rules = std::move(cfg.rules);
+    if(cfg.telemetry.length()) {
+        StaticJsonDocument<512> doc;
+        if(!deserializeJson(doc, cfg.telemetry)) telemetry.configure(doc.as<JsonObjectConst>());
+    }
+    commitDiff(diff);
+    metrics().give(mutex);
+    telemetry.requestKeyframe(true);
+    Serial.printf("Config: %u ajoutés, %u recréés, %u renommés, %u retirés, %u inchangés, %u en échec\n",
+                  diff.added, diff.replaced, diff.renamed, diff.removed, diff.kept, diff.failed);
+}
+
 void loadConfig() {
     if(!LittleFS.exists("/config.json")) return;
     File f = LittleFS.open("/config.json", "r");
-    
-    DynamicJsonDocument* doc = new DynamicJsonDocument(8192);
-    DeserializationError error = deserializeJson(*doc, f);
-    f.close();
+    if(!f) return;
 
-    if(error) { delete doc; return; }
+    ConfigIngest cfg(false);
+    uint8_t buf[256];
+    bool ok = cfg.begin(f.size());
+    while(ok && f.available()) ok = cfg.feed(buf, f.read(buf, sizeof(buf)));
+    f.close();
 
-    JsonArray arr = (*doc)["devices"];
-    for(JsonObject obj : arr) {
-        String type = obj["driver"]; int pin = obj["pin"];
-        if(isPinValid(pin, type)) {
-            Device* d = DeviceFactory::create(type, obj["id"], obj["name"], pin);
-            if(d) { d->begin(); devices.push_back(d); }
-        }
-    }
-    
-    rules.clear();
-    JsonArray rArr = (*doc)["rules"];
-    for(JsonObject obj : rArr) {
-        rules.push_back({obj["src"], obj["prm"], obj["op"], obj["val"], obj["tgt"], obj["act"]});
-    }
-    delete doc;
+    if(!ok || !cfg.finish()) { Serial.println("Config invalide: " + cfg.error); return; }
+    applyConfig(cfg);
 }
 
 // --- MOTEUR D'AUTOMATISATION ---
+// Événementiel : le Sampler signale les slots modifiés, seules les règles
+// dont la source a changé sont évaluées.
+void onSampleChanged(size_t slot) { ruleEngine.notify(slot); telemetry.notify(slot); }
+void onSample(size_t slot, const DeviceSample& s) { history.record(slot, s); }
+
 void checkRules() {
-    static unsigned long lastCheck = 0;
-    // Vérification toutes les 500ms pour ne pas saturer le CPU
-    if(millis() - lastCheck < 500) return;
-    lastCheck = millis();
+    if(!ruleEngine.pending()) return;
 
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    
-    // On utilise un petit document statique pour lire les valeurs sans allocation lourde
-    StaticJsonDocument<512> doc;
-    
-    for(auto& r : rules) {
-        Device* src = nullptr; Device* tgt = nullptr;
-        // Recherche des devices par ID
-        for(auto d : devices) { 
-            if(d->getId() == r.srcId) src = d; 
-            if(d->getId() == r.tgtId) tgt = d; 
-        }
+    metrics().take(mutex);
+    ruleEngine.evaluate(sampler.snapshot, [](const CompiledRule& r, const DeviceSample& src, float val, float act) {
+        Device* tgt = devices[r.tgt];
+        if(!tgt) return;
+        if(r.text) tgt->timedWriteText(String(src.name) + ": " + String(val));
+        else tgt->timedWrite("set", act);
+        sampler.kick(r.tgt);
+    });
+    metrics().give(mutex);
+}
 
-        if(src && tgt) {
-            doc.clear(); 
-            JsonObject obj = doc.to<JsonObject>(); 
-            src->read(obj); // Lecture non-bloquante (cache)
-            
-            if(obj.containsKey(r.param)) {
-                float val = obj[r.param];
-                bool trig = (r.op == ">" && val > r.threshold) || (r.op == "<" && val < r.threshold);
-                
-                if(trig) {
-                    // Action simple
-                    if(tgt->getType() == DISPLAY_DEV) tgt->writeText(src->getName() + ": " + String(val));
-                    else tgt->write("set", r.actionVal);
-                }
-            }
-        }
+// --- COMMANDES BINAIRES (WebSocket) ---
+uint8_t handleBinaryCommand(const OmniBin::Command& c) {
+    uint8_t status = OmniBin::ACK_UNKNOWN_SLOT;
+    metrics().take(mutex);
+    if(Device* d = devices[c.slot]) {
+        if(c.isText) d->timedWriteText(c.text);
+        else d->timedWrite(c.op == OmniBin::OP_TOGGLE ? "toggle" : "set", c.val);
+        sampler.kick(c.slot);
+        status = OmniBin::ACK_OK;
+    }
+    metrics().give(mutex);
+    return status;
+}
+
+// --- COMMANDES GROUPÉES (HTTP / WebSocket texte) ---
+String handleControlBatch(const char* json, size_t len, int& code) {
+    ControlBatch b;
+    code = 400;
+    if(b.parse(json, len)) {
+        metrics().take(mutex);
+        bool ok = b.apply(devices, sampler);
+        metrics().give(mutex);
+        code = ok ? 200 : 404;
     }
-    xSemaphoreGive(mutex);
+    return b.ack();
 }
 
 // --- SETUP ---
 void setup() {
     Serial.begin(115200);
     mutex = xSemaphoreCreateMutex();
+    beginDevicePools();
     
-    // Init I2C
-    Wire.begin();
+    // Init I2C : la tâche bus doit exister avant le begin() des drivers
+    i2cBus().begin();
     
     if(!LittleFS.begin(true)) Serial.println("LITTLEFS Mount Failed");
 
+    history.begin();
     loadConfig();
+    sampler.onChange(onSampleChanged);
+    sampler.onSample(onSample);
+    sampler.begin(devices, mutex);
+
+#ifdef OMNI_BENCH
+    benchDevicePool(Serial);    // En premier : tas encore peu troué par les autres benchmarks
+    RuleEngine::bench(Serial);
+    OmniBin::bench(Serial);
+    benchRegistry(Serial);
+#endif
 
     WiFiManager wm;
     wm.setClass("invert"); // Dark theme
@@ -196,122 +207,233 @@ void setup() {
         AsyncResponseStream *res = req->beginResponseStream("application/json");
         res->print("{\"devices\":[");
         
-        xSemaphoreTake(mutex, portMAX_DELAY);
-        for(size_t i=0; i<devices.size(); i++) {
-            Device* d = devices[i];
-            res->print("{");
-            res->printf("\"id\":\"%s\",\"name\":\"%s\",\"driver\":\"%s\",\"pin\":%d,\"val\":", 
-                d->getId().c_str(), d->getName().c_str(), d->getDriver().c_str(), d->getPin());
-            
-            StaticJsonDocument<256> smallDoc;
-            JsonObject val = smallDoc.to<JsonObject>();
-            d->read(val);
-            serializeJson(val, *res);
-            
-            res->print("}");
-            if(i < devices.size()-1) res->print(",");
+        // Lecture du snapshot : pas de mutex, pas d'accès bus
+        DeviceSample s; bool first = true;
+        for(size_t i=0; i<sampler.snapshot.count(); i++) {
+            if(!sampler.snapshot.read(i, s)) continue;
+            if(!first) res->print(",");
+            first = false;
+            res->printf("{\"id\":\"%s\",\"name\":\"%s\",\"driver\":\"%s\",\"pin\":%d,\"val\":%s}", 
+                s.id, s.name, s.driver, s.pin, s.json);
         }
-        xSemaphoreGive(mutex);
         
         res->print("]}");
         req->send(res);
     });
 
+    // --- API DRIVERS ---
+    // Types disponibles, capacités et broches/adresses acceptées (table DRIVERS)
+    server.on("/api/drivers", HTTP_GET, [](AsyncWebServerRequest *req){
+        AsyncResponseStream *res = req->beginResponseStream("application/json");
+        driversJson(*res);
+        req->send(res);
+    });
+
+    // --- API HISTORIQUE ---
+    // /api/history?id=dht_4&ch=temp&from=0&res=raw|1m|15m  (from/t en secondes depuis le boot)
+    server.on("/api/history", HTTP_GET, [](AsyncWebServerRequest *req){
+        if(!req->hasParam("id") || !req->hasParam("ch")) { req->send(400, "text/plain", "id & ch requis"); return; }
+        String id = req->getParam("id")->value();
+        String chp = req->getParam("ch")->value();
+        HistoryRes res;
+        if(!History::parseRes(req->hasParam("res") ? req->getParam("res")->value() : String(""), res)) {
+            req->send(400, "text/plain", "res invalide"); return;
+        }
+        uint32_t from = req->hasParam("from") ? req->getParam("from")->value().toInt() : 0;
+
+        metrics().take(mutex);
+        int slot = devices.find(id.c_str());
+        metrics().give(mutex);
+        DeviceSample s;
+        if(slot < 0 || !sampler.snapshot.read(slot, s) || id != s.id) { req->send(404, "text/plain", "Device inconnu"); return; }
+        int ch = s.channel(chp.c_str());
+        if(ch < 0 && chp.length() && isDigit(chp[0]) && chp.toInt() < s.nch) ch = chp.toInt();
+        if(ch < 0) { req->send(404, "text/plain", "Canal inconnu"); return; }
+        if(!history.has(slot, ch)) { req->send(503, "text/plain", "Pas d'historique pour ce canal (mémoire pleine)"); return; }
+        req->send(history.stream(req, s.id, s.key[ch], slot, ch, res, from));
+    });
+
+    // --- API MÉTRIQUES ---
+    // /api/metrics (JSON) ou /api/metrics?format=prometheus (aussi choisi si Accept: text/plain)
+    server.on("/api/metrics", HTTP_GET, [](AsyncWebServerRequest *req){
+        bool prom = false;
+        if(req->hasParam("format")) prom = req->getParam("format")->value() == "prometheus";
+        else if(const AsyncWebHeader* h = req->getHeader("Accept")) prom = h->value().indexOf("text/plain") >= 0;
+        req->send(metrics().stream(req, prom));
+    });
+
     // --- API SCAN I2C ---
+    // Job en tâche de fond : renvoie l'état et le dernier résultat en cache,
+    // ?refresh=1 (ou aucun résultat encore) lance un nouveau scan (202)
     server.on("/api/scan", HTTP_GET, [](AsyncWebServerRequest *req){
-        xSemaphoreTake(mutex, portMAX_DELAY);
-        String res = scanI2C();
-        xSemaphoreGive(mutex);
-        req->send(200, "application/json", res);
+        bool started = false;
+        if(!i2cScan.running() && (req->hasParam("refresh") || !i2cScan.hasResult())) { i2cScan.start(); started = true; }
+        AsyncResponseStream *res = req->beginResponseStream("application/json");
+        if(started) res->setCode(202);
+        i2cScan.json(*res);
+        req->send(res);
+    });
+
+    // --- API BUS I2C ---
+    // GET : vitesse et compteurs ; POST hz=100000|400000|1000000
+    server.on("/api/i2c", HTTP_GET | HTTP_POST, [](AsyncWebServerRequest *req){
+        if(req->method() == HTTP_POST) {
+            uint32_t hz = req->hasParam("hz", true) ? req->getParam("hz", true)->value().toInt() : 0;
+            if(!i2cBus().setClock(hz)) { req->send(400, "text/plain", "hz: 100000, 400000 ou 1000000"); return; }
+        }
+        char buf[128];
+        snprintf(buf, sizeof(buf), "{\"hz\":%u,\"pending\":%u,\"transactions\":%u,\"errors\":%u,\"dropped\":%u}",
+                 (unsigned)i2cBus().clock(), (unsigned)i2cBus().pending(), (unsigned)i2cBus().transactions,
+                 (unsigned)i2cBus().errors, (unsigned)i2cBus().dropped);
+        req->send(200, "application/json", buf);
     });
 
     // --- API CONTROL ---
     server.on("/api/control", HTTP_POST, [](AsyncWebServerRequest *req){
         if(req->hasParam("id", true)) {
             String id = req->getParam("id", true)->value();
-            xSemaphoreTake(mutex, portMAX_DELAY);
-            for(auto d : devices) {
-                if(d->getId() == id) {
-                    if(req->hasParam("text", true)) d->writeText(req->getParam("text", true)->value());
-                    else if(req->hasParam("cmd", true)) {
-                        float v = req->hasParam("val", true) ? req->getParam("val", true)->value().toFloat() : 0;
-                        d->write(req->getParam("cmd", true)->value(), v);
-                    }
+            metrics().take(mutex);
+            int slot = devices.find(id.c_str());
+            if(slot >= 0) {
+                Device* d = devices[slot];
+                if(req->hasParam("text", true)) d->timedWriteText(req->getParam("text", true)->value());
+                else if(req->hasParam("cmd", true)) {
+                    float v = req->hasParam("val", true) ? req->getParam("val", true)->value().toFloat() : 0;
+                    d->timedWrite(req->getParam("cmd", true)->value(), v);
                 }
+                sampler.kick(slot);
             }
-            xSemaphoreGive(mutex);
+            metrics().give(mutex);
             req->send(200);
         } else req->send(400);
     });
 
+    // --- API DEVICE ---
+    // Modification d'un seul device, sans toucher aux autres :
+    // PUT id, driver, pin, name, opts (création ou mise à jour) ; DELETE id
+    server.on("/api/device", HTTP_PUT | HTTP_DELETE, [](AsyncWebServerRequest *req){
+        auto param = [req](const char* k) -> String {
+            if(req->hasParam(k, true)) return req->getParam(k, true)->value();
+            return req->hasParam(k) ? req->getParam(k)->value() : String();
+        };
+        String id = param("id");
+        if(!id.length()) { req->send(400, "text/plain", "id requis"); return; }
+
+        DeviceDiff diff;
+        metrics().take(mutex);
+        if(req->method() == HTTP_DELETE) {
+            bool found = diff.remove(devices, id.c_str());
+            if(found) commitDiff(diff);
+            metrics().give(mutex);
+            if(!found) { req->send(404, "text/plain", "Device inconnu"); return; }
+        } else {
+            // Champs absents d'une mise à jour : valeurs actuelles
+            Device* cur = devices.get(id.c_str());
+            String name = param("name"), driver = param("driver"), pin = param("pin");
+            ConfigIngest::DeviceEntry e;
+            strlcpy(e.id, id.c_str(), sizeof(e.id));
+            strlcpy(e.name, name.length() || !cur ? name.c_str() : cur->getName(), sizeof(e.name));
+            strlcpy(e.driver, driver.length() || !cur ? driver.c_str() : cur->getDriver(), sizeof(e.driver));
+            e.pin = pin.length() || !cur ? (pin.length() ? pin.toInt() : -1) : cur->getPin();
+            strlcpy(e.opts, param("opts").c_str(), sizeof(e.opts));
+            String why = ConfigIngest::validateLive(e, devices);
+            if(!why.length()) { diff.put(devices, e); commitDiff(diff); }
+            metrics().give(mutex);
+            if(why.length()) { req->send(400, "text/plain", why); return; }
+            if(diff.failed) { req->send(500, "text/plain", "Création impossible"); saveConfig(); return; }
+        }
+        if(diff.changed()) { saveConfig(); telemetry.requestKeyframe(true); }
+        req->send(200, "text/plain", "Saved");
+    });
+
+    // --- API BATCH ---
+    // Lot de commandes JSON (format dans OmniControl.h), une seule prise du mutex
+    server.on("/api/batch", HTTP_POST, [](AsyncWebServerRequest *req){
+        char* body = (char*)req->_tempObject;
+        if(!body) { req->send(req->contentLength() > OMNI_BATCH_MAX_BODY ? 413 : 400, "text/plain", "Corps manquant ou trop grand"); return; }
+        int code;
+        String ack = handleControlBatch(body, req->contentLength(), code);
+        req->send(code, "application/json", ack);
+    }, nullptr, [](AsyncWebServerRequest *req, uint8_t *data, size_t len, size_t index, size_t total){
+        // Libéré avec la requête (free)
+        if(index == 0 && total <= OMNI_BATCH_MAX_BODY) req->_tempObject = malloc(total + 1);
+        char* body = (char*)req->_tempObject;
+        if(body && index + len <= total) { memcpy(body + index, data, len); body[index + len] = 0; }
+    });
+
     // --- API CONFIG ---
-    server.onRequestBody([](AsyncWebServerRequest *req, uint8_t *data, size_t len, size_t index, size_t total){
-        if(req->url() == "/api/config") {
-            DynamicJsonDocument* doc = new DynamicJsonDocument(8192);
-            DeserializationError error = deserializeJson(*doc, data);
-            
-            if (!error) {
-                xSemaphoreTake(mutex, portMAX_DELAY);
-                clearDevices(); 
-                JsonArray arr = (*doc)["devices"];
-                for(JsonObject obj : arr) {
-                     String type = obj["driver"]; int pin = obj["pin"];
-                     if (isPinValid(pin, type)) {
-                        Device* d = DeviceFactory::create(type, obj["id"], obj["name"], pin);
-                        if(d) { d->begin(); devices.push_back(d); }
-                     }
-                }
-                // (Optionnel) Recharger les règles si envoyées dans le JSON
-                if((*doc).containsKey("rules")) {
-                    rules.clear();
-                    JsonArray rArr = (*doc)["rules"];
-                    for(JsonObject obj : rArr) {
-                        rules.push_back({obj["src"], obj["prm"], obj["op"], obj["val"], obj["tgt"], obj["act"]});
-                    }
-                }
-                xSemaphoreGive(mutex);
-                saveConfig();
-                req->send(200, "text/plain", "Saved");
-            } else {
-                req->send(400, "text/plain", "Invalid JSON");
-            }
-            delete doc;
+    // Le corps est découpé et validé chunk par chunk ; la réponse part une fois le corps reçu.
+    // Une session par requête, détruite à la déconnexion (envoi abandonné ou terminé)
+    server.on("/api/config", HTTP_POST, [](AsyncWebServerRequest *req){
+        ConfigIngest* ingest = (ConfigIngest*)req->_tempObject;
+        if(!ingest) { req->send(400, "text/plain", "Corps manquant"); return; }
+        if(ingest->finish()) {
+            applyConfig(*ingest);
+            saveConfig();
+            req->send(200, "text/plain", "Saved");
+        } else {
+            req->send(ingest->oversize ? 413 : 400, "text/plain", ingest->error);
+        }
+        delete ingest; req->_tempObject = nullptr;     // Libérée sans attendre la fin de la réponse
+    }, nullptr, [](AsyncWebServerRequest *req, uint8_t *data, size_t len, size_t index, size_t total){
+        if(index == 0 && !req->_tempObject) {
+            ConfigIngest* ingest = new ConfigIngest();
+            ingest->begin(total);
+            req->_tempObject = ingest;
+            // La pile libère _tempObject avec free() : détruite ici avant
+            req->onDisconnect([req](){ delete (ConfigIngest*)req->_tempObject; req->_tempObject = nullptr; });
         }
+        ConfigIngest* ingest = (ConfigIngest*)req->_tempObject;
+        if(ingest) ingest->feed(data, len);  // Les erreurs sont mémorisées, le reste du corps est ignoré
     });
 
+    // --- WEBSOCKET (JSON par défaut, binaire après HELLO) ---
+    ws.onEvent([](AsyncWebSocket* srv, AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len) {
+        if(type == WS_EVT_CONNECT) telemetry.onConnect(client->id());
+        else if(type == WS_EVT_DISCONNECT) telemetry.onDisconnect(client->id());
+        else if(type == WS_EVT_DATA) {
+            AwsFrameInfo* info = (AwsFrameInfo*)arg;
+            if(!info->final || info->index != 0 || info->len != len || len == 0) return;
+            if(info->opcode == WS_TEXT) {
+                int code;
+                client->text(handleControlBatch((const char*)data, len, code));
+                return;
+            }
+            if(info->opcode != WS_BINARY) return;
+            if(data[0] == OmniBin::MSG_HELLO) {
+                // Réponse : version du serveur ; binaire seulement si le client parle la même
+                uint8_t hello[2];
+                size_t n = OmniBin::encodeHello(hello, sizeof(hello));
+                if(n) client->binary(hello, n);
+                if(OmniBin::acceptHello(data, len)) telemetry.setBinary(client->id());
+                return;
+            }
+
+            OmniBin::Command c = {}; uint8_t ack[4];
+            uint8_t status = OmniBin::ACK_BAD_FRAME;
+            if(OmniBin::decodeCommand(data, len, c)) status = handleBinaryCommand(c);
+            size_t n = OmniBin::encodeAck(c.seq, status, ack, sizeof(ack));
+            if(n) client->binary(ack, n);
+        }
+    });
+    telemetry.begin(ws, sampler.snapshot);
     server.addHandler(&ws);
+    serveAssets(server);
     server.serveStatic("/", LittleFS, "/").setDefaultFile("index.html");
     server.begin();
 }
 
 // --- LOOP PRINCIPAL ---
 void loop() {
+    metrics().loopTick();
+
     // 1. Gestion des règles (Thermostat, etc)
     checkRules();
 
-    // 2. Gestion WebSocket (Push vers l'interface)
-    static unsigned long lastWsUpdate = 0;
-    if(millis() - lastWsUpdate > 2000) {
-        lastWsUpdate = millis();
-        
-        if(ws.count() > 0) {
-            DynamicJsonDocument* doc = new DynamicJsonDocument(4096);
-            JsonArray arr = doc->createNestedArray("devices");
-            
-            if(xSemaphoreTake(mutex, (TickType_t)100) == pdTRUE) {
-                for(auto d : devices) {
-                    JsonObject obj = arr.createNestedObject();
-                    obj["id"] = d->getId();
-                    JsonObject val = obj.createNestedObject("val");
-                    d->read(val);
-                }
-                xSemaphoreGive(mutex);
-                
-                String out; 
-                serializeJson(*doc, out);
-                ws.textAll(out);
-            }
-            delete doc;
-        }
-    }
+    // 2. Gestion WebSocket (deltas immédiats + keyframe périodique)
+    telemetry.loop();
+
+    // 3. Progression du scan I2C
+    static String scanMsg;
+    if(i2cScan.poll(scanMsg)) telemetry.pushText(scanMsg);
 }
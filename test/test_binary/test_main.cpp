@@ -0,0 +1,242 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "OmniBinary.h"
+
+// ==========================================
+// PROTOCOLE BINAIRE WEBSOCKET
+// ==========================================
+// Allers-retours encode/décode, trames tronquées et négociation HELLO.
+
+using namespace OmniBin;
+
+static DeviceSnapshot* snap;
+
+static void publish(size_t slot, const char* id, std::initializer_list<float> vals) {
+    DeviceSample s;
+    memset(&s, 0, sizeof(s));
+    strlcpy(s.id, id, sizeof(s.id));
+    strcpy(s.driver, "BME280");
+    static const char* KEYS[] = {"temp", "hum", "pres", "x3", "x4", "x5", "x6", "x7"};
+    for(float v : vals) { strcpy(s.key[s.nch], KEYS[s.nch]); s.val[s.nch] = v; s.valid |= 1 << s.nch; s.nch++; }
+    s.stamp = 1;
+    snap->publish(slot, s);
+}
+
+void setUp() {
+    snap = new DeviceSnapshot();
+    publish(0, "bme", {21.37f, 48.0039062f, 1013.25f});
+    publish(1, "ina", {-3.5e-7f, 12.4f, 3.4e38f, 0.0f, -0.0f, 1.0f / 3, 7, 255.5f});
+    publish(3, "lux", {356.666656f});     // Slot 2 libre
+    snap->setCount(4);
+}
+
+void tearDown() { delete snap; }
+
+struct Value { uint8_t slot, ch; float v; };
+
+static size_t keyframe(uint8_t* buf, size_t cap, MsgType type, uint8_t mask = 0xFF) {
+    Writer w(buf, cap);
+    size_t pos = beginSamples(w, type);
+    uint8_t n = 0;
+    DeviceSample s;
+    for(size_t i=0; i<snap->count(); i++) {
+        if(!snap->read(i, s)) continue;
+        appendSample(w, i, s, mask & (0xFF >> (8 - s.nch)));
+        n++;
+    }
+    w.patch(pos, n);
+    TEST_ASSERT_TRUE(w.ok());
+    return w.length();
+}
+
+static std::vector<Value> decode(const uint8_t* buf, size_t len, bool* ok = nullptr) {
+    std::vector<Value> out;
+    bool r = decodeSamples(buf, len, [&](uint8_t slot, uint8_t ch, float v) { out.push_back({slot, ch, v}); });
+    if(ok) *ok = r;
+    return out;
+}
+
+void test_keyframe_round_trip() {
+    uint8_t buf[256];
+    size_t len = keyframe(buf, sizeof(buf), MSG_KEYFRAME);
+    TEST_ASSERT_EQUAL(MSG_KEYFRAME, buf[0]);
+    TEST_ASSERT_EQUAL(3, buf[1]);
+    TEST_ASSERT_EQUAL(2 + 3 * 2 + 12 * 5, len);
+
+    bool ok;
+    std::vector<Value> got = decode(buf, len, &ok);
+    TEST_ASSERT_TRUE(ok);
+    TEST_ASSERT_EQUAL(12, got.size());
+    size_t k = 0;
+    for(size_t slot : {0, 1, 3}) {
+        DeviceSample ref;
+        snap->read(slot, ref);
+        for(uint8_t c=0; c<ref.nch; c++, k++) {
+            TEST_ASSERT_EQUAL(slot, got[k].slot);
+            TEST_ASSERT_EQUAL(c, got[k].ch);
+            // Bit à bit : flottant transporté sans arrondi (signe de -0 compris)
+            TEST_ASSERT_EQUAL_MEMORY(&ref.val[c], &got[k].v, 4);
+        }
+    }
+}
+
+// Delta : seuls les canaux du masque, avec leur numéro d'origine
+void test_delta_mask() {
+    uint8_t buf[128];
+    size_t len = keyframe(buf, sizeof(buf), MSG_DELTA, 0x05);
+    TEST_ASSERT_EQUAL(MSG_DELTA, buf[0]);
+    std::vector<Value> got = decode(buf, len);
+    TEST_ASSERT_EQUAL(5, got.size());
+    TEST_ASSERT_EQUAL(0, got[0].ch);
+    TEST_ASSERT_EQUAL(2, got[1].ch);
+    TEST_ASSERT_EQUAL_FLOAT(1013.25f, got[1].v);
+    TEST_ASSERT_EQUAL(3, got[4].slot);
+    TEST_ASSERT_EQUAL_FLOAT(356.666656f, got[4].v);
+}
+
+void test_truncated_samples() {
+    uint8_t buf[256];
+    size_t len = keyframe(buf, sizeof(buf), MSG_KEYFRAME);
+    bool ok = true;
+    for(size_t cut : {(size_t)1, (size_t)2, len / 2, len - 1}) {
+        decode(buf, cut, &ok);
+        TEST_ASSERT_FALSE(ok);
+    }
+    buf[len] = 0;
+    decode(buf, len + 1, &ok);      // Octet en trop
+    TEST_ASSERT_FALSE(ok);
+    buf[0] = MSG_SCHEMA;
+    TEST_ASSERT_EQUAL(0, decode(buf, len, &ok).size());
+    TEST_ASSERT_FALSE(ok);
+}
+
+// Écriture au-delà du buffer : trame refusée, pas de débordement
+void test_writer_overflow() {
+    uint8_t buf[16];
+    memset(buf, 0xAA, sizeof(buf));
+    Writer w(buf, 8);
+    size_t pos = beginSamples(w, MSG_KEYFRAME);
+    DeviceSample s;
+    snap->read(0, s);
+    appendSample(w, 0, s, 0x07);
+    w.patch(pos, 1);
+    TEST_ASSERT_FALSE(w.ok());
+    TEST_ASSERT_EQUAL(8, w.length());
+    TEST_ASSERT_EQUAL_HEX8(0xAA, buf[8]);
+}
+
+void test_schema() {
+    uint8_t buf[256], nch[OMNI_MAX_DEVICES] = {0};
+    Writer w(buf, sizeof(buf));
+    encodeSchema(w, *snap, nch);
+    TEST_ASSERT_TRUE(w.ok());
+    TEST_ASSERT_EQUAL(3, nch[0]);
+    TEST_ASSERT_EQUAL(8, nch[1]);
+    TEST_ASSERT_EQUAL(0, nch[2]);
+    TEST_ASSERT_EQUAL(1, nch[3]);
+
+    Reader r(buf, w.length());
+    TEST_ASSERT_EQUAL(MSG_SCHEMA, r.u8());
+    TEST_ASSERT_EQUAL(3, r.u8());
+    char id[OMNI_ID_LEN], drv[OMNI_DRIVER_LEN], key[OMNI_KEY_LEN];
+    TEST_ASSERT_EQUAL(0, r.u8());
+    r.str(id, sizeof(id)); r.str(drv, sizeof(drv));
+    TEST_ASSERT_EQUAL_STRING("bme", id);
+    TEST_ASSERT_EQUAL_STRING("BME280", drv);
+    TEST_ASSERT_EQUAL(3, r.u8());
+    r.str(key, sizeof(key)); TEST_ASSERT_EQUAL_STRING("temp", key);
+    r.str(key, sizeof(key)); r.str(key, sizeof(key)); TEST_ASSERT_EQUAL_STRING("pres", key);
+    TEST_ASSERT_EQUAL(1, r.u8());
+    r.str(id, sizeof(id)); r.str(drv, sizeof(drv));
+    TEST_ASSERT_EQUAL_STRING("ina", id);
+    uint8_t n = r.u8();
+    for(uint8_t c=0; c<n; c++) r.str(key, sizeof(key));
+    TEST_ASSERT_EQUAL(3, r.u8());
+    r.str(id, sizeof(id)); r.str(drv, sizeof(drv));
+    TEST_ASSERT_EQUAL_STRING("lux", id);
+    TEST_ASSERT_EQUAL(1, r.u8());
+    r.str(key, sizeof(key));
+    TEST_ASSERT_TRUE(r.ok());
+    TEST_ASSERT_TRUE(r.done());
+}
+
+void test_command_round_trip() {
+    uint8_t buf[128];
+    Command c = {0x1234, 7, false, OP_TOGGLE, 42.5f, ""}, d;
+    size_t n = encodeCommand(c, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL(9, n);
+    const uint8_t head[] = {MSG_CMD, 0x34, 0x12, 7, OP_TOGGLE};
+    TEST_ASSERT_EQUAL_MEMORY(head, buf, sizeof(head));
+    TEST_ASSERT_TRUE(decodeCommand(buf, n, d));
+    TEST_ASSERT_FALSE(d.isText);
+    TEST_ASSERT_EQUAL(0x1234, d.seq);
+    TEST_ASSERT_EQUAL(7, d.slot);
+    TEST_ASSERT_EQUAL(OP_TOGGLE, d.op);
+    TEST_ASSERT_EQUAL_FLOAT(42.5f, d.val);
+
+    Command t = {7, 3, true, OP_SET, 0, "Bonjour °C"};
+    n = encodeCommand(t, buf, sizeof(buf));
+    TEST_ASSERT_TRUE(decodeCommand(buf, n, d));
+    TEST_ASSERT_TRUE(d.isText);
+    TEST_ASSERT_EQUAL(3, d.slot);
+    TEST_ASSERT_EQUAL_STRING("Bonjour °C", d.text);
+
+    // Texte plus long que Command::text : tronqué au décodage, trame valide
+    uint8_t raw[] = {MSG_TEXT, 1, 0, 2, 80};
+    uint8_t frame[sizeof(raw) + 80];
+    memcpy(frame, raw, sizeof(raw));
+    memset(frame + sizeof(raw), 'x', 80);
+    TEST_ASSERT_TRUE(decodeCommand(frame, sizeof(frame), d));
+    TEST_ASSERT_EQUAL(63, strlen(d.text));
+}
+
+void test_command_bad_frames() {
+    uint8_t buf[16];
+    Command c = {1, 2, false, OP_SET, 1.0f, ""}, d;
+    size_t n = encodeCommand(c, buf, sizeof(buf));
+    TEST_ASSERT_FALSE(decodeCommand(buf, n - 1, d));
+    buf[n] = 0;
+    TEST_ASSERT_FALSE(decodeCommand(buf, n + 1, d));
+    buf[0] = MSG_ACK;
+    TEST_ASSERT_FALSE(decodeCommand(buf, n, d));
+    TEST_ASSERT_EQUAL(0, encodeCommand(c, buf, 4));
+}
+
+void test_ack() {
+    uint8_t buf[4];
+    TEST_ASSERT_EQUAL(4, encodeAck(0xBEEF, ACK_UNKNOWN_SLOT, buf, sizeof(buf)));
+    const uint8_t want[] = {MSG_ACK, 0xEF, 0xBE, ACK_UNKNOWN_SLOT};
+    TEST_ASSERT_EQUAL_MEMORY(want, buf, 4);
+    TEST_ASSERT_EQUAL(0, encodeAck(1, ACK_OK, buf, 3));
+}
+
+// HELLO : réponse du serveur, binaire seulement à version égale
+void test_hello() {
+    uint8_t buf[2];
+    TEST_ASSERT_EQUAL(2, encodeHello(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(MSG_HELLO, buf[0]);
+    TEST_ASSERT_EQUAL(VERSION, buf[1]);
+    TEST_ASSERT_TRUE(acceptHello(buf, 2));
+
+    const uint8_t newer[] = {MSG_HELLO, VERSION + 1}, old[] = {MSG_HELLO, 0}, bare[] = {MSG_HELLO}, longer[] = {MSG_HELLO, VERSION, 0};
+    TEST_ASSERT_FALSE(acceptHello(newer, sizeof(newer)));
+    TEST_ASSERT_FALSE(acceptHello(old, sizeof(old)));
+    TEST_ASSERT_FALSE(acceptHello(bare, sizeof(bare)));
+    TEST_ASSERT_FALSE(acceptHello(longer, sizeof(longer)));
+    const uint8_t cmd[] = {MSG_CMD, VERSION};
+    TEST_ASSERT_FALSE(acceptHello(cmd, sizeof(cmd)));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_keyframe_round_trip);
+    RUN_TEST(test_delta_mask);
+    RUN_TEST(test_truncated_samples);
+    RUN_TEST(test_writer_overflow);
+    RUN_TEST(test_schema);
+    RUN_TEST(test_command_round_trip);
+    RUN_TEST(test_command_bad_frames);
+    RUN_TEST(test_ack);
+    RUN_TEST(test_hello);
+    return UNITY_END();
+}
@@ -0,0 +1,243 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <unity.h>
+#include "OmniConfig.h"
+#include "OmniHistory.h"
+#include "OmniTelemetry.h"
+
+// ==========================================
+// CONFIGURATION : INGESTION, DIFF, SAUVEGARDE
+// ==========================================
+// Firmware (src/) lié au test : globales et applyConfig/saveConfig/loadConfig de main.cpp.
+
+extern DeviceRegistry devices;
+extern SemaphoreHandle_t mutex;
+extern std::vector<Rule> rules;
+extern TelemetryPublisher telemetry;
+extern History history;
+void saveConfig();
+void loadConfig();
+void applyConfig(ConfigIngest& cfg);
+
+static const char* BASE =
+    "{\"devices\":["
+    "{\"id\":\"relay\",\"name\":\"Pompe\",\"driver\":\"RELAY\",\"pin\":26},"
+    "{\"id\":\"ldr\",\"name\":\"Jour\",\"driver\":\"LDR\",\"pin\":34},"
+    "{\"id\":\"btn\",\"name\":\"Bouton\",\"driver\":\"BUTTON\",\"pin\":4},"
+    "{\"id\":\"ds\",\"name\":\"Cuve\",\"driver\":\"DS18B20\",\"pin\":5,\"opts\":{\"res\":10}}],"
+    "\"rules\":[{\"src\":\"ldr\",\"prm\":\"val\",\"op\":\"<\",\"val\":500,\"tgt\":\"relay\",\"act\":1,"
+    "\"trig\":\"rise\",\"hyst\":25,\"cool_ms\":2000,\"else\":0}],"
+    "\"telemetry\":{\"deadband\":0.5,\"keyframe\":20000}}";
+
+// Corps complet découpé en chunks de `chunk` octets, comme le reçoit /api/config
+static bool ingest(ConfigIngest& cfg, const char* json, size_t chunk = 7) {
+    size_t n = strlen(json);
+    if(!cfg.begin(n)) return false;
+    for(size_t k=0; k<n; k+=chunk) if(!cfg.feed((const uint8_t*)json + k, min(chunk, n - k))) return false;
+    return cfg.finish();
+}
+
+static void apply(const char* json) {
+    ConfigIngest cfg;
+    TEST_ASSERT_TRUE_MESSAGE(ingest(cfg, json), cfg.error.c_str());
+    applyConfig(cfg);
+}
+
+void setUp() { apply("{\"devices\":[],\"rules\":[]}"); }
+void tearDown() {}
+
+void test_ingest_chunks() {
+    for(size_t chunk : {1, 7, 64, 4096}) {
+        ConfigIngest cfg;
+        TEST_ASSERT_TRUE_MESSAGE(ingest(cfg, BASE, chunk), cfg.error.c_str());
+        TEST_ASSERT_EQUAL(4, cfg.devices.size());
+        TEST_ASSERT_EQUAL_STRING("ldr", cfg.devices[1].id);
+        TEST_ASSERT_EQUAL_STRING("LDR", cfg.devices[1].driver);
+        TEST_ASSERT_EQUAL(34, cfg.devices[1].pin);
+        TEST_ASSERT_EQUAL_STRING("", cfg.devices[0].opts);
+        TEST_ASSERT_EQUAL_STRING("{\"res\":10}", cfg.devices[3].opts);
+
+        TEST_ASSERT_TRUE(cfg.hasRules);
+        TEST_ASSERT_EQUAL(1, cfg.rules.size());
+        const Rule& r = cfg.rules[0];
+        TEST_ASSERT_EQUAL_STRING("ldr", r.srcId.c_str());
+        TEST_ASSERT_EQUAL_STRING("<", r.op.c_str());
+        TEST_ASSERT_EQUAL_FLOAT(500, r.threshold);
+        TEST_ASSERT_EQUAL_STRING("rise", r.trig.c_str());
+        TEST_ASSERT_EQUAL_FLOAT(25, r.hyst);
+        TEST_ASSERT_EQUAL_UINT32(2000, r.cooldown);
+        TEST_ASSERT_EQUAL_UINT32(0, r.minOn);
+        TEST_ASSERT_EQUAL_FLOAT(0, r.elseVal);
+        TEST_ASSERT_EQUAL_STRING("{\"deadband\":0.5,\"keyframe\":20000}", cfg.telemetry.c_str());
+    }
+}
+
+// Message d'erreur de la config refusée ("" si acceptée)
+static String reject(const char* json) {
+    ConfigIngest cfg;
+    ingest(cfg, json);
+    return cfg.error;
+}
+
+void test_ingest_errors() {
+    TEST_ASSERT_EQUAL_STRING("Driver inconnu pour x: FOO",
+        reject("{\"devices\":[{\"id\":\"x\",\"driver\":\"FOO\",\"pin\":4}]}").c_str());
+    TEST_ASSERT_EQUAL_STRING("Pin invalide pour x: 34",
+        reject("{\"devices\":[{\"id\":\"x\",\"driver\":\"RELAY\",\"pin\":34}]}").c_str());
+    TEST_ASSERT_EQUAL_STRING("Pin ADC2 (occupé par le WiFi) pour x: 25, utiliser GPIO 32-39",
+        reject("{\"devices\":[{\"id\":\"x\",\"driver\":\"LDR\",\"pin\":25}]}").c_str());
+    TEST_ASSERT_EQUAL_STRING("Id en double: a",
+        reject("{\"devices\":[{\"id\":\"a\",\"driver\":\"RELAY\",\"pin\":26},{\"id\":\"a\",\"driver\":\"RELAY\",\"pin\":27}]}").c_str());
+    TEST_ASSERT_EQUAL_STRING("Pin/Adresse déjà utilisé: 26",
+        reject("{\"devices\":[{\"id\":\"a\",\"driver\":\"RELAY\",\"pin\":26},{\"id\":\"b\",\"driver\":\"VALVE\",\"pin\":26}]}").c_str());
+    // Même numéro : broche GPIO d'un côté, adresse I2C de l'autre
+    TEST_ASSERT_EQUAL_STRING("",
+        reject("{\"devices\":[{\"id\":\"a\",\"driver\":\"BUTTON\",\"pin\":35},{\"id\":\"b\",\"driver\":\"BH1750\",\"pin\":35}]}").c_str());
+    TEST_ASSERT_EQUAL_STRING("Options invalides pour x",
+        reject("{\"devices\":[{\"id\":\"x\",\"driver\":\"DS18B20\",\"pin\":5,\"opts\":[1]}]}").c_str());
+    TEST_ASSERT_EQUAL_STRING("devices doit être un tableau", reject("{\"devices\":{}}").c_str());
+    TEST_ASSERT_EQUAL_STRING("JSON incomplet", reject("{\"devices\":[").c_str());
+    TEST_ASSERT_EQUAL_STRING("Données après le JSON", reject("{} x").c_str());
+
+    ConfigIngest big;
+    TEST_ASSERT_FALSE(big.begin(OMNI_CONFIG_MAX_BODY + 1));
+    TEST_ASSERT_TRUE(big.oversize);
+}
+
+// Chargement au boot : un device invalide est ignoré, pas toute la config
+void test_ingest_lenient() {
+    ConfigIngest cfg(false);
+    TEST_ASSERT_TRUE(ingest(cfg, "{\"devices\":[{\"id\":\"x\",\"driver\":\"FOO\",\"pin\":4},"
+                                 "{\"id\":\"relay\",\"driver\":\"RELAY\",\"pin\":26}]}"));
+    TEST_ASSERT_EQUAL(1, cfg.devices.size());
+    TEST_ASSERT_EQUAL_STRING("relay", cfg.devices[0].id);
+    TEST_ASSERT_FALSE(cfg.hasRules);
+}
+
+void test_apply_diff() {
+    apply(BASE);
+    TEST_ASSERT_EQUAL(4, devices.live());
+    TEST_ASSERT_EQUAL(1, rules.size());
+    int relay = devices.find("relay"), ldr = devices.find("ldr"), btn = devices.find("btn"), ds = devices.find("ds");
+    TEST_ASSERT_TRUE(relay >= 0 && ldr >= 0 && btn >= 0 && ds >= 0);
+    Device* kept = devices[ldr];
+
+    // relay renommé, btn déplacé, ds retiré, valve ajoutée ; ldr inchangé
+    ConfigIngest cfg;
+    TEST_ASSERT_TRUE(ingest(cfg,
+        "{\"devices\":["
+        "{\"id\":\"relay\",\"name\":\"Arrosage\",\"driver\":\"RELAY\",\"pin\":26},"
+        "{\"id\":\"ldr\",\"name\":\"Jour\",\"driver\":\"LDR\",\"pin\":34},"
+        "{\"id\":\"btn\",\"name\":\"Bouton\",\"driver\":\"BUTTON\",\"pin\":13},"
+        "{\"id\":\"valve\",\"name\":\"Vanne\",\"driver\":\"VALVE\",\"pin\":27}]}"));
+    metrics().take(mutex);
+    DeviceDiff diff;
+    diff.apply(devices, cfg.devices);
+    metrics().give(mutex);
+    TEST_ASSERT_EQUAL(1, diff.added);
+    TEST_ASSERT_EQUAL(1, diff.replaced);
+    TEST_ASSERT_EQUAL(1, diff.renamed);
+    TEST_ASSERT_EQUAL(1, diff.removed);
+    TEST_ASSERT_EQUAL(1, diff.kept);
+    TEST_ASSERT_EQUAL(0, diff.failed);
+
+    // Slots stables ; le nouveau device reprend le slot libéré
+    TEST_ASSERT_TRUE(devices[ldr] == kept);
+    TEST_ASSERT_EQUAL(relay, devices.find("relay"));
+    TEST_ASSERT_EQUAL_STRING("Arrosage", devices[relay]->getName());
+    TEST_ASSERT_EQUAL(btn, devices.find("btn"));
+    TEST_ASSERT_EQUAL(13, devices[btn]->getPin());
+    TEST_ASSERT_EQUAL(ds, devices.find("valve"));
+    TEST_ASSERT_EQUAL(-1, devices.find("ds"));
+    TEST_ASSERT_EQUAL(4, devices.live());
+}
+
+// Options changées : device recréé ; "opts" absent : options actuelles conservées
+void test_apply_options() {
+    apply(BASE);
+    int ds = devices.find("ds");
+    Device* before = devices[ds];
+
+    ConfigIngest same;
+    TEST_ASSERT_TRUE(ingest(same, "{\"devices\":[{\"id\":\"ds\",\"name\":\"Cuve\",\"driver\":\"DS18B20\",\"pin\":5,\"opts\":{\"res\":10}}]}"));
+    DeviceDiff d1;
+    metrics().take(mutex);
+    d1.apply(devices, same.devices);
+    metrics().give(mutex);
+    TEST_ASSERT_EQUAL(1, d1.kept);
+    TEST_ASSERT_TRUE(devices[ds] == before);
+
+    apply("{\"devices\":[{\"id\":\"ds\",\"name\":\"Cuve\",\"driver\":\"DS18B20\",\"pin\":5,\"opts\":{\"res\":12}}]}");
+    StaticJsonDocument<64> opts;
+    TEST_ASSERT_TRUE(devices[ds]->getOptions(opts.to<JsonObject>()));
+    TEST_ASSERT_EQUAL(12, opts["res"].as<int>());
+
+    // Broche changée sans "opts" : recréé avec sa résolution
+    apply("{\"devices\":[{\"id\":\"ds\",\"name\":\"Cuve\",\"driver\":\"DS18B20\",\"pin\":16}]}");
+    TEST_ASSERT_EQUAL(16, devices[ds]->getPin());
+    opts.clear();
+    devices[ds]->getOptions(opts.to<JsonObject>());
+    TEST_ASSERT_EQUAL(12, opts["res"].as<int>());
+
+    // Options partielles : les clés absentes (ROM des sondes) reprennent la valeur actuelle
+    apply("{\"devices\":[{\"id\":\"ds\",\"name\":\"Cuve\",\"driver\":\"DS18B20\",\"pin\":16,\"opts\":{\"res\":12,\"roms\":[\"28A10000000000\"]}}]}");
+    apply("{\"devices\":[{\"id\":\"ds\",\"name\":\"Cuve\",\"driver\":\"DS18B20\",\"pin\":16,\"opts\":{\"res\":10}}]}");
+    StaticJsonDocument<256> full;
+    devices[ds]->getOptions(full.to<JsonObject>());
+    TEST_ASSERT_EQUAL(10, full["res"].as<int>());
+    TEST_ASSERT_EQUAL_STRING("28A10000000000", full["roms"][0] | "");
+}
+
+void test_save_load() {
+    // Config de l'utilisateur mise de côté (LittleFS simulé = répertoire de l'hôte)
+    bool had = LittleFS.exists("/config.json");
+    if(had) LittleFS.rename("/config.json", "/config.json.test");
+
+    apply(BASE);
+    saveConfig();
+    apply("{\"devices\":[],\"rules\":[],\"telemetry\":{\"keyframe\":5000}}");
+    TEST_ASSERT_EQUAL(0, devices.live());
+    TEST_ASSERT_EQUAL(0, rules.size());
+
+    loadConfig();
+    LittleFS.remove("/config.json");
+    if(had) LittleFS.rename("/config.json.test", "/config.json");
+
+    TEST_ASSERT_EQUAL(4, devices.live());
+    int ds = devices.find("ds");
+    TEST_ASSERT_TRUE(ds >= 0);
+    TEST_ASSERT_EQUAL_STRING("Cuve", devices[ds]->getName());
+    TEST_ASSERT_EQUAL(5, devices[ds]->getPin());
+    StaticJsonDocument<64> opts;
+    devices[ds]->getOptions(opts.to<JsonObject>());
+    TEST_ASSERT_EQUAL(10, opts["res"].as<int>());
+
+    TEST_ASSERT_EQUAL(1, rules.size());
+    const Rule& r = rules[0];
+    TEST_ASSERT_EQUAL_STRING("relay", r.tgtId.c_str());
+    TEST_ASSERT_EQUAL_STRING("rise", r.trig.c_str());
+    TEST_ASSERT_EQUAL_FLOAT(25, r.hyst);
+    TEST_ASSERT_EQUAL_UINT32(2000, r.cooldown);
+    TEST_ASSERT_EQUAL_FLOAT(0, r.elseVal);
+
+    StaticJsonDocument<256> tel;
+    telemetry.save(tel.to<JsonObject>());
+    TEST_ASSERT_EQUAL_FLOAT(0.5, tel["deadband"].as<float>());
+    TEST_ASSERT_EQUAL_UINT32(20000, tel["keyframe"].as<uint32_t>());
+}
+
+int main(int argc, char** argv) {
+    mutex = xSemaphoreCreateMutex();
+    beginDevicePools();
+    LittleFS.begin(true);
+    history.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_ingest_chunks);
+    RUN_TEST(test_ingest_errors);
+    RUN_TEST(test_ingest_lenient);
+    RUN_TEST(test_apply_diff);
+    RUN_TEST(test_apply_options);
+    RUN_TEST(test_save_load);
+    return UNITY_END();
+}
@@ -0,0 +1,124 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "NativeHAL.h"
+#include "OmniConfig.h"
+
+// ==========================================
+// DRIVERS SUR PÉRIPHÉRIQUES SIMULÉS
+// ==========================================
+// DS18B20 : canaux liés à la ROM d'un rescan à l'autre, 85 °C réel contre
+// registre de mise sous tension.
+
+static Sim::DS18B20 probeA(0x0000000000A1ULL), probeB(0x0000000000B2ULL), probeC(0x0000000000C3ULL);
+static Device* ds;
+
+static void attach(std::initializer_list<Sim::DS18B20*> probes) {
+    while(Sim::oneWire(5).count()) Sim::oneWire(5).detach(Sim::oneWire(5).at(0));
+    for(auto p : probes) Sim::oneWire(5).attach(p);
+}
+
+// Conversions jusqu'à obtenir exactement les canaux `want`
+static bool convert(Reading& r, uint8_t want) {
+    for(int i=0; i<8; i++) {
+        r.valid = 0;
+        ds->sample(r);
+        if(r.valid == want) return true;
+        delay(ds->samplePeriod() + 1);
+    }
+    return false;
+}
+
+static int channelOf(const Sim::DS18B20& p) {
+    StaticJsonDocument<384> doc;
+    ds->getOptions(doc.to<JsonObject>());
+    char hex[15];
+    for(int b=0; b<7; b++) snprintf(hex + 2 * b, 3, "%02X", p.rom[b]);
+    int i = 0;
+    for(JsonVariantConst v : doc["roms"].as<JsonArrayConst>()) { if(strcmp(v | "", hex) == 0) return i; i++; }
+    return -1;
+}
+
+void setUp() {
+    probeA.set(20); probeB.set(30); probeC.set(40);
+    probeA.setBrownout(false); probeB.setBrownout(false);
+    attach({&probeA, &probeB});
+    ds = DeviceFactory::create("DS18B20", "ds", "Cuve", 5);
+    StaticJsonDocument<64> opts;
+    deserializeJson(opts, "{\"res\":9}");
+    ds->setOptions(opts.as<JsonObjectConst>());
+    ds->begin();
+}
+
+void tearDown() { delete ds; }
+
+// Sonde retirée puis remise dans un autre ordre, sonde ajoutée : chaque canal garde sa sonde
+void test_dallas_channels_follow_rom() {
+    Reading r;
+    TEST_ASSERT_TRUE(convert(r, 0x03));
+    int a = channelOf(probeA), b = channelOf(probeB);
+    TEST_ASSERT_TRUE(a >= 0 && b >= 0 && a != b);
+    TEST_ASSERT_EQUAL_FLOAT(20, r.val[a]);
+    TEST_ASSERT_EQUAL_FLOAT(30, r.val[b]);
+
+    attach({&probeB});
+    ds->begin();
+    const Channel* ch;
+    TEST_ASSERT_EQUAL(2, ds->channels(ch));
+    TEST_ASSERT_TRUE(convert(r, 1 << b));
+    TEST_ASSERT_EQUAL_FLOAT(30, r.val[b]);
+
+    attach({&probeC, &probeB, &probeA});
+    ds->begin();
+    TEST_ASSERT_EQUAL(3, ds->channels(ch));
+    TEST_ASSERT_EQUAL(a, channelOf(probeA));
+    TEST_ASSERT_EQUAL(b, channelOf(probeB));
+    TEST_ASSERT_EQUAL(2, channelOf(probeC));
+    TEST_ASSERT_TRUE(convert(r, 0x07));
+    TEST_ASSERT_EQUAL_FLOAT(20, r.val[a]);
+    TEST_ASSERT_EQUAL_FLOAT(40, r.val[2]);
+}
+
+// Table sauvegardée dans "roms" : même affectation après redémarrage, quel que soit l'ordre du bus
+void test_dallas_roms_option() {
+    StaticJsonDocument<384> saved;
+    ds->getOptions(saved.to<JsonObject>());
+    TEST_ASSERT_EQUAL(2, saved["roms"].size());
+    int a = channelOf(probeA);
+    TEST_ASSERT_TRUE(ds->sameOptions(saved.as<JsonObjectConst>()));
+
+    delete ds;
+    attach({&probeC, &probeB, &probeA});
+    ds = DeviceFactory::create("DS18B20", "ds", "Cuve", 5);
+    ds->setOptions(saved.as<JsonObjectConst>());
+    ds->begin();
+    TEST_ASSERT_EQUAL(a, channelOf(probeA));
+    TEST_ASSERT_EQUAL(2, channelOf(probeC));
+
+    // Sans "roms" : table apprise gardée ; ROM différente : device recréé
+    StaticJsonDocument<64> res;
+    deserializeJson(res, "{\"res\":9}");
+    TEST_ASSERT_TRUE(ds->sameOptions(res.as<JsonObjectConst>()));
+    TEST_ASSERT_FALSE(ds->sameOptions(saved.as<JsonObjectConst>()));
+}
+
+// 85 °C mesuré : gardé ; 85 °C du registre de mise sous tension : canal invalide
+void test_dallas_85() {
+    Reading r;
+    int a = channelOf(probeA), b = channelOf(probeB);
+    probeA.set(85);
+    probeB.setBrownout(true);
+    TEST_ASSERT_TRUE(convert(r, 1 << a));
+    TEST_ASSERT_EQUAL_FLOAT(85, r.val[a]);
+    probeB.setBrownout(false);
+    TEST_ASSERT_TRUE(convert(r, 0x03));
+    TEST_ASSERT_EQUAL_FLOAT(30, r.val[b]);
+}
+
+int main(int argc, char** argv) {
+    beginDevicePools();
+    UNITY_BEGIN();
+    RUN_TEST(test_dallas_channels_follow_rom);
+    RUN_TEST(test_dallas_roms_option);
+    RUN_TEST(test_dallas_85);
+    return UNITY_END();
+}
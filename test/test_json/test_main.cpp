@@ -0,0 +1,226 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <unity.h>
+#include "NativeHAL.h"
+#include "OmniConfig.h"
+#include "OmniControl.h"
+#include "OmniHistory.h"
+#include "OmniTelemetry.h"
+
+// ==========================================
+// SORTIES JSON
+// ==========================================
+// Échantillon d'un device (snapshot du Sampler), télémétrie WebSocket, /api/drivers,
+// acquittement des lots de commandes et fichier de configuration écrit par saveConfig().
+
+extern DeviceRegistry devices;
+extern SemaphoreHandle_t mutex;
+extern Sampler sampler;
+extern std::vector<Rule> rules;
+extern History history;
+extern AsyncWebSocket ws;
+void applyConfig(ConfigIngest& cfg);
+void saveConfig();
+String handleControlBatch(const char* json, size_t len, int& code);
+
+static void apply(const char* json) {
+    ConfigIngest cfg;
+    TEST_ASSERT_TRUE_MESSAGE(cfg.begin(strlen(json)) && cfg.feed((const uint8_t*)json, strlen(json)) && cfg.finish(), cfg.error.c_str());
+    applyConfig(cfg);
+}
+
+void setUp() {}
+void tearDown() {}
+
+// Attend un échantillon dont le JSON vaut `json` (tâche Sampler)
+static bool waitSample(const char* id, const char* json) {
+    for(int i=0; i<200; i++) {
+        DeviceSample s;
+        int slot = devices.find(id);
+        if(slot >= 0 && sampler.snapshot.read(slot, s) && s.stamp && strcmp(s.json, json) == 0) return true;
+        delay(10);
+    }
+    return false;
+}
+
+void test_device_json() {
+    Device* d = devices[devices.find("relay")];
+    StaticJsonDocument<128> doc;
+    JsonObject obj = doc.to<JsonObject>();
+    metrics().take(mutex);      // La tâche Sampler lit aussi ce device
+    d->read(obj);
+    metrics().give(mutex);
+    String out;
+    serializeJson(doc, out);
+    TEST_ASSERT_EQUAL_STRING("{\"val\":0,\"human\":\"OFF\"}", out.c_str());
+}
+
+void test_sample_json() {
+    TEST_ASSERT_TRUE(waitSample("relay", "{\"val\":0,\"human\":\"OFF\"}"));
+    int code;
+    const char* on = "{\"id\":\"relay\",\"cmd\":\"set\",\"val\":1}";
+    handleControlBatch(on, strlen(on), code);
+    TEST_ASSERT_EQUAL(200, code);
+    TEST_ASSERT_TRUE(waitSample("relay", "{\"val\":1,\"human\":\"ON\"}"));
+
+    DeviceSample s;
+    sampler.snapshot.read(devices.find("relay"), s);
+    TEST_ASSERT_EQUAL_STRING("Pompe", s.name);
+    TEST_ASSERT_EQUAL_STRING("RELAY", s.driver);
+    TEST_ASSERT_EQUAL(1, s.nch);
+    TEST_ASSERT_EQUAL_STRING("val", s.key[0]);
+    TEST_ASSERT_EQUAL(UNIT_BOOL, s.unit[0]);
+    TEST_ASSERT_EQUAL_FLOAT(1, s.val[0]);
+}
+
+void test_batch_ack() {
+    int code;
+    const char* ok = "{\"seq\":7,\"ops\":[{\"id\":\"relay\",\"cmd\":\"toggle\"},{\"id\":\"valve\",\"cmd\":\"set\",\"val\":1}]}";
+    TEST_ASSERT_EQUAL_STRING("{\"ack\":7,\"ok\":true,\"applied\":2}", handleControlBatch(ok, strlen(ok), code).c_str());
+    TEST_ASSERT_EQUAL(200, code);
+
+    // Id inconnu : rien n'est appliqué
+    int before = Sim::level(26);
+    const char* unknown = "{\"seq\":8,\"ops\":[{\"id\":\"relay\",\"cmd\":\"toggle\"},{\"id\":\"nope\",\"cmd\":\"toggle\"}]}";
+    TEST_ASSERT_EQUAL_STRING("{\"ack\":8,\"ok\":false,\"index\":1,\"error\":\"Device inconnu: nope\"}",
+                             handleControlBatch(unknown, strlen(unknown), code).c_str());
+    TEST_ASSERT_EQUAL(404, code);
+    TEST_ASSERT_EQUAL(before, Sim::level(26));
+
+    const char* bare = "[{\"id\":\"relay\"}]";
+    TEST_ASSERT_EQUAL_STRING("{\"ack\":-1,\"ok\":false,\"index\":0,\"error\":\"cmd ou text requis\"}",
+                             handleControlBatch(bare, strlen(bare), code).c_str());
+    TEST_ASSERT_EQUAL(400, code);
+    TEST_ASSERT_EQUAL_STRING("{\"ack\":-1,\"ok\":false,\"index\":-1,\"error\":\"JSON invalide\"}",
+                             handleControlBatch("{", 1, code).c_str());
+}
+
+static void publishBme(DeviceSnapshot& snap, float temp, const char* text) {
+    DeviceSample s;
+    memset(&s, 0, sizeof(s));
+    strcpy(s.id, "bme");
+    s.nch = 2; s.valid = 0x03;
+    strcpy(s.key[0], "temp"); strcpy(s.key[1], "hum");
+    s.val[0] = temp; s.val[1] = 40;
+    snprintf(s.json, sizeof(s.json), "{\"temp\":%g,\"hum\":40,\"text\":\"%s\",\"at\":[1,{\"x\":\"}\"}]}", temp, text);
+    s.stamp = millis() | 1;
+    snap.publish(0, s);
+}
+
+// Keyframe = JSON du driver ; delta = canaux bougés depuis s.val[], champs texte seulement s'ils changent
+void test_telemetry_frames() {
+    static TelemetryPublisher pub;
+    DeviceSnapshot* snap = new DeviceSnapshot();
+    publishBme(*snap, 21.5f, "Bonjour");
+    snap->setCount(1);
+    pub.begin(ws, *snap);
+    AsyncWebSocketClient* c = ws.simConnect();
+    pub.onConnect(c->id());
+    pub.loop();
+    TEST_ASSERT_EQUAL(1, c->outbox.size());
+    TEST_ASSERT_EQUAL_STRING("{\"devices\":[{\"id\":\"bme\",\"val\":{\"temp\":21.5,\"hum\":40,\"text\":\"Bonjour\",\"at\":[1,{\"x\":\"}\"}]}}]}",
+                             c->outbox[0].data.c_str());
+
+    publishBme(*snap, 22.25f, "Bonjour");
+    pub.notify(0);
+    delay(60);
+    pub.loop();
+    TEST_ASSERT_EQUAL(2, c->outbox.size());
+    TEST_ASSERT_EQUAL_STRING("{\"delta\":1,\"devices\":[{\"id\":\"bme\",\"val\":{\"temp\":22.25}}]}", c->outbox[1].data.c_str());
+
+    publishBme(*snap, 22.25f, "Salut");
+    pub.notify(0);
+    delay(60);
+    pub.loop();
+    TEST_ASSERT_EQUAL(3, c->outbox.size());
+    TEST_ASSERT_EQUAL_STRING("{\"delta\":1,\"devices\":[{\"id\":\"bme\",\"val\":{\"text\":\"Salut\",\"at\":[1,{\"x\":\"}\"}]}}]}",
+                             c->outbox[2].data.c_str());
+
+    pub.notify(0);      // Rien n'a bougé : pas de trame
+    delay(60);
+    pub.loop();
+    TEST_ASSERT_EQUAL(3, c->outbox.size());
+    pub.onDisconnect(c->id());
+    ws.simDisconnect(c->id());
+    delete snap;
+}
+
+struct StringPrint : Print {
+    String s;
+    size_t write(uint8_t c) override { s += (char)c; return 1; }
+};
+
+void test_drivers_json() {
+    StringPrint out;
+    driversJson(out);
+    DynamicJsonDocument doc(16384);
+    TEST_ASSERT_FALSE(deserializeJson(doc, out.s));
+    JsonArrayConst list = doc["drivers"];
+    TEST_ASSERT_EQUAL(sizeof(DRIVERS) / sizeof(DRIVERS[0]), list.size());
+
+    bool ldr = false, bh = false;
+    for(JsonObjectConst d : list) {
+        if(strcmp(d["type"] | "", "LDR") == 0) {
+            ldr = true;
+            String caps, pins;
+            serializeJson(d["caps"], caps);
+            serializeJson(d["pins"], pins);
+            TEST_ASSERT_EQUAL_STRING("[\"input\",\"analog\"]", caps.c_str());
+            TEST_ASSERT_EQUAL_STRING("[32,33,34,35,36,37,38,39]", pins.c_str());
+            TEST_ASSERT_EQUAL_STRING("val", d["channels"][0]["key"] | "");
+            TEST_ASSERT_EQUAL_STRING("V", d["channels"][1]["unit"] | "");
+        }
+        if(strcmp(d["type"] | "", "BH1750") == 0) {
+            bh = true;
+            TEST_ASSERT_EQUAL(0x23, d["addr"]["default"] | 0);
+            TEST_ASSERT_TRUE(d["pins"].isNull());
+        }
+    }
+    TEST_ASSERT_TRUE(ldr && bh);
+}
+
+void test_saved_config() {
+    bool had = LittleFS.exists("/config.json");
+    if(had) LittleFS.rename("/config.json", "/config.json.test");
+    saveConfig();
+    File f = LittleFS.open("/config.json", "r");
+    String body;
+    while(f.available()) body += (char)f.read();
+    f.close();
+    LittleFS.remove("/config.json");
+    if(had) LittleFS.rename("/config.json.test", "/config.json");
+
+    DynamicJsonDocument doc(4096);
+    TEST_ASSERT_FALSE(deserializeJson(doc, body));
+    String dev, rule;
+    serializeJson(doc["devices"][0], dev);
+    serializeJson(doc["rules"][0], rule);
+    TEST_ASSERT_EQUAL_STRING("{\"id\":\"relay\",\"driver\":\"RELAY\",\"name\":\"Pompe\",\"pin\":26}", dev.c_str());
+    TEST_ASSERT_EQUAL(3, doc["devices"].size());
+    TEST_ASSERT_EQUAL(12, doc["devices"][2]["opts"]["res"] | 0);
+    // Champs optionnels écrits seulement hors défaut
+    TEST_ASSERT_EQUAL_STRING("{\"src\":\"relay\",\"prm\":\"val\",\"op\":\"==\",\"val\":1,\"tgt\":\"valve\",\"act\":0,\"cool_ms\":500}", rule.c_str());
+    TEST_ASSERT_FALSE(doc["telemetry"].isNull());
+}
+
+int main(int argc, char** argv) {
+    mutex = xSemaphoreCreateMutex();
+    beginDevicePools();
+    LittleFS.begin(true);
+    history.begin();
+    apply("{\"devices\":["
+          "{\"id\":\"relay\",\"name\":\"Pompe\",\"driver\":\"RELAY\",\"pin\":26},"
+          "{\"id\":\"valve\",\"name\":\"Vanne\",\"driver\":\"VALVE\",\"pin\":27},"
+          "{\"id\":\"ds\",\"name\":\"Cuve\",\"driver\":\"DS18B20\",\"pin\":5,\"opts\":{\"res\":12}}],"
+          "\"rules\":[{\"src\":\"relay\",\"prm\":\"val\",\"op\":\"==\",\"val\":1,\"tgt\":\"valve\",\"act\":0,\"cool_ms\":500}]}");
+    sampler.begin(devices, mutex);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_device_json);
+    RUN_TEST(test_sample_json);
+    RUN_TEST(test_batch_ack);
+    RUN_TEST(test_telemetry_frames);
+    RUN_TEST(test_drivers_json);
+    RUN_TEST(test_saved_config);
+    return UNITY_END();
+}
@@ -0,0 +1,125 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "NativeHAL.h"
+#include "SimPeripherals.h"
+#include "OmniRegistry.h"
+
+// ==========================================
+// POOLS DE DEVICES
+// ==========================================
+// Liste libre d'un SlabPool, repli sur le tas, puis charge de reconfiguration
+// du benchmark (runPoolBench), sans puis avec begin() sur le HAL simulé : avec
+// pool, ni les devices ni leurs tampons (rubans LED, image OLED) ne touchent le tas.
+
+void setUp() {}
+void tearDown() {}
+
+void test_slab_pool() {
+    SlabPool* p = new SlabPool();               // Zone jamais rendue, comme au boot
+    TEST_ASSERT_TRUE(p->begin(20, 3));
+    TEST_ASSERT_EQUAL(24, p->slotSize());       // Arrondi à 8
+    TEST_ASSERT_NULL(p->alloc(25));             // Bloc trop petit
+    void* a = p->alloc(24);
+    void* b = p->alloc(1);
+    void* c = p->alloc(8);
+    TEST_ASSERT_NOT_NULL(a); TEST_ASSERT_NOT_NULL(b); TEST_ASSERT_NOT_NULL(c);
+    TEST_ASSERT_TRUE(a != b && b != c && a != c);
+    TEST_ASSERT_NULL(p->alloc(8));              // Plein
+    TEST_ASSERT_TRUE(p->owns(b));
+    int local;
+    TEST_ASSERT_FALSE(p->owns(&local));
+    p->free(b);
+    TEST_ASSERT_EQUAL(2, p->used());
+    TEST_ASSERT_EQUAL_PTR(b, p->alloc(4));      // Dernier libéré, premier resservi
+    TEST_ASSERT_EQUAL(3, p->peak());
+    p->free(a); p->free(b); p->free(c);
+    p->setBypass(true);
+    TEST_ASSERT_NULL(p->alloc(4));
+    TEST_ASSERT_EQUAL(0, p->used());
+}
+
+// Petite classe d'abord, grande si trop gros, tas au-delà (compté sauf en bypass)
+void test_device_pool_classes() {
+    DevicePool& pool = devicePool();
+    uint16_t small = pool.small().used(), large = pool.large().used();
+    uint32_t fb = pool.fallbacks;
+    void* s = pool.allocOrHeap(pool.small().slotSize());
+    void* l = pool.allocOrHeap(pool.small().slotSize() + 1);
+    TEST_ASSERT_EQUAL(small + 1, pool.small().used());
+    TEST_ASSERT_EQUAL(large + 1, pool.large().used());
+    TEST_ASSERT_TRUE(pool.small().owns(s));
+    TEST_ASSERT_TRUE(pool.large().owns(l));
+    void* h = pool.allocOrHeap(pool.large().slotSize() + 1);
+    TEST_ASSERT_FALSE(pool.small().owns(h) || pool.large().owns(h));
+    TEST_ASSERT_EQUAL(fb + 1, pool.fallbacks);
+    pool.release(s); pool.release(l); pool.release(h);
+    TEST_ASSERT_EQUAL(small, pool.small().used());
+    TEST_ASSERT_EQUAL(large, pool.large().used());
+
+    pool.setBypass(true);
+    h = pool.allocOrHeap(8);
+    TEST_ASSERT_FALSE(pool.small().owns(h));
+    TEST_ASSERT_EQUAL(fb + 1, pool.fallbacks);
+    pool.release(h);
+    pool.setBypass(false);
+}
+
+// Reconfigurations mêlées de chaînes de durées variées, fenêtre de tas réduite
+void test_reconfig_workload() {
+    PoolBenchResult heap = runPoolBench(false, OMNI_BENCH_RECONFIG);
+    PoolBenchResult pool = runPoolBench(true, OMNI_BENCH_RECONFIG);
+    TEST_ASSERT_TRUE(heap.taken > 0);
+    TEST_ASSERT_EQUAL(0, pool.taken);           // Aucun octet de device sur le tas
+    TEST_ASSERT_EQUAL(0, pool.fallbacks);
+    TEST_ASSERT_TRUE(pool.drift <= 0);
+    TEST_ASSERT_TRUE(heap.drift <= 0);
+    // Les chaînes seules fragmentent encore, mais moins que chaînes + devices
+    TEST_ASSERT_TRUE(heap.fragAfter > heap.fragBefore);
+    TEST_ASSERT_TRUE(pool.fragAfter < heap.fragAfter);
+    TEST_ASSERT_EQUAL(0, devicePool().used());
+}
+
+// Même charge, devices démarrés : allocations faites dans begin() comprises
+void test_reconfig_begin() {
+    static Sim::BME280 bme;
+    static Sim::INA219 ina;
+    static Sim::BH1750 bh;
+    static Sim::LCD1602 lcd;
+    static Sim::SSD1306 oled;
+    static Sim::DS18B20 probe(0x0000000000A1ULL);
+    Sim::setRealtime(false);
+    Sim::i2c().attach(0x76, &bme); Sim::i2c().attach(0x40, &ina); Sim::i2c().attach(0x23, &bh);
+    Sim::i2c().attach(0x27, &lcd); Sim::i2c().attach(0x3C, &oled);
+    Sim::oneWire(5).attach(&probe);
+    Sim::dht(4).set(21, 50);
+
+    // Seul objet de begin() hors pool : le timer esp_timer de chaque DHT (alloué par l'IDF)
+    Device* dht = DeviceFactory::create("DHT22", "dht", "Bench", 4);
+    uint32_t before = ESP.getFreeHeap();
+    dht->begin();
+    uint32_t timer = before - ESP.getFreeHeap();
+    delete dht;
+    uint64_t dhts = 0;                          // DHT22 démarrés par la charge (rang 5 de la table)
+    for(uint32_t c=0; c<OMNI_BENCH_RECONFIG; c++) for(size_t i=0; i<4 + c % 12; i++) dhts += (c + i * 3) % 14 == 5;
+
+    PoolBenchResult heap = runPoolBench(false, OMNI_BENCH_RECONFIG, true);
+    PoolBenchResult pool = runPoolBench(true, OMNI_BENCH_RECONFIG, true);
+    TEST_ASSERT_TRUE(heap.taken > runPoolBench(false, OMNI_BENCH_RECONFIG).taken);     // Tampons de begin() sur le tas
+    TEST_ASSERT_EQUAL(dhts * timer / OMNI_BENCH_RECONFIG, pool.taken);
+    TEST_ASSERT_EQUAL(0, pool.fallbacks);
+    TEST_ASSERT_TRUE(pool.drift <= 0);
+    TEST_ASSERT_TRUE(heap.drift <= 0);
+    TEST_ASSERT_TRUE(pool.fragAfter < heap.fragAfter);
+    TEST_ASSERT_TRUE(ledPool().peak() > 0 && bufferPool().peak() > 0);
+    TEST_ASSERT_EQUAL(0, devicePool().used() + bufferPool().used() + ledPool().used());
+}
+
+int main(int argc, char** argv) {
+    beginDevicePools();
+    UNITY_BEGIN();
+    RUN_TEST(test_slab_pool);
+    RUN_TEST(test_device_pool_classes);
+    RUN_TEST(test_reconfig_workload);
+    RUN_TEST(test_reconfig_begin);
+    return UNITY_END();
+}
@@ -0,0 +1,350 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "NativeHAL.h"
+#include "OmniConfig.h"
+#include "OmniHistory.h"
+#include "OmniRules.h"
+
+// ==========================================
+// MOTEUR DE RÈGLES
+// ==========================================
+// Moteur isolé sur un snapshot rempli à la main, puis checkRules() de main.cpp
+// de bout en bout (ADC simulé -> Sampler -> règle -> relais).
+
+extern DeviceRegistry devices;
+extern SemaphoreHandle_t mutex;
+extern Sampler sampler;
+extern History history;
+void applyConfig(ConfigIngest& cfg);
+void checkRules();
+void onSampleChanged(size_t slot);
+
+enum { SRC, RELAY, LCD };
+static DeviceRegistry reg;
+static DeviceSnapshot* snap;
+static RuleEngine* eng;
+static std::vector<Rule> list;
+
+struct Fired { uint16_t tgt; float val, act; };
+static std::vector<Fired> fired;
+
+// Nouvelle mesure du canal "val" de la source
+static void measure(float v) {
+    DeviceSample s;
+    memset(&s, 0, sizeof(s));
+    strcpy(s.id, "ldr");
+    s.nch = 1; s.valid = 1; s.unit[0] = UNIT_RAW;
+    strcpy(s.key[0], "val");
+    s.val[0] = v;
+    s.stamp = millis() | 1;
+    snap->publish(SRC, s);
+    eng->notify(SRC);
+}
+
+static size_t run() {
+    return eng->evaluate(*snap, [](const CompiledRule& r, const DeviceSample&, float v, float act) { fired.push_back({r.tgt, v, act}); });
+}
+
+static Rule rule(const char* op, float thr, const char* tgt = "relay", float act = 1) {
+    return Rule{"ldr", "val", op, thr, tgt, act};
+}
+
+static void load(std::initializer_list<Rule> rules) {
+    list = rules;
+    eng->compile(list, reg);
+}
+
+void setUp() {
+    snap = new DeviceSnapshot();
+    snap->setCount(3);
+    eng = new RuleEngine();
+    fired.clear();
+}
+
+void tearDown() {
+    delete eng;
+    delete snap;
+}
+
+void test_ops() {
+    TEST_ASSERT_TRUE(RuleEngine::test(OP_GT, 2, 1));
+    TEST_ASSERT_FALSE(RuleEngine::test(OP_GT, 1, 1));
+    TEST_ASSERT_TRUE(RuleEngine::test(OP_GE, 1, 1));
+    TEST_ASSERT_TRUE(RuleEngine::test(OP_LT, 0, 1));
+    TEST_ASSERT_TRUE(RuleEngine::test(OP_LE, 1, 1));
+    TEST_ASSERT_TRUE(RuleEngine::test(OP_EQ, 1, 1));
+    TEST_ASSERT_TRUE(RuleEngine::test(OP_NE, 0, 1));
+    TEST_ASSERT_FALSE(RuleEngine::test(OP_INVALID, 0, 1));
+    TEST_ASSERT_EQUAL(OP_GE, RuleEngine::parseOp(">="));
+    TEST_ASSERT_EQUAL(OP_INVALID, RuleEngine::parseOp("=>"));
+    TEST_ASSERT_EQUAL(TRIG_LEVEL, RuleEngine::parseTrig(""));
+    TEST_ASSERT_EQUAL(TRIG_FALL, RuleEngine::parseTrig("fall"));
+    TEST_ASSERT_EQUAL(TRIG_INVALID, RuleEngine::parseTrig("edge"));
+}
+
+// Source, cible, opérateur ou déclenchement inconnus : règle ignorée
+void test_compile_skips_invalid() {
+    Rule trig = rule(">", 1);
+    trig.trig = "edge";
+    load({rule(">", 1), Rule{"nope", "val", ">", 1, "relay", 1}, rule(">", 1, "nope"), rule("=>", 1), trig});
+    TEST_ASSERT_EQUAL(1, eng->size());
+    TEST_ASSERT_TRUE(eng->pending());
+}
+
+// level : act tant que la condition est vraie, else sinon ; pas de doublon vers la cible
+void test_level_else() {
+    Rule r = rule("<", 500);
+    r.elseVal = 0;
+    load({r});
+    measure(300);
+    TEST_ASSERT_EQUAL(1, run());
+    TEST_ASSERT_EQUAL(RELAY, fired[0].tgt);
+    TEST_ASSERT_EQUAL_FLOAT(300, fired[0].val);
+    TEST_ASSERT_EQUAL_FLOAT(1, fired[0].act);
+    measure(200);
+    TEST_ASSERT_EQUAL(0, run());
+    measure(800);
+    TEST_ASSERT_EQUAL(1, run());
+    TEST_ASSERT_EQUAL_FLOAT(0, fired[1].act);
+    // Pas de nouvelle mesure : rien à évaluer
+    TEST_ASSERT_FALSE(eng->pending());
+    TEST_ASSERT_EQUAL(0, run());
+}
+
+// Cible déjà dans l'état voulu (canal booléen du snapshot) : action retenue
+void test_target_state() {
+    load({rule(">", 500)});
+    DeviceSample t;
+    memset(&t, 0, sizeof(t));
+    strcpy(t.id, "relay");
+    t.nch = 1; t.valid = 1; t.unit[0] = UNIT_BOOL; t.val[0] = 1; t.stamp = millis() | 1;
+    strcpy(t.key[0], "val");
+    snap->publish(RELAY, t);
+    measure(600);
+    TEST_ASSERT_EQUAL(0, run());
+}
+
+void test_hysteresis() {
+    Rule r = rule(">", 500);
+    r.hyst = 50; r.elseVal = 0;
+    load({r});
+    measure(600);
+    TEST_ASSERT_EQUAL(1, run());
+    measure(480);       // > 500 - 50 : condition maintenue
+    TEST_ASSERT_EQUAL(0, run());
+    measure(440);
+    TEST_ASSERT_EQUAL(1, run());
+    TEST_ASSERT_EQUAL_FLOAT(0, fired[1].act);
+    measure(520);       // Retombée : seuil normal
+    TEST_ASSERT_EQUAL(1, run());
+    TEST_ASSERT_EQUAL_FLOAT(1, fired[2].act);
+}
+
+// Fronts : aucun à la première mesure, else sur le front opposé
+void test_rise_fall() {
+    Rule up = rule(">", 500);
+    up.trig = "rise";
+    Rule down = rule(">", 500, "relay", 7);
+    down.trig = "fall"; down.elseVal = 8;
+    load({up, down});
+    measure(600);
+    TEST_ASSERT_EQUAL(0, run());
+    measure(400);
+    TEST_ASSERT_EQUAL(1, run());
+    TEST_ASSERT_EQUAL_FLOAT(7, fired[0].act);
+    measure(300);
+    TEST_ASSERT_EQUAL(0, run());
+    measure(700);
+    TEST_ASSERT_EQUAL(2, run());
+    TEST_ASSERT_EQUAL_FLOAT(1, fired[1].act);
+    TEST_ASSERT_EQUAL_FLOAT(8, fired[2].act);
+}
+
+// Action retenue par le cooldown : réémise à l'échéance, sans nouvelle mesure
+void test_cooldown() {
+    Rule r = rule(">", 500);
+    r.elseVal = 0; r.cooldown = 100;
+    load({r});
+    measure(600);
+    TEST_ASSERT_EQUAL(1, run());
+    measure(400);
+    TEST_ASSERT_EQUAL(0, run());
+    TEST_ASSERT_FALSE(eng->pending());
+    delay(120);
+    TEST_ASSERT_TRUE(eng->pending());
+    TEST_ASSERT_EQUAL(1, run());
+    TEST_ASSERT_EQUAL_FLOAT(0, fired[1].act);
+}
+
+// Condition vraie depuis moins de minOn : état inchangé, réévalué à l'échéance
+void test_min_on() {
+    Rule r = rule(">", 500);
+    r.elseVal = 0; r.minOn = 100;
+    load({r});
+    measure(600);
+    TEST_ASSERT_EQUAL(1, run());
+    measure(400);
+    TEST_ASSERT_EQUAL(0, run());
+    delay(120);
+    TEST_ASSERT_TRUE(eng->pending());
+    TEST_ASSERT_EQUAL(1, run());
+    TEST_ASSERT_EQUAL_FLOAT(0, fired[1].act);
+}
+
+// Recompilation après l'édition d'un autre device : durée minimale toujours tenue ;
+// cible recréée ou règle modifiée : état repart de zéro
+void test_compile_keeps_state() {
+    Rule r = rule(">", 500);
+    r.elseVal = 0; r.minOn = 1000;
+    load({r});
+    measure(600);
+    TEST_ASSERT_EQUAL(1, run());
+    eng->compile(list, reg, {LCD});
+    measure(400);
+    TEST_ASSERT_EQUAL(0, run());
+
+    eng->compile(list, reg, {RELAY});
+    measure(400);
+    TEST_ASSERT_EQUAL(1, run());
+    TEST_ASSERT_EQUAL_FLOAT(0, fired[1].act);
+
+    measure(600);
+    TEST_ASSERT_EQUAL(1, run());
+    list[0].threshold = 550;
+    eng->compile(list, reg);
+    measure(400);
+    TEST_ASSERT_EQUAL(1, run());
+    TEST_ASSERT_EQUAL_FLOAT(0, fired[3].act);
+}
+
+// Écran : chaque nouvelle valeur tant que la condition est vraie, rien sinon
+void test_text_target() {
+    Rule r = rule(">", 500, "lcd");
+    r.elseVal = 0;
+    load({r});
+    measure(600);
+    TEST_ASSERT_EQUAL(1, run());
+    measure(700);
+    TEST_ASSERT_EQUAL(1, run());
+    TEST_ASSERT_EQUAL_FLOAT(700, fired[1].val);
+    measure(400);
+    TEST_ASSERT_EQUAL(0, run());
+}
+
+// compile() + evaluate() : mêmes déclenchements que l'ancien checkRules()
+// (Device::read() dans un document JSON, containsKey(), comparaison > ou <)
+void test_matches_legacy() {
+    DeviceRegistry* relays = new DeviceRegistry();
+    char id[OMNI_ID_LEN];
+    for(int i=0; i<8; i++) {
+        snprintf(id, sizeof(id), "r%d", i);
+        Device* d = DeviceFactory::create("RELAY", id, "Relais", 12 + i);
+        d->write("set", i % 3 == 0);
+        relays->push_back(d);
+
+        DeviceSample s;
+        memset(&s, 0, sizeof(s));
+        strcpy(s.id, id);
+        Reading r;
+        d->sample(r);
+        const Channel* ch;
+        s.nch = d->channels(ch);
+        s.valid = r.valid;
+        for(uint8_t c=0; c<s.nch; c++) { strcpy(s.key[c], ch[c].key); s.unit[c] = ch[c].unit; s.val[c] = r.val[c]; }
+        s.stamp = millis() | 1;
+        snap->publish(i, s);
+    }
+    snap->setCount(8);
+
+    const float thr[] = {-1, 0, 0.5f, 1, 2};
+    list.clear();
+    for(int k=0; k<40; k++) {
+        list.push_back(Rule{String("r") + (k % 8), "val", (k & 1) ? ">" : "<", thr[k % 5],
+                            String("r") + ((k + 3) % 8), 100.0f + k});   // Action unique : jamais déjà l'état de la cible
+    }
+    list.push_back(Rule{"r1", "nope", ">", 0, "r2", 1});                   // Clé absente : ni l'un ni l'autre
+
+    std::vector<bool> legacy(list.size(), false);
+    StaticJsonDocument<512> doc;
+    for(size_t k=0; k<list.size(); k++) {
+        Device* src = relays->get(list[k].srcId.c_str());
+        doc.clear();
+        JsonObject obj = doc.to<JsonObject>();
+        src->read(obj);
+        if(!obj.containsKey(list[k].param)) continue;
+        float val = obj[list[k].param];
+        legacy[k] = (list[k].op == ">" && val > list[k].threshold) || (list[k].op == "<" && val < list[k].threshold);
+    }
+
+    eng->compile(list, *relays);
+    TEST_ASSERT_EQUAL(list.size(), eng->size());
+    std::vector<bool> compiled(list.size(), false);
+    size_t n = eng->evaluate(*snap, [&](const CompiledRule& r, const DeviceSample& s, float, float act) {
+        TEST_ASSERT_EQUAL_STRING(list[r.rule].srcId.c_str(), s.id);
+        TEST_ASSERT_EQUAL_FLOAT(list[r.rule].actionVal, act);
+        compiled[r.rule] = true;
+    });
+    size_t want = 0;
+    for(size_t k=0; k<list.size(); k++) {
+        TEST_ASSERT_EQUAL_MESSAGE(legacy[k], compiled[k], list[k].srcId.c_str());
+        want += legacy[k];
+    }
+    TEST_ASSERT_EQUAL(want, n);
+    TEST_ASSERT_TRUE(want > 0 && want < list.size());
+    relays->clear();
+    delete relays;
+}
+
+// Tension sur l'ADC -> tâche Sampler -> checkRules() -> broche du relais
+static bool waitLevel(int pin, int level) {
+    for(int i=0; i<300; i++) {
+        checkRules();
+        if(Sim::level(pin) == level) return true;
+        delay(10);
+    }
+    return false;
+}
+
+void test_check_rules() {
+    ConfigIngest cfg;
+    const char* json =
+        "{\"devices\":[{\"id\":\"ldr\",\"name\":\"Jour\",\"driver\":\"LDR\",\"pin\":34},"
+        "{\"id\":\"relay\",\"name\":\"Lampe\",\"driver\":\"RELAY\",\"pin\":26}],"
+        "\"rules\":[{\"src\":\"ldr\",\"prm\":\"val\",\"op\":\"<\",\"val\":1000,\"tgt\":\"relay\",\"act\":1,\"else\":0}]}";
+    TEST_ASSERT_TRUE(cfg.begin(strlen(json)) && cfg.feed((const uint8_t*)json, strlen(json)) && cfg.finish());
+    Sim::setAnalog(34, 3000);
+    applyConfig(cfg);
+    sampler.begin(devices, mutex);
+
+    TEST_ASSERT_TRUE(waitLevel(26, LOW));
+    Sim::setAnalog(34, 200);
+    TEST_ASSERT_TRUE(waitLevel(26, HIGH));
+    Sim::setAnalog(34, 3500);
+    TEST_ASSERT_TRUE(waitLevel(26, LOW));
+}
+
+int main(int argc, char** argv) {
+    while(!millis()) delay(1);      // 0 = « jamais » pour les horodatages du moteur
+    mutex = xSemaphoreCreateMutex();
+    beginDevicePools();
+    history.begin();
+    sampler.onChange(onSampleChanged);
+    reg.push_back(DeviceFactory::create("LDR", "ldr", "Jour", 34));
+    reg.push_back(DeviceFactory::create("RELAY", "relay", "Lampe", 26));
+    reg.push_back(DeviceFactory::create("LCD_I2C", "lcd", "Ecran", 0x27));
+
+    UNITY_BEGIN();
+    RUN_TEST(test_ops);
+    RUN_TEST(test_compile_skips_invalid);
+    RUN_TEST(test_level_else);
+    RUN_TEST(test_target_state);
+    RUN_TEST(test_hysteresis);
+    RUN_TEST(test_rise_fall);
+    RUN_TEST(test_cooldown);
+    RUN_TEST(test_min_on);
+    RUN_TEST(test_compile_keeps_state);
+    RUN_TEST(test_text_target);
+    RUN_TEST(test_matches_legacy);
+    RUN_TEST(test_check_rules);
+    return UNITY_END();
+}
@@ -0,0 +1,88 @@
+# Compresse les fichiers de data/ et les embarque en flash (src/OmniAssetsData.h).
+#
+# Script pré-build PlatformIO (extra_scripts = pre:tools/embed_assets.py), aussi
+# exécutable seul : python3 tools/embed_assets.py
+#
+# gzip niveau 9 sans horodatage : même contenu => mêmes octets et même ETag
+# (SHA-256 du fichier d'origine). Le header n'est réécrit que s'il change,
+# pour ne pas relancer la compilation à chaque build.
+
+import gzip
+import hashlib
+import os
+
+MIME = {
+    ".html": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".ico": "image/x-icon",
+    ".png": "image/png",
+    ".svg": "image/svg+xml",
+}
+
+# HTML revalidé à chaque chargement (304 si inchangé), le reste gardé un jour
+CACHE_HTML = "no-cache"
+CACHE_OTHER = "max-age=86400"
+
+
+def c_array(name, data):
+    lines = []
+    for i in range(0, len(data), 20):
+        lines.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 20]) + ",")
+    return "static const uint8_t %s[] PROGMEM = {\n%s\n};\n" % (name, "\n".join(lines))
+
+
+def generate(project_dir):
+    data_dir = os.path.join(project_dir, "data")
+    out_path = os.path.join(project_dir, "src", "OmniAssetsData.h")
+
+    arrays, rows, report = [], [], []
+    for root, _, files in os.walk(data_dir):
+        for fname in sorted(files):
+            ext = os.path.splitext(fname)[1].lower()
+            if ext not in MIME:
+                continue
+            path = os.path.join(root, fname)
+            with open(path, "rb") as f:
+                raw = f.read()
+            gz = gzip.compress(raw, compresslevel=9, mtime=0)
+            url = "/" + os.path.relpath(path, data_dir).replace(os.sep, "/")
+            etag = '\\"%s\\"' % hashlib.sha256(raw).hexdigest()[:16]
+            cache = CACHE_HTML if ext == ".html" else CACHE_OTHER
+            sym = "ASSET_%d" % len(rows)
+            arrays.append(c_array(sym, gz))
+            rows.append('    { "%s", "%s", "%s", "%s", %s, sizeof(%s) },' % (url, MIME[ext], etag, cache, sym, sym))
+            report.append("%s %d -> %d B" % (url, len(raw), len(gz)))
+
+    if not rows:
+        if os.path.exists(out_path):
+            os.remove(out_path)
+        print("Assets embarqués : aucun (data/ vide), service depuis LittleFS")
+        return
+
+    text = (
+        "// Généré par tools/embed_assets.py depuis data/ : ne pas modifier.\n"
+        "#pragma once\n\n"
+        + "\n".join(arrays)
+        + "\nstatic const EmbeddedAsset EMBEDDED_ASSETS[] = {\n"
+        + "\n".join(rows)
+        + "\n};\n"
+    )
+
+    old = None
+    if os.path.exists(out_path):
+        with open(out_path, "r", encoding="utf-8") as f:
+            old = f.read()
+    if old != text:
+        with open(out_path, "w", encoding="utf-8") as f:
+            f.write(text)
+    print("Assets embarqués : " + ", ".join(report))
+
+
+try:
+    Import("env")  # noqa: F821 (SCons / PlatformIO)
+    generate(env["PROJECT_DIR"])  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        generate(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))